@@ -0,0 +1,76 @@
+// Firmware tasks
+// Each task owns its state and hands the rest of the firmware copies of it
+// through seqlocks (seqlock.h), FreeRTOS queues and scheduler triggers:
+//
+//   gps      loop(), core 1 (the Arduino loop task), priority 1. UART ingest,
+//            NMEA parsing, epoch snapshots, the NMEA/gpsd/UDP outputs and the
+//            fix latency tracker. Publishes gpsStatus and latencyStatus, triggers the network
+//            task's jobs on each epoch and fix change.
+//   display  DISPLAY_TASK_CORE. Draws the TFT from the DisplayState mailbox
+//            (display_state.h); the framebuffer flush task sends each frame
+//            from FRAMEBUFFER_FLUSH_CORE, the other core, below the gps
+//            task's priority.
+//   network  NETWORK_TASK_CORE. WiFi (wifi_manager.h), servers, WebSocket broadcasts
+//            and MQTT. Publishes netStatus.
+//
+// The gps and network tasks run their work as Scheduler jobs (scheduler.h,
+// registered in setupJobs()) and sleep until the next one is due or
+// triggered.
+//   ui       UI_TASK_CORE. Button gestures (button_input.h), woken by the
+//            button interrupts.
+//
+// The NeoPixel and the buzzer have no task: esp_timer callbacks run their
+// patterns (status_led.h, buzzer.h) and any task may set them.
+//
+// AsyncTCP callbacks (HTTP handlers, WebSocket events) run on the AsyncTCP
+// task: they read the seqlocks and post requests, they never touch task
+// state directly.
+
+#ifndef APP_TASKS_H
+#define APP_TASKS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "fix_latency.h"
+#include "gps_snapshot.h"
+#include "seqlock.h"
+
+// What the GPS task publishes after each epoch (and GPS reset)
+struct GpsStatus {
+  GpsSnapshot fix;
+  uint32_t validSentences;
+  uint32_t failedChecksums;
+  uint32_t totalSentences;
+  uint32_t charsProcessed;
+  uint8_t satellitesInView;
+  uint32_t drChecks;         // Dead reckoning (dead_reckoning.h)
+  uint32_t drMaxErrorCm;
+  uint64_t drErrorSumCm;
+  uint64_t drHoldSumCm;
+  uint32_t ttffMs;           // Last TTFF test (0 = none)
+};
+
+// What the network task publishes on WiFi changes
+struct NetStatus {
+  bool wifiConnected;
+  char ip[20];               // Or "Connecting...", "No WiFi"
+};
+
+// When the network task queued a WebSocket frame, for the fix latency tracker
+struct WsQueuedStamp {
+  uint32_t epoch;
+  int64_t queuedUs;
+};
+
+// What the GPS task publishes whenever the fix latency tracker changes
+struct LatencyStatus {
+  EpochTiming lastEpoch;
+  LatencyHistogram hops[HOP_COUNT];
+};
+
+extern SeqLock<GpsStatus> gpsStatus;
+extern SeqLock<NetStatus> netStatus;
+extern SeqLock<WsQueuedStamp> wsQueuedStamp;
+extern SeqLock<LatencyStatus> latencyStatus;
+
+#endif // APP_TASKS_H
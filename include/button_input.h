@@ -0,0 +1,102 @@
+// Interrupt-driven buttons with gestures
+// Both buttons interrupt on every edge; the ISR timestamps the edge and
+// queues it. The UI task sleeps on that queue (or until the next gesture
+// deadline), so a press is seen within microseconds whatever the other
+// tasks are doing.
+//
+// Debounce takes the leading edge: a press counts at its first edge, and
+// for BUTTON_DEBOUNCE_MS afterwards edges only make the task re-read the pin
+// once the contacts have settled.
+//
+// Gestures, all timed from the ISR timestamps:
+//   SHORT   released before BUTTON_LONG_PRESS_MS, and not pressed again
+//           within BUTTON_DOUBLE_PRESS_MS
+//   DOUBLE  second press within BUTTON_DOUBLE_PRESS_MS of the first release
+//   LONG    held BUTTON_LONG_PRESS_MS, reported while still held
+//   CHORD   both buttons down together, reported on the second press; the
+//           releases that follow report nothing
+
+#ifndef BUTTON_INPUT_H
+#define BUTTON_INPUT_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "metrics.h"
+
+enum ButtonId : uint8_t {
+  BUTTON_1,
+  BUTTON_2,
+  BUTTON_COUNT
+};
+
+enum ButtonGesture : uint8_t {
+  GESTURE_SHORT,
+  GESTURE_DOUBLE,
+  GESTURE_LONG,
+  GESTURE_CHORD
+};
+
+struct ButtonEvent {
+  ButtonGesture gesture;
+  ButtonId button;       // CHORD: BUTTON_1
+  int64_t pressUs;       // ISR time of the press that started the gesture
+};
+
+class ButtonInput {
+public:
+  void begin();
+
+  // UI task only: the next gesture, or false after maxWaitMs without one
+  bool wait(ButtonEvent *out, uint32_t maxWaitMs);
+
+  // Edge ISR to UI task delay
+  const LatencyHistogram &edgeLatency() const { return _edgeLatency; }
+  uint32_t edges() const { return _edgeLatency.count(); }
+  uint32_t droppedEdges() const { return _droppedEdges; }
+
+private:
+  struct Edge {
+    uint8_t button;
+    bool pressed;
+    int64_t us;
+  };
+
+  struct Button {
+    ButtonInput *owner;
+    uint8_t id;
+    uint8_t pin;
+    bool pressed = false;        // Debounced
+    bool recheck = false;        // Edges during the debounce window
+    bool consumed = false;       // LONG or CHORD reported: the release is silent
+    bool clickPending = false;   // Released once, SHORT unless pressed again
+    bool secondPress = false;    // Pressed again in time: DOUBLE on release
+    int64_t acceptedUs = INT64_MIN / 2; // Last debounced change
+    int64_t pressUs = 0;
+    int64_t releaseUs = 0;
+    int64_t clickPressUs = 0;    // First press of a possible DOUBLE
+  };
+
+  static void IRAM_ATTR onInterrupt(void *arg);
+  void onEdge(const Edge &edge);
+  void accept(Button &b, bool pressed, int64_t us);
+  void onPress(Button &b, int64_t us);
+  void onRelease(Button &b, int64_t us);
+  void poll(int64_t nowUs);
+  int64_t nextDeadlineUs() const;
+  void emit(ButtonGesture gesture, ButtonId button, int64_t pressUs);
+
+  Button _buttons[BUTTON_COUNT];
+  QueueHandle_t _edges = nullptr;
+  volatile uint32_t _droppedEdges = 0;
+
+  static constexpr uint8_t PENDING_MAX = 4;
+  ButtonEvent _pending[PENDING_MAX]; // Gestures found but not yet returned by wait()
+  uint8_t _pendingHead = 0;
+  uint8_t _pendingCount = 0;
+
+  LatencyHistogram _edgeLatency;
+};
+
+extern ButtonInput buttonInput;
+
+#endif // BUTTON_INPUT_H
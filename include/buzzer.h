@@ -0,0 +1,73 @@
+// Buzzer melody sequencer
+// Plays short note patterns on the LEDC buzzer channel without blocking
+// anyone. play() queues a melody and wakes a one-shot esp_timer; the timer
+// callback (on the esp_timer task) starts each note and re-arms itself for
+// the note's duration, so a melody costs a queue send on the caller's side
+// and a few microseconds per note afterwards.
+//
+// A melody preempts the one playing if its priority is at least as high,
+// otherwise it is dropped: a late "page change" click is worth nothing
+// while "fix lost" is sounding.
+
+#ifndef BUZZER_H
+#define BUZZER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include "config.h"
+
+enum BuzzerMelody : uint8_t {
+  MELODY_PAGE_CHANGE,
+  MELODY_TOGGLE_ON,      // A button action was switched on
+  MELODY_TOGGLE_OFF,
+  MELODY_WIFI_UP,
+  MELODY_WIFI_FAILED,
+  MELODY_FIX_ACQUIRED,
+  MELODY_FIX_LOST,
+  MELODY_COUNT
+};
+
+struct BuzzerNote {
+  uint16_t frequency;   // Hz, 0 = rest
+  uint16_t durationMs;
+};
+
+class Buzzer {
+public:
+  // After the LEDC channel is attached to PIN_BUZZER
+  void begin();
+
+  // Any task, never blocks. Dropped when BUZZER_QUEUE_LEN are pending.
+  void play(BuzzerMelody melody);
+
+  // Muted: play() does nothing; melodies already queued still finish
+  void setMuted(bool muted) { _muted = muted; }
+  bool muted() const { return _muted; }
+
+  uint32_t played() const { return _played; }
+  uint32_t preempted() const { return _preempted; }
+  uint32_t dropped() const { return _dropped; }
+
+private:
+  static void onTimer(void *arg);
+  void step();
+  void arm(uint64_t delayUs);
+
+  QueueHandle_t _queue = nullptr;
+  esp_timer_handle_t _timer = nullptr;
+
+  // esp_timer task only
+  int8_t _melody = -1;       // Playing, -1 = silent
+  uint8_t _next = 0;         // Next note of _melody
+  int64_t _noteEndUs = 0;
+
+  std::atomic<uint32_t> _played{0};
+  std::atomic<uint32_t> _preempted{0};
+  std::atomic<uint32_t> _dropped{0};
+  std::atomic<bool> _muted{false};
+};
+
+extern Buzzer buzzer;
+
+#endif // BUZZER_H
@@ -22,8 +22,8 @@
 #define NEOPIXEL_BRIGHTNESS 50    // 0-255, a lower value is usually enough
 
 // Buttons (Input with pull-up)
-#define PIN_BUTTON_1        1     // Page switch button
-#define PIN_BUTTON_2        2     // Reserved for future use
+#define PIN_BUTTON_1        1     // Next page, track recording
+#define PIN_BUTTON_2        2     // Previous page, TTFF test
 
 // Buzzer
 #define PIN_BUZZER          3
@@ -65,6 +65,7 @@
 #define TFT_COLOR_WARNING   0xFFE0  // Yellow
 #define TFT_COLOR_ERROR     0xF800  // Red
 #define TFT_COLOR_SEPARATOR 0x4208  // Dark Gray
+#define TFT_COLOR_PREDICTED 0x07FF  // Cyan: dead-reckoned values
 
 // --- Tailles de police (pour Adafruit GFX) ---
 // Centralise les tailles de police pour une modification facile.
@@ -73,10 +74,35 @@
 #define FONT_SIZE_INIT      3     // Taille pour le message d'initialisation (réduit pour tenir)
 
 // Display pages
-#define NUM_PAGES           3
+#define NUM_PAGES           6
 #define PAGE_GPS_DATA       0
 #define PAGE_DIAGNOSTICS    1
 #define PAGE_SATELLITES     2
+#define PAGE_SKY            3
+#define PAGE_MAP            4
+#define PAGE_PROFILER       5
+
+// Display task (owns the TFT, see display_state.h)
+#define DISPLAY_TASK_CORE       0     // Not GPS_TASK_CORE
+#define DISPLAY_TASK_PRIORITY   1
+#define DISPLAY_TASK_STACK      6144
+#define DISPLAY_EVENT_QUEUE_LEN 8
+#define DISPLAY_MIN_FRAME_MS    50    // Frame budget: at most 20 redraws per second
+
+// Other tasks (app_tasks.h). loop() and the network task run their work as
+// Scheduler jobs (scheduler.h)
+#define GPS_TASK_CORE           1     // loop(): the Arduino loop task, created by the core
+#define GPS_TASK_PRIORITY       1
+#define SCHEDULER_MAX_JOBS      8     // Per task
+#define GPS_RX_WAKE_BYTES       32    // The UART wakes the GPS task every this many bytes, and at each pause
+#define GPS_CHECK_INTERVAL      250   // Fix and timeout checks while no UART data arrives (ms)
+#define NETWORK_TASK_CORE       0     // With the WiFi stack
+#define NETWORK_TASK_PRIORITY   1
+#define NETWORK_TASK_STACK      8192  // WiFi scan results, ArduinoJson documents
+#define NETWORK_WIFI_INTERVAL   100   // WiFi manager timers; its events wake the task at once (ms)
+#define UI_TASK_CORE            1
+#define UI_TASK_PRIORITY        2     // Above loop(), asleep until a button edge
+#define UI_TASK_STACK           3072
 
 // ============================================================================
 // GPS SETTINGS
@@ -99,22 +125,96 @@
 #define PIN_GPS_RXD         8     // Connects to GPS TX
 #define PIN_GPS_TXD         5     // Connects to GPS RX
 #define PIN_GPS_PPS         38    // Pulse Per Second
-#define GPS_UPDATE_RATE     1000  // Update display every 1000ms (1 Hz)
+#define GPS_UPDATE_RATE     1000  // Display redraw period when no new fix arrives (1 Hz)
 #define GPS_TIMEOUT         5000  // GPS data timeout in ms
 #define GPS_FIX_TIMEOUT     60000 // Time to wait for fix before warning (60s)
+#define SAT_TABLE_SIZE      32    // Satellites kept from GSV (sat_table.h)
+#define TRACK_HISTORY_SIZE  1024  // Breadcrumbs kept for the map page (track_history.h)
+#define TRACK_MIN_SPACING_CM 500  // New breadcrumb once moved this far (above fix jitter)
 #define HDOP_GOOD_THRESHOLD 2.0   // HDOP value below which the fix is considered "good"
 
+// --- Dead reckoning between fixes (dead_reckoning.h) ---
+#define DR_ENABLED          true
+#define DR_DISPLAY_RATE_HZ  10    // GPS page redraws while predicting (capped by DISPLAY_MIN_FRAME_MS)
+#define DR_MAX_HORIZON_MS   1500  // Longest extrapolation past a fix: 1.5 epochs at 1 Hz
+#define DR_MIN_SPEED_KMPH   2.0   // Course over ground is noise below walking pace
+
 // ============================================================================
 // WIFI SETTINGS
 // ============================================================================
-#define WIFI_CONNECT_TIMEOUT 10000 // WiFi connection timeout in ms
-#define WIFI_RETRY_DELAY     1000  // Delay between connection attempts
+#define WIFI_CONNECT_TIMEOUT 10000 // One scan or connection attempt, in ms
+#define WIFI_RETRY_DELAY     1000  // Backoff after a failed attempt, doubled per failure
+#define WIFI_RETRY_MAX_DELAY 30000 // Backoff cap in ms
+#define WIFI_MAX_NETWORKS    4     // SSIDs the connection manager can choose from
+#define WIFI_EVENT_QUEUE_LEN 8
+#define WIFI_ROAM_RSSI       -75   // dBm: below this, look for a stronger access point
+#define WIFI_ROAM_MARGIN_DB  8     // Roam only to an access point at least this much stronger
+#define WIFI_ROAM_CHECK_INTERVAL 30000 // ms between roaming scans while the signal is weak
 
 // ============================================================================
 // WEB SERVER SETTINGS
 // ============================================================================
 #define WEB_SERVER_PORT     80
-#define WEB_UPDATE_INTERVAL 1000   // WebSocket update interval in ms
+#define WEB_UPDATE_INTERVAL 1500   // WebSocket refresh while no epoch is published (ms); each epoch is sent at once
+#define WS_CLEANUP_INTERVAL 1000   // Closed WebSocket clients are freed this often (ms)
+
+// ============================================================================
+// NMEA TCP SERVER SETTINGS
+// ============================================================================
+// Raw NMEA fan-out for OpenCPN, u-center, etc. (10110 = standard NMEA-0183 port)
+#define NMEA_TCP_ENABLED         true
+#define NMEA_TCP_PORT            10110
+#define NMEA_TCP_MAX_CLIENTS     8    // lwIP in the Arduino core allows 16 TCP PCBs in total
+#define NMEA_TCP_CLIENT_INFLIGHT 16   // Unacked sentences per client before it is "lagging"
+// Shared sentence buffers (refcounted): every client can hold its in-flight
+// sentences plus one "latest" while the next sentence is being broadcast, so
+// slow clients can never starve the pool for the others
+#define NMEA_TCP_POOL_SLOTS      (NMEA_TCP_MAX_CLIENTS * (NMEA_TCP_CLIENT_INFLIGHT + 1) + 1)
+#define NMEA_MAX_SENTENCE        96   // NMEA 0183 allows 82 chars, keep some margin
+
+// ============================================================================
+// GPSD SERVER SETTINGS
+// ============================================================================
+// gpsd JSON protocol emulation for cgps, gpspipe and fleet collectors
+#define GPSD_ENABLED        true
+#define GPSD_PORT           2947
+#define GPSD_MAX_CLIENTS    4
+#define GPSD_DEVICE_PATH    "/dev/gps0"  // Device name reported in TPV/SKY/DEVICES
+#define GPSD_RELEASE        "3.25"       // gpsd release we claim compatibility with
+#define GPSD_RX_BUFFER      128          // Max length of a client command
+#define GPSD_SAT_JSON_SIZE  60           // Longest SKY "satellites" entry
+#define GPSD_LINE_SIZE      (192 + SAT_TABLE_SIZE * GPSD_SAT_JSON_SIZE) // Max length of a TPV/SKY report
+#define GPSD_POLL_SIZE      (GPSD_LINE_SIZE + 512)                      // Max length of a POLL report
+
+// ============================================================================
+// UDP FIX STREAM SETTINGS
+// ============================================================================
+// Opt-in binary fix datagram per epoch (format in udp_fix.h)
+#define UDP_FIX_ENABLED        false
+#define UDP_FIX_USE_BROADCAST  false          // true = subnet broadcast instead of multicast
+#define UDP_FIX_MULTICAST_ADDR 239, 255, 47, 47
+#define UDP_FIX_PORT           10111
+
+// ============================================================================
+// MQTT SETTINGS
+// ============================================================================
+// Opt-in publisher for a central broker (mosquitto...)
+#define MQTT_ENABLED            false
+#define MQTT_BROKER_HOST        "192.168.1.10"
+#define MQTT_BROKER_PORT        1883
+#define MQTT_USERNAME           ""          // Empty = anonymous
+#define MQTT_PASSWORD           ""
+#define MQTT_TOPIC_PREFIX       "gps-tester" // Topics: <prefix>/<client id>/fix and /stats
+#define MQTT_QOS                1
+#define MQTT_RECONNECT_MS       5000        // Delay between broker connection attempts
+#define MQTT_BATCH_EPOCHS       5           // Epochs per fix publish
+#define MQTT_EPOCH_QUEUE_LEN    32          // Snapshots from the GPS task waiting for the network task
+#define MQTT_BATCH_MAX_DELAY_MS 5000        // Publish a partial batch after this delay
+#define MQTT_BATCH_BUFFER       2048        // Max payload size of one batch
+#define MQTT_QUEUE_BYTES        (512 * 1024) // Offline queue in PSRAM
+#define MQTT_LOOP_INTERVAL      20          // Reconnects, partial batches and offline queue draining (ms)
+#define MQTT_DRAIN_PER_LOOP     8           // Queued batches published per MQTT_LOOP_INTERVAL when draining
+#define MQTT_STATS_INTERVAL     10000       // Statistics publish interval in ms
 
 // ============================================================================
 // BUZZER SETTINGS
@@ -123,40 +223,70 @@
 #define BUZZER_FREQ_LOST    1000   // Frequency for GPS fix lost (Hz)
 #define BUZZER_DURATION     200    // Buzzer duration in ms
 #define BUZZER_ENABLED      true   // Set to false to disable buzzer
+#define BUZZER_QUEUE_LEN    4      // Melodies waiting for the sequencer (buzzer.h)
 
 // ============================================================================
 // LED SETTINGS
 // ============================================================================
-// NeoPixel status colors (used in main.cpp)
-#define NEOPIXEL_COLOR_OFF      0
-#define NEOPIXEL_COLOR_BLUE     Adafruit_NeoPixel::Color(0, 0, 255)
-#define NEOPIXEL_COLOR_GREEN    Adafruit_NeoPixel::Color(0, 255, 0)
-#define NEOPIXEL_COLOR_RED      Adafruit_NeoPixel::Color(255, 0, 0)
-#define NEOPIXEL_BLINK_INTERVAL 500 // ms for blinking
+// NeoPixel status colors (0xRRGGBB, see status_led.h)
+#define NEOPIXEL_COLOR_OFF      0x000000
+#define NEOPIXEL_COLOR_BLUE     0x0000FF
+#define NEOPIXEL_COLOR_GREEN    0x00FF00
+#define NEOPIXEL_COLOR_RED      0xFF0000
+#define NEOPIXEL_BLINK_INTERVAL 500  // ms for blinking
+#define NEOPIXEL_BREATHE_PERIOD_MS 2000 // One fade in and out
+#define NEOPIXEL_BREATHE_STEP_MS   20   // Breathing update rate (unchanged colors are not resent)
+#define NEOPIXEL_RMT_CHANNEL    RMT_CHANNEL_0
 
 // ============================================================================
 // MEMORY ALLOCATION SETTINGS
 // ============================================================================
-// TFT sprite buffer size - Careful with PSRAM allocation
-// ESP32-S3 N16R8 has 8MB PSRAM, but be conservative
-// Full screen sprite would be 240*240*2 = 115,200 bytes
-// We'll use partial screen sprites to avoid bootloop
-#define USE_TFT_SPRITE      false  // Set to true to use sprites (needs testing)
-#define SPRITE_HEIGHT       80     // Height of sprite buffer (if used)
+// Full-screen framebuffer (frame_buffer.h): 2 x 240*240*2 = 2 x 115,200 bytes
+// in PSRAM. Falls back to direct drawing if the allocation fails.
+#define USE_TFT_SPRITE      true
+#define FRAMEBUFFER_FLUSH_CORE      1   // Not DISPLAY_TASK_CORE: the next frame renders while this one goes out
+#define FRAMEBUFFER_FLUSH_PRIORITY  0   // Below GPS_TASK_PRIORITY: UART ingest preempts a flush instead of sharing the core
+
+// Pre-rasterized text cache (text_cache.h): RGB565 blocks in PSRAM
+#define TEXT_CACHE_ENTRIES  16
+#define TEXT_CACHE_BYTES    (96 * 1024)  // PSRAM budget for cached pixels
+#define SPLASH_TITLE_SCALE  1.3f         // Custom font scale, 1.4 and up is wider than the screen
 
 // JSON buffer size for web data
 #define JSON_BUFFER_SIZE    2048
 
+// Scratch buffer for one Prometheus metric family (a labeled histogram is
+// ~1.4 KB, the largest family ~1.9 KB): twice that, families that still
+// overflow are dropped and counted (gps_tester_metrics_truncated_families_total)
+#define METRICS_FAMILY_BUFFER 4096
+
+// Heap report (/api/heap): free/largest block history, 24 h at 10 min
+#define HEAP_HISTORY_SIZE        144
+#define HEAP_SAMPLE_INTERVAL_MS  600000
+// Per-stage allocation tracking, set by the *_heapdebug build environment
+#ifndef HEAP_TRACKING
+  #define HEAP_TRACKING          false
+#endif
+
 // ============================================================================
-// BUTTON DEBOUNCE
+// BUTTONS (button_input.h)
 // ============================================================================
-#define BUTTON_DEBOUNCE_MS  50     // Debounce delay in milliseconds
+#define BUTTON_DEBOUNCE_MS      50   // Debounce delay in milliseconds
+#define BUTTON_LONG_PRESS_MS    800  // Held this long: long press
+#define BUTTON_DOUBLE_PRESS_MS  250  // Second press within this of the first release: double press
+#define BUTTON_EDGE_QUEUE_LEN   16   // Edges queued by the ISR for the UI task
 
 // ============================================================================
 // DEBUG SETTINGS
 // ============================================================================
 #define SERIAL_DEBUG_BAUD   115200
 #define DEBUG_ENABLED       true   // Set to false to disable debug output
+#define PROFILER_ENABLED    true   // Per-stage loop timing (CCOUNT), compiled out when false
+#define TRACE_ENABLED       true   // Chrome-trace event recorder, compiled out when false
+#define TRACE_AT_BOOT       false  // Start recording at boot (toggle at runtime with /trace?enable=1)
+#define TRACE_BUFFER_EVENTS 65536  // Ring size in events (8 bytes each, PSRAM), power of two
+#define LATENCY_BURST_GAP_MS 50    // UART silence that starts a new NMEA burst (fix latency tracking),
+                                   // longer than GPS_RX_WAKE_BYTES take to arrive
 
 #if DEBUG_ENABLED
   #define DEBUG_PRINT(x)    Serial.print(x)
@@ -0,0 +1,88 @@
+// Fixed-point coordinates
+// Latitude and longitude travel through the firmware as int32 in units of
+// 1e-7 degree (1.1 cm at the equator, +-1.8e9 fits an int32). The ESP32-S3
+// FPU only does single precision, so double math is done in software; here
+// the NMEA parse, the snapshot, the encoders and the distance math use
+// integers (int64 intermediates) and doubles are left to the few consumers
+// that want them.
+
+#ifndef COORD_E7_H
+#define COORD_E7_H
+
+#include <stdint.h>
+#include <math.h>
+
+#define COORD_E7_SCALE 10000000L
+
+// From TinyGPSPlus RawDegrees (whole degrees + billionths of a degree),
+// rounded half away from zero
+inline int32_t coordE7FromRaw(uint16_t deg, uint32_t billionths, bool negative) {
+  int32_t v = (int32_t)deg * COORD_E7_SCALE + (int32_t)((billionths + 50) / 100);
+  return negative ? -v : v;
+}
+
+inline int32_t coordE7FromDegrees(double degrees) {
+  return (int32_t)lround(degrees * COORD_E7_SCALE);
+}
+
+inline double coordE7ToDegrees(int32_t e7) {
+  return e7 / (double)COORD_E7_SCALE;
+}
+
+// Centimetres per 1e-7 degree of latitude (WGS84 mean radius, 1.11195 cm)
+// in Q24: cm = delta * COORD_E7_CM_Q24 >> 24 without overflow for any delta
+#define COORD_E7_CM_Q24 18655439LL
+
+// cos(latitude) in Q16: east/west degrees shrink by this factor. Single
+// precision, which the FPU does in hardware.
+inline int32_t coordE7LngScaleQ16(int32_t latE7) {
+  float latRad = (latE7 / (float)COORD_E7_SCALE) * (float)(M_PI / 180.0);
+  return (int32_t)lroundf(cosf(latRad) * 65536.0f);
+}
+
+// East/north offset in cm with a precomputed longitude scale, for callers
+// projecting many points around the same reference
+inline void coordE7OffsetCmScaled(int32_t lat0, int32_t lng0, int32_t lat1, int32_t lng1, int32_t lngScaleQ16,
+                                  int32_t *eastCm, int32_t *northCm) {
+  int64_t dLng = (int64_t)lng1 - lng0;
+  if (dLng > 180 * COORD_E7_SCALE) dLng -= 360LL * COORD_E7_SCALE;   // Shortest way
+  if (dLng < -180 * COORD_E7_SCALE) dLng += 360LL * COORD_E7_SCALE;  // across the antimeridian
+  int64_t dLat = (int64_t)lat1 - lat0;
+
+  *northCm = (int32_t)((dLat * COORD_E7_CM_Q24) >> 24);
+  *eastCm = (int32_t)((((dLng * lngScaleQ16) >> 16) * COORD_E7_CM_Q24) >> 24);
+}
+
+// East/north offset in cm from (lat0, lng0) to (lat1, lng1), equirectangular
+// around the mid latitude (exact enough for the few km around a receiver)
+inline void coordE7OffsetCm(int32_t lat0, int32_t lng0, int32_t lat1, int32_t lng1,
+                            int32_t *eastCm, int32_t *northCm) {
+  coordE7OffsetCmScaled(lat0, lng0, lat1, lng1, coordE7LngScaleQ16(lat0 / 2 + lat1 / 2), eastCm, northCm);
+}
+
+// Inverse of coordE7OffsetCm: the point eastCm/northCm away from (lat, lng),
+// equirectangular at lat (for offsets of a few km at most)
+inline void coordE7Move(int32_t lat, int32_t lng, int32_t eastCm, int32_t northCm, int32_t *latOut, int32_t *lngOut) {
+  int32_t lngScaleQ16 = coordE7LngScaleQ16(lat);
+  if (lngScaleQ16 < 1) lngScaleQ16 = 1; // At a pole any longitude will do
+  int64_t dLat = ((int64_t)northCm << 24) / COORD_E7_CM_Q24;
+  int64_t dLng = ((((int64_t)eastCm << 24) / COORD_E7_CM_Q24) << 16) / lngScaleQ16;
+
+  int64_t newLat = (int64_t)lat + dLat;
+  if (newLat > 90 * COORD_E7_SCALE) newLat = 90 * COORD_E7_SCALE;
+  if (newLat < -90 * COORD_E7_SCALE) newLat = -90 * COORD_E7_SCALE;
+  dLng %= 360LL * COORD_E7_SCALE; // Near a pole a few km east can be several turns
+  int64_t newLng = (int64_t)lng + dLng;
+  if (newLng > 180 * COORD_E7_SCALE) newLng -= 360LL * COORD_E7_SCALE;
+  if (newLng < -180 * COORD_E7_SCALE) newLng += 360LL * COORD_E7_SCALE;
+  *latOut = (int32_t)newLat;
+  *lngOut = (int32_t)newLng;
+}
+
+inline uint32_t coordE7DistanceCm(int32_t lat0, int32_t lng0, int32_t lat1, int32_t lng1) {
+  int32_t east, north;
+  coordE7OffsetCm(lat0, lng0, lat1, lng1, &east, &north);
+  return (uint32_t)sqrtf((float)east * east + (float)north * north);
+}
+
+#endif // COORD_E7_H
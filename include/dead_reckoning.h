@@ -0,0 +1,62 @@
+// Dead reckoning between fixes
+// Extrapolates the last fix along its course at its speed (constant
+// velocity) so the display can move between 1 Hz epochs. A prediction is
+// only made for a fresh fix moving faster than DR_MIN_SPEED_KMPH (the course
+// is noise below that) and never more than DR_MAX_HORIZON_MS past the fix,
+// which bounds the error to speed x horizon even if the receiver stops dead.
+// Each new fix replaces the prediction outright.
+//
+// DrErrorTracker measures the predictor from loop(): on each fix it compares
+// the fix with what the previous one predicted for that moment, next to the
+// error of holding the previous position. Replaying an NMEA log into the GPS
+// UART measures it on that track.
+
+#ifndef DEAD_RECKONING_H
+#define DEAD_RECKONING_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "gps_snapshot.h"
+
+struct DrPrediction {
+  bool predicted;      // False: the fix as received
+  int32_t latE7;
+  int32_t lngE7;
+  uint32_t horizonMs;  // Time extrapolated past the fix
+};
+
+// Position of `fix` horizonMs after it was received. Returns out->predicted.
+bool drPredict(const GpsSnapshot &fix, uint32_t horizonMs, DrPrediction *out);
+
+// Prediction for now (display task: the fix's age is the horizon)
+inline bool drPredictNow(const GpsSnapshot &fix, DrPrediction *out) {
+  unsigned long age = snapshotLocationAge(fix);
+  return drPredict(fix, age == ULONG_MAX ? 0 : (uint32_t)age, out);
+}
+
+class DrErrorTracker {
+public:
+  // Every published snapshot, in order
+  void onSnapshot(const GpsSnapshot &s);
+  void reset();
+
+  // Fixes checked against a prediction from the previous one
+  uint32_t count() const { return _count; }
+  uint32_t avgErrorCm() const { return _count ? (uint32_t)(_sumErrorCm / _count) : 0; }
+  uint32_t avgHoldErrorCm() const { return _count ? (uint32_t)(_sumHoldCm / _count) : 0; }
+  uint32_t maxErrorCm() const { return _maxErrorCm; }
+  uint64_t sumErrorCm() const { return _sumErrorCm; }
+  uint64_t sumHoldErrorCm() const { return _sumHoldCm; }
+
+private:
+  GpsSnapshot _prev = {};
+  bool _hasPrev = false;
+  uint32_t _count = 0;
+  uint64_t _sumErrorCm = 0;
+  uint64_t _sumHoldCm = 0;
+  uint32_t _maxErrorCm = 0;
+};
+
+extern DrErrorTracker drErrors;
+
+#endif // DEAD_RECKONING_H
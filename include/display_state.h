@@ -0,0 +1,43 @@
+// Display task inputs
+// The display task owns the TFT: once it runs nothing else draws. The GPS
+// task (loop()) publishes a DisplayState copy into a one-slot queue (latest
+// value wins, an unread older state is overwritten); any task sends
+// DisplayEvents (page changes, splash screens, redraw requests) through a
+// second queue. The header's WiFi status comes from netStatus (app_tasks.h).
+
+#ifndef DISPLAY_STATE_H
+#define DISPLAY_STATE_H
+
+#include <Arduino.h>
+#include "gps_snapshot.h"
+#include "sat_table.h"
+
+struct DisplayState {
+  GpsSnapshot fix;
+  uint32_t validSentences;
+  uint32_t failedChecksums;
+  uint32_t totalSentences;
+  unsigned long fixAcquiredMs;
+  unsigned long ttffStartMs; // TTFF test running since (0 = none)
+  uint32_t ttffMs;           // Last TTFF test result (0 = none)
+  SkyView sky;
+  uint32_t drChecks;       // Dead-reckoning error so far (DrErrorTracker)
+  uint32_t drAvgErrorCm;
+  uint32_t drAvgHoldCm;
+};
+
+enum DisplayEventType : uint8_t {
+  DISPLAY_EVENT_REFRESH,   // A new DisplayState was published
+  DISPLAY_EVENT_NEXT_PAGE,
+  DISPLAY_EVENT_PREV_PAGE,
+  DISPLAY_EVENT_FIRST_PAGE,
+  DISPLAY_EVENT_SPLASH     // Init screen with three status lines
+};
+
+struct DisplayEvent {
+  DisplayEventType type;
+  uint16_t holdMs;         // Splash: minimum time before pages are drawn again
+  char lines[3][32];
+};
+
+#endif // DISPLAY_STATE_H
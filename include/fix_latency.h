@@ -0,0 +1,81 @@
+// End-to-end fix latency
+// Tags every epoch with the time it reached each stage of the pipeline, from
+// the UART to the outputs, and keeps one latency histogram per hop:
+//
+//   pps_uart       PPS edge            -> first byte of the NMEA burst
+//   uart_valid     first byte          -> epoch-closing sentence validated
+//   valid_publish  sentence validated  -> snapshot published to gpsd/UDP/MQTT
+//   publish_ws     snapshot published  -> WebSocket frame queued
+//   publish_tft    snapshot published  -> TFT page redrawn (SPI writes done)
+//   uart_ws        first byte          -> WebSocket frame queued
+//   uart_tft       first byte          -> TFT page redrawn
+//
+// Timestamps are esp_timer microseconds taken in loop(), so "first byte" is
+// when loop() drains the UART driver, not the wire time. A burst starts with
+// the first data seen after LATENCY_BURST_GAP_MS of UART silence; loop() only
+// sees data every GPS_RX_WAKE_BYTES, so the gap must be longer than that.
+// Each published epoch triggers the WebSocket broadcast, so publish_ws is
+// the network task's wake-up and send, not the phase of WEB_UPDATE_INTERVAL.
+
+#ifndef FIX_LATENCY_H
+#define FIX_LATENCY_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "metrics.h"
+
+enum LatencyHop : uint8_t {
+  HOP_PPS_UART,
+  HOP_UART_VALID,
+  HOP_VALID_PUBLISH,
+  HOP_PUBLISH_WS,
+  HOP_PUBLISH_TFT,
+  HOP_UART_WS,
+  HOP_UART_TFT,
+  HOP_COUNT
+};
+
+extern const char *const LATENCY_HOP_NAMES[HOP_COUNT];
+
+// Stage timestamps of one epoch (esp_timer us, 0 = stage not reached)
+struct EpochTiming {
+  uint32_t epoch;
+  int64_t ppsUs;
+  int64_t firstByteUs;
+  int64_t validatedUs;
+  int64_t publishedUs;
+  int64_t wsQueuedUs;
+  int64_t tftFlushedUs;
+};
+
+class FixLatencyTracker {
+public:
+  // Pipeline events, all called from loop()
+  void onUartData(int64_t nowUs);
+  void onSentenceValid(int64_t nowUs);
+  void onPublished(uint32_t epoch, int64_t nowUs, int64_t ppsUs);
+  void onWsQueued(uint32_t epoch, int64_t nowUs);
+  void onTftFlushed(uint32_t epoch, int64_t nowUs);
+
+  void reset();
+
+  // GPS task only: the other tasks read the latencyStatus copy (app_tasks.h)
+  const LatencyHistogram &hop(LatencyHop h) const { return _hops[h]; }
+  // Most recent epoch that went through both outputs (or was superseded)
+  const EpochTiming &lastEpoch() const { return _last; }
+
+private:
+  void record(LatencyHop h, int64_t fromUs, int64_t toUs);
+  void retire();
+
+  LatencyHistogram _hops[HOP_COUNT];
+  EpochTiming _current = {};    // Published, waiting for WS/TFT
+  EpochTiming _last = {};
+  int64_t _lastUartUs = 0;
+  int64_t _burstStartUs = 0;
+  int64_t _validatedUs = 0;
+};
+
+extern FixLatencyTracker fixLatency;
+
+#endif // FIX_LATENCY_H
@@ -0,0 +1,105 @@
+// PSRAM framebuffer with background flush
+// All drawing goes to a full-screen RGB565 canvas in PSRAM. Every write marks
+// the 16x16 tiles it touches; present() copies the dirty tiles to a second
+// PSRAM buffer and wakes a flush task on FRAMEBUFFER_FLUSH_CORE (not the
+// display task's core), which streams them to the panel as merged rectangles.
+// The display task can draw the next frame while the previous one is on the
+// wire, and the panel only ever receives whole frames.
+//
+// Adafruit_SPITFT has no DMA path on ESP32, so the flush task pushes pixels
+// with SPIClass::writePixels(); the CPU time it costs is on the flush core.
+// That is the GPS task's core, so the flush runs below GPS_TASK_PRIORITY and
+// only gets the time loop() sleeps through; flushState() lets the GPS task
+// measure its wake-ups against a flush in progress.
+// The canvas uses screen coordinates; the TFT applies its own rotation.
+
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <atomic>
+#include "config.h"
+#include "metrics.h"
+
+class Adafruit_SPITFT;
+
+#define FB_TILE       16
+#define FB_TILES_X    ((TFT_WIDTH + FB_TILE - 1) / FB_TILE)
+#define FB_TILES_Y    ((TFT_HEIGHT + FB_TILE - 1) / FB_TILE)
+#define FB_TILE_COUNT (FB_TILES_X * FB_TILES_Y)
+
+// What the flush task is sending: nothing, some tiles, or the whole screen
+enum FlushState : uint8_t { FLUSH_IDLE, FLUSH_PARTIAL, FLUSH_FULL, FLUSH_STATE_COUNT };
+extern const char *const FLUSH_STATE_NAMES[FLUSH_STATE_COUNT];
+
+class FrameBuffer : public Adafruit_GFX {
+public:
+  FrameBuffer() : Adafruit_GFX(TFT_WIDTH, TFT_HEIGHT) {}
+
+  // Allocates both buffers in PSRAM and starts the flush task.
+  // On failure keep drawing straight to the TFT.
+  bool begin(Adafruit_SPITFT *tft);
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+  // Row copies instead of the per-pixel Adafruit_GFX version
+  using Adafruit_GFX::drawRGBBitmap;
+  void drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h);
+
+  // Hands the dirty tiles to the flush task. Waits if the previous frame is
+  // still being sent. tag is returned by takeFlushed() once on the panel.
+  void present(uint32_t tag);
+  // True once per completed flush
+  bool takeFlushed(uint32_t *tag, int64_t *flushedUs);
+  // Called by the flush task after each flush, so takeFlushed() need not be polled
+  void onFlushed(void (*callback)()) { _onFlushed = callback; }
+
+  // False if begin() failed and drawing goes straight to the TFT
+  bool active() const { return _buffer != nullptr; }
+  // Copies row y of the last presented frame (what the panel shows). Never
+  // waits for present(), so a row copied while it runs may mix two frames.
+  void readShownRow(int16_t y, uint16_t *out) const;
+
+  const LatencyHistogram &flushTime() const { return _flushTime; }
+  uint32_t pixelsFlushed() const { return _pixelsFlushed; }
+  // Any task, at any time
+  FlushState flushState() const { return _flushing.load(std::memory_order_relaxed); }
+
+private:
+  struct Rect {
+    int16_t x, y, w, h;
+  };
+
+  void markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+  void buildRects();
+  void flush();
+  static void flushTask(void *arg);
+
+  Adafruit_SPITFT *_tft = nullptr;
+  uint16_t *_buffer = nullptr;  // Drawn by the loop
+  uint16_t *_shadow = nullptr;  // Read by the flush task
+  uint32_t _dirty[(FB_TILE_COUNT + 31) / 32] = {};
+
+  Rect _rects[FB_TILE_COUNT];
+  size_t _rectCount = 0;
+  uint32_t _tag = 0;
+
+  TaskHandle_t _task = nullptr;
+  void (*_onFlushed)() = nullptr;
+  SemaphoreHandle_t _idle = nullptr; // Given while no flush is in progress
+
+  std::atomic<FlushState> _flushing{FLUSH_IDLE};
+  std::atomic<bool> _flushed{false};
+  uint32_t _flushedTag = 0;
+  int64_t _flushedUs = 0;
+  LatencyHistogram _flushTime;
+  uint32_t _pixelsFlushed = 0;
+};
+
+extern FrameBuffer frameBuffer;
+
+#endif // FRAME_BUFFER_H
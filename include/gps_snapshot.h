@@ -0,0 +1,53 @@
+// Per-epoch GPS fix snapshot
+// Filled once per navigation epoch from TinyGPSPlus and shared by every output
+// (TFT, WebSocket JSON, gpsd server...), so they all report the same fix.
+
+#ifndef GPS_SNAPSHOT_H
+#define GPS_SNAPSHOT_H
+
+#include <Arduino.h>
+#include <limits.h>
+#include "config.h"
+#include "coord_e7.h"
+
+struct GpsSnapshot {
+  uint32_t epoch;            // Incremented on every published epoch (0 = none yet)
+  unsigned long publishedMs; // millis() at publication
+
+  bool locationValid;
+  int32_t latE7;               // 1e-7 degree (coord_e7.h)
+  int32_t lngE7;
+  unsigned long locationAgeMs; // TinyGPSPlus location age at publication (ULONG_MAX = never)
+
+  bool altitudeValid;
+  double altitudeM;
+  bool speedValid;
+  double speedKmph;
+  bool courseValid;
+  double courseDeg;
+  bool hdopValid;
+  double hdop;
+  uint32_t satellites;
+
+  bool dateValid;
+  uint16_t year;
+  uint8_t month;
+  uint8_t day;
+  bool timeValid;
+  uint8_t hour;
+  uint8_t minute;
+  uint8_t second;
+  uint8_t centisecond;
+};
+
+// Location age as of now, derived from the age recorded at publication
+inline unsigned long snapshotLocationAge(const GpsSnapshot &s) {
+  if (s.locationAgeMs == ULONG_MAX) return ULONG_MAX;
+  return s.locationAgeMs + (millis() - s.publishedMs);
+}
+
+inline bool snapshotHasFix(const GpsSnapshot &s) {
+  return s.locationValid && snapshotLocationAge(s) < GPS_TIMEOUT;
+}
+
+#endif // GPS_SNAPSHOT_H
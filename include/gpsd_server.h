@@ -0,0 +1,69 @@
+// gpsd-compatible JSON protocol server
+// Emulates the subset of the gpsd protocol used by cgps, gpspipe and most
+// collectors: VERSION banner, ?WATCH, ?POLL, ?VERSION, ?DEVICES, and TPV/SKY
+// reports generated from the per-epoch GpsSnapshot.
+
+#ifndef GPSD_SERVER_H
+#define GPSD_SERVER_H
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include "config.h"
+#include "gps_snapshot.h"
+#include "sat_table.h"
+
+class GpsdServer {
+public:
+  explicit GpsdServer(uint16_t port);
+
+  void begin();
+  void end();
+
+  // New epoch: TPV + SKY to every client with an active JSON watch
+  void publish(const GpsSnapshot &snapshot, const SkyView &sky);
+  // Raw sentence (without CR/LF) to clients watching with "nmea" or "raw"
+  void forwardNmea(const char *sentence, size_t len);
+
+  size_t clientCount() const { return _clientCount; }
+  uint32_t totalDrops() const { return _totalDrops; }
+
+private:
+  struct Client {
+    AsyncClient *tcp;
+    bool watchJson;
+    bool watchNmea;
+    char rx[GPSD_RX_BUFFER];
+    size_t rxLen;
+  };
+
+  Client *findClient(AsyncClient *tcp);
+  void sendLine(Client &client, const char *line, size_t len);
+  void handleCommand(Client &client, const char *cmd);
+
+  void handleConnect(AsyncClient *tcp);
+  void handleDisconnect(AsyncClient *tcp);
+  void handleData(AsyncClient *tcp, const char *data, size_t len);
+
+  size_t formatVersion(char *buf, size_t cap);
+  size_t formatDevices(char *buf, size_t cap);
+  size_t formatWatch(char *buf, size_t cap, const Client &client);
+  size_t formatTpv(char *buf, size_t cap, const GpsSnapshot &s);
+  size_t formatSky(char *buf, size_t cap, const GpsSnapshot &s, const SkyView &sky);
+  size_t formatPoll(char *buf, size_t cap);
+
+  AsyncServer _server;
+  SemaphoreHandle_t _lock = nullptr;
+  Client _clients[GPSD_MAX_CLIENTS];
+  size_t _clientCount = 0;
+  GpsSnapshot _last;
+  SkyView _lastSky;
+  // Reports are too big for the task stacks: _tpv/_sky belong to publish()
+  // (GPS task), _reply to the callbacks and is only used under _lock
+  char _tpv[GPSD_LINE_SIZE];
+  char _sky[GPSD_LINE_SIZE];
+  char _reply[GPSD_POLL_SIZE];
+  uint32_t _totalDrops = 0;
+  bool _running = false;
+};
+
+#endif // GPSD_SERVER_H
@@ -0,0 +1,97 @@
+// Heap allocation tracker and fragmentation history
+// In the heap debug build (HEAP_TRACKING, see the *_heapdebug environment in
+// platformio.ini) malloc/calloc/realloc/free are wrapped at link time and every
+// allocation is attributed to the profiler stage the allocating task was in
+// (each task keeps its own current stage). Allocations made outside any stage
+// by tasks other than loop() (AsyncTCP, WiFi, timers) are counted separately.
+// The loop task should reach zero allocations per loop() once the fix is
+// acquired; the report shows how far it is from that target.
+//
+// The free/largest-block history is sampled in every build.
+
+#ifndef HEAP_TRACKER_H
+#define HEAP_TRACKER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "profiler.h"
+
+// Attribution buckets: the profiler stages, then these two
+#define HEAP_BUCKET_OTHER_TASKS STAGE_COUNT       // Any task but the Arduino loop task, outside any stage
+#define HEAP_BUCKET_UNSTAGED    (STAGE_COUNT + 1) // Loop task outside any stage (setup)
+#define HEAP_BUCKETS            (STAGE_COUNT + 2)
+
+const char *heapBucketName(uint8_t bucket);
+
+struct HeapBucketStats {
+  uint32_t allocs;
+  uint32_t frees;
+  uint32_t bytes;
+};
+
+struct HeapSample {
+  uint32_t uptimeS;
+  uint32_t freeBytes;
+  uint32_t largestBlock;
+  uint32_t minFreeBytes;
+};
+
+// 100 - largest block as a percentage of free heap (0 = one contiguous block)
+inline uint8_t heapFragmentationPct(uint32_t freeBytes, uint32_t largestBlock) {
+  if (freeBytes == 0) return 0;
+  return 100 - (uint8_t)((uint64_t)largestBlock * 100 / freeBytes);
+}
+
+class HeapTracker {
+public:
+  // Call from setup(): the calling task becomes the loop task
+  void begin();
+  // Call once at the end of loop()
+  void onLoopEnd();
+
+  // Allocation hooks (heap debug build only)
+  void onAlloc(size_t size);
+  void onFree();
+
+  HeapBucketStats bucket(uint8_t index) const;
+  uint32_t lastLoopAllocs() const { return _lastLoopAllocs; }
+  uint32_t maxLoopAllocs() const { return _maxLoopAllocs; }
+  uint32_t loopsWithAllocs() const { return _loopsWithAllocs; }
+  uint32_t loops() const { return _loops; }
+  // Any task: the per-loop counters are cleared by the loop task in onLoopEnd()
+  void resetCounters();
+
+  // History, oldest first
+  size_t historyCount() const { return _historyCount; }
+  HeapSample historyAt(size_t i) const;
+
+private:
+  void sample();
+  uint8_t currentBucket() const;
+
+  struct Bucket {
+    std::atomic<uint32_t> allocs{0};
+    std::atomic<uint32_t> frees{0};
+    std::atomic<uint32_t> bytes{0};
+  };
+
+  Bucket _buckets[HEAP_BUCKETS];
+  TaskHandle_t _loopTask = nullptr;
+  uint32_t _loopTaskAllocs = 0;
+  uint32_t _allocsAtLoopStart = 0;
+  uint32_t _lastLoopAllocs = 0;
+  uint32_t _maxLoopAllocs = 0;
+  uint32_t _loopsWithAllocs = 0;
+  uint32_t _loops = 0;
+  std::atomic<bool> _loopResetPending{false};
+
+  HeapSample _history[HEAP_HISTORY_SIZE];
+  size_t _historyHead = 0;
+  size_t _historyCount = 0;
+  unsigned long _lastSampleMs = 0;
+};
+
+extern HeapTracker heapTracker;
+
+#endif // HEAP_TRACKER_H
@@ -0,0 +1,17 @@
+// Scoped FreeRTOS mutex lock shared by the network services
+
+#ifndef LOCK_GUARD_H
+#define LOCK_GUARD_H
+
+#include <Arduino.h>
+
+struct LockGuard {
+  explicit LockGuard(SemaphoreHandle_t lock) : _lock(lock) { xSemaphoreTake(_lock, portMAX_DELAY); }
+  ~LockGuard() { xSemaphoreGive(_lock); }
+  LockGuard(const LockGuard &) = delete;
+  LockGuard &operator=(const LockGuard &) = delete;
+
+  SemaphoreHandle_t _lock;
+};
+
+#endif // LOCK_GUARD_H
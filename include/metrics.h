@@ -0,0 +1,104 @@
+// Firmware metrics and Prometheus text exposition
+// Counters and histograms are plain integers updated in place on the hot
+// paths; /metrics renders them in chunks straight into the HTTP response
+// buffer, so a scrape never builds a String.
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+class AsyncWebServerRequest;
+
+// ============================================================================
+// LATENCY HISTOGRAM
+// ============================================================================
+// Fixed buckets in microseconds (the last one is +Inf)
+#define LATENCY_BUCKET_COUNT 15
+extern const uint32_t LATENCY_BUCKET_BOUNDS_US[LATENCY_BUCKET_COUNT - 1];
+
+class LatencyHistogram {
+public:
+  void record(uint32_t us);
+  void reset();
+
+  uint32_t count() const { return _count; }
+  uint64_t sumUs() const { return _sumUs; }
+  uint32_t minUs() const { return _count ? _minUs : 0; }
+  uint32_t maxUs() const { return _maxUs; }
+  uint32_t avgUs() const { return _count ? (uint32_t)(_sumUs / _count) : 0; }
+  uint32_t bucket(size_t i) const { return _buckets[i]; }
+
+private:
+  uint32_t _buckets[LATENCY_BUCKET_COUNT] = {};
+  uint32_t _count = 0;
+  uint64_t _sumUs = 0;
+  uint32_t _minUs = UINT32_MAX;
+  uint32_t _maxUs = 0;
+};
+
+// ============================================================================
+// FIRMWARE COUNTERS
+// ============================================================================
+enum NmeaSentenceType : uint8_t {
+  NMEA_GGA, NMEA_RMC, NMEA_GSA, NMEA_GSV, NMEA_VTG, NMEA_GLL, NMEA_ZDA, NMEA_TXT, NMEA_OTHER,
+  NMEA_TYPE_COUNT
+};
+extern const char *const NMEA_TYPE_NAMES[NMEA_TYPE_COUNT];
+
+// "$GPGGA,..." -> NMEA_GGA
+NmeaSentenceType nmeaSentenceType(const char *sentence, size_t len);
+
+struct FirmwareMetrics {
+  uint32_t uartBytes;
+  uint32_t uartErrors;
+  uint32_t sentences[NMEA_TYPE_COUNT];
+  uint32_t wsMessages;
+  LatencyHistogram loopTime;
+  LatencyHistogram displayFrame;
+  uint32_t displayFramePixels;
+  uint32_t truncatedFamilies;  // /metrics families too big for METRICS_FAMILY_BUFFER
+};
+
+extern FirmwareMetrics metrics;
+
+// ============================================================================
+// PROMETHEUS TEXT WRITER
+// ============================================================================
+class MetricsWriter {
+public:
+  MetricsWriter(char *buf, size_t cap) : _buf(buf), _cap(cap) {}
+
+  void header(const char *name, const char *help, const char *type);
+  void sample(const char *name, const char *labels, double value);
+  void sample(const char *name, const char *labels, uint64_t value);
+
+  // HELP/TYPE header + single unlabeled sample
+  void counter(const char *name, const char *help, uint64_t value);
+  void gauge(const char *name, const char *help, double value);
+  // Buckets are exported in seconds, as Prometheus expects
+  void histogram(const char *name, const char *help, const LatencyHistogram &h);
+  // Bucket/sum/count lines of one labeled series, after a header() call
+  void histogramSamples(const char *name, const char *labels, const LatencyHistogram &h);
+
+  size_t length() const { return _len; }
+  // appendf() stops at cap - 1, so a full buffer means something was cut
+  bool truncated() const { return _len + 1 >= _cap; }
+
+private:
+  char *_buf;
+  size_t _cap;
+  size_t _len = 0;
+};
+
+// Renders metric family number `index` and returns false past the last one.
+// Each family must fit in METRICS_FAMILY_BUFFER bytes: one that does not is
+// replaced by a comment line and counted in metrics.truncatedFamilies, so the
+// output stays valid Prometheus text.
+typedef bool (*MetricsFamilyRenderer)(MetricsWriter &writer, uint8_t index);
+
+// Streams all families as a chunked text/plain response
+void sendMetricsResponse(AsyncWebServerRequest *request, MetricsFamilyRenderer render);
+
+#endif // METRICS_H
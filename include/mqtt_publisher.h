@@ -0,0 +1,75 @@
+// MQTT publisher
+// Publishes fix snapshots and statistics to a central broker.
+//  - Fix records are batched: several epochs go into one JSON array payload.
+//    The GPS task hands over every epoch through a FreeRTOS queue, so none is
+//    skipped while the network task is busy.
+//  - While the broker or WiFi is unreachable, finished batches are queued in a
+//    PSRAM ring buffer and drained in bulk after reconnection.
+
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include <Arduino.h>
+#include <AsyncMqttClient.h>
+#include "config.h"
+#include "gps_snapshot.h"
+
+class MqttPublisher {
+public:
+  void begin();
+
+  // GPS task: never waits, counts the epoch as dropped if the queue is full
+  void queueEpoch(const GpsSnapshot &snapshot);
+
+  // Network task only: batches the queued epochs
+  void addQueuedEpochs();
+  // Network task only: queued epochs, reconnection, batch timeout and
+  // queue draining
+  void loop(bool wifiUp);
+
+  void publishStats(const char *json, size_t len);
+
+  bool connected() const { return _connected; }
+  size_t queuedBatches() const { return _queuedBatches; }
+  size_t queuedBytes() const { return _queueUsed; }
+  uint32_t published() const { return _published; }
+  uint32_t droppedBatches() const { return _dropped; }
+  uint32_t droppedEpochs() const { return _droppedEpochs; }
+
+private:
+  void connect();
+  void addEpoch(const GpsSnapshot &snapshot);
+  void closeBatch();
+  bool publishBatch(const char *payload, size_t len);
+
+  bool enqueue(const char *payload, size_t len);
+  size_t peekQueued(char *out, size_t cap);
+  void popQueued();
+  void ringWrite(const void *src, size_t len);
+  void ringRead(size_t pos, void *dst, size_t len);
+
+  AsyncMqttClient _client;
+  QueueHandle_t _epochs = nullptr;
+  char _clientId[24];
+  char _fixTopic[64];
+  char _statsTopic[64];
+
+  char _batch[MQTT_BATCH_BUFFER];
+  size_t _batchLen = 0;
+  uint8_t _batchEpochs = 0;
+  unsigned long _batchStartMs = 0;
+  char _tx[MQTT_BATCH_BUFFER];
+
+  uint8_t *_queue = nullptr; // PSRAM ring of [uint16 len][payload] records
+  size_t _queueHead = 0;     // Oldest record
+  size_t _queueUsed = 0;
+  size_t _queuedBatches = 0;
+
+  volatile bool _connected = false;
+  unsigned long _lastAttemptMs = 0;
+  uint32_t _published = 0;
+  uint32_t _dropped = 0;
+  volatile uint32_t _droppedEpochs = 0;
+};
+
+#endif // MQTT_PUBLISHER_H
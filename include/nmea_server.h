@@ -0,0 +1,89 @@
+// NMEA TCP fan-out server
+// Broadcasts every checksum-valid NMEA sentence to the connected TCP clients
+// (OpenCPN, u-center, loggers...) on NMEA_TCP_PORT.
+
+#ifndef NMEA_SERVER_H
+#define NMEA_SERVER_H
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include "config.h"
+
+// Each sentence is copied once into a refcounted pool slot and handed to
+// every client with AsyncClient::add() without ASYNC_WRITE_FLAG_COPY, so lwIP
+// references the same bytes for all clients. A slot is released when all
+// clients have received the TCP ACK for it.
+// Clients that cannot keep up (no send window or too many sentences in
+// flight) fall back to "latest sentence only": older pending sentences are
+// dropped and counted, and the newest one is sent as soon as the window opens.
+static_assert(NMEA_TCP_POOL_SLOTS >= NMEA_TCP_MAX_CLIENTS * (NMEA_TCP_CLIENT_INFLIGHT + 1) + 1,
+              "Slow clients could hold every pool slot");
+static_assert(NMEA_TCP_POOL_SLOTS <= 255, "Slot indexes and refcounts are uint8_t");
+
+class NmeaTcpServer {
+public:
+  struct ClientStats {
+    uint32_t id;
+    IPAddress ip;
+    uint32_t bytesSent;
+    uint32_t sentencesSent;
+    uint32_t drops;
+    uint32_t connectedMs;
+  };
+
+  explicit NmeaTcpServer(uint16_t port);
+
+  void begin();
+  void end();
+
+  // Sends one sentence (without CR/LF, they are appended here) to all clients.
+  void broadcast(const char *sentence, size_t len);
+
+  size_t clientCount() const { return _clientCount; }
+  uint32_t totalDrops() const { return _totalDrops; }
+  uint32_t totalBytesSent() const { return _totalBytesSent; }
+  size_t getClientStats(ClientStats *out, size_t maxCount);
+
+private:
+  struct Slot {
+    char data[NMEA_MAX_SENTENCE + 2];
+    uint8_t len;
+    uint8_t refs;
+  };
+
+  struct Client {
+    AsyncClient *tcp;
+    uint32_t id;
+    uint8_t inflight[NMEA_TCP_CLIENT_INFLIGHT]; // Slot indexes waiting for ACK
+    uint8_t inflightHead;
+    uint8_t inflightCount;
+    uint32_t ackCarry;  // Acked bytes not yet matching a whole sentence
+    int16_t latest;     // Pending slot for a lagging client (-1 = none)
+    uint32_t bytesSent;
+    uint32_t sentencesSent;
+    uint32_t drops;
+    uint32_t connectedAt;
+  };
+
+  int acquireSlot();
+  void releaseSlot(int slot);
+  bool trySend(Client &client, int slot);
+  Client *findClient(AsyncClient *tcp);
+
+  void handleConnect(AsyncClient *tcp);
+  void handleDisconnect(AsyncClient *tcp);
+  void handleAck(AsyncClient *tcp, size_t len);
+
+  AsyncServer _server;
+  SemaphoreHandle_t _lock = nullptr;
+  Slot _slots[NMEA_TCP_POOL_SLOTS];
+  uint8_t _nextSlot = 0;
+  Client _clients[NMEA_TCP_MAX_CLIENTS];
+  size_t _clientCount = 0;
+  uint32_t _nextClientId = 1;
+  uint32_t _totalDrops = 0;
+  uint32_t _totalBytesSent = 0;
+  bool _running = false;
+};
+
+#endif // NMEA_SERVER_H
@@ -0,0 +1,73 @@
+// Allocation-free number formatting
+// Fixed-point and integer to decimal conversion into caller-provided buffers,
+// shared by the TFT pages and the WebSocket JSON so both show the same
+// digits. Values are rounded once to an integer of 10^-decimals units and
+// converted with integer arithmetic: no String, no heap, no printf parsing.
+//
+// Decimals, units and truncation live in the constexpr tables below. Every
+// function NUL-terminates, truncates instead of overrunning and returns the
+// length written.
+
+#ifndef NUM_FORMAT_H
+#define NUM_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FMT_MISSING "--"
+
+struct NumFormat {
+  uint8_t decimals;
+  const char *unit;  // Appended after the digits
+  uint8_t maxDigits; // Truncate the digits (not rounded) to this many chars, 0 = no limit
+};
+
+// TFT: units without a space, coordinates cut to the 7 characters that fit
+constexpr NumFormat FMT_TFT_COORD   = {6, "", 7};
+constexpr NumFormat FMT_TFT_ALT     = {1, "m", 0};
+constexpr NumFormat FMT_TFT_SPEED   = {1, "km/h", 0};
+constexpr NumFormat FMT_TFT_DIST    = {1, "m", 0};
+constexpr NumFormat FMT_TFT_SECONDS = {1, "s", 0};
+// WebSocket JSON: full precision, units after a space
+constexpr NumFormat FMT_JSON_COORD  = {6, "", 0};
+constexpr NumFormat FMT_JSON_ALT    = {1, " m", 0};
+constexpr NumFormat FMT_JSON_SPEED  = {1, " km/h", 0};
+// gpsd / MQTT JSON: every digit of the fixed-point coordinate
+constexpr NumFormat FMT_WIRE_COORD  = {7, "", 0};
+// Shared
+constexpr NumFormat FMT_COURSE      = {1, "\xC2\xB0", 0}; // UTF-8 degree sign
+constexpr NumFormat FMT_HDOP        = {2, "", 0};
+constexpr NumFormat FMT_PERCENT     = {1, "%", 0};
+constexpr NumFormat FMT_RATE_HZ     = {1, " Hz", 0};
+
+struct DurationFormat {
+  bool hours;       // false: minutes are not wrapped at 60
+  const char *h, *m, *s;
+};
+
+constexpr DurationFormat FMT_DURATION_COMPACT = {true, "h", "m", "s"};    // 1h2m3s
+constexpr DurationFormat FMT_DURATION_SPACED  = {true, "h ", "m ", "s"};  // 1h 2m 3s
+constexpr DurationFormat FMT_DURATION_MIN_SEC = {false, "", "m ", "s"};   // 62m 3s
+
+// Below one second in ms, whole seconds above
+struct AgeFormat {
+  const char *ms, *s;
+};
+
+constexpr AgeFormat FMT_TFT_AGE  = {"ms", "s"};
+constexpr AgeFormat FMT_JSON_AGE = {" ms", " s"};
+
+size_t fmtUint(char *out, size_t cap, uint32_t value);
+// value in units of 10^-valueDecimals (e.g. degrees * 1e7), rounded to f.decimals
+size_t fmtScaled(char *out, size_t cap, int64_t value, uint8_t valueDecimals, const NumFormat &f);
+// Non-finite or huge values print FMT_MISSING
+size_t fmtFloat(char *out, size_t cap, double value, const NumFormat &f);
+// FMT_MISSING when !valid (TinyGPSPlus-style validity flags)
+size_t fmtFloatIf(bool valid, char *out, size_t cap, double value, const NumFormat &f);
+size_t fmtScaledIf(bool valid, char *out, size_t cap, int64_t value, uint8_t valueDecimals, const NumFormat &f);
+size_t fmtDuration(char *out, size_t cap, uint32_t seconds, const DurationFormat &f);
+size_t fmtAge(char *out, size_t cap, uint32_t ms, const AgeFormat &f);
+size_t fmtClock(char *out, size_t cap, uint8_t hour, uint8_t minute, uint8_t second);     // HH:MM:SS
+size_t fmtDate(char *out, size_t cap, uint8_t day, uint8_t month, uint16_t year);         // DD/MM/YYYY
+
+#endif // NUM_FORMAT_H
@@ -0,0 +1,113 @@
+// Per-stage loop profiler
+// Scoped timers read the Xtensa CCOUNT cycle counter around each stage of
+// the firmware tasks (app_tasks.h, each stage is timed by one task) and
+// feed a fixed-size log-linear histogram per stage, from which
+// min/avg/p99/max are derived. The same scopes emit begin/end trace events
+// (trace.h) and, in the heap debug build, tag allocations with the stage
+// (heap_tracker.h). With all three disabled the PROFILE_STAGE() macro expands
+// to nothing, so instrumented code costs nothing.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "trace.h"
+
+enum ProfileStage : uint8_t {
+  STAGE_WIFI,
+  STAGE_BUTTON,
+  STAGE_GPS,
+  STAGE_LED,
+  STAGE_DISPLAY,
+  STAGE_WEB,
+  STAGE_MQTT,
+  STAGE_LOOP, // Whole loop() (GPS task) iteration
+  STAGE_COUNT
+};
+
+static_assert(STAGE_COUNT <= TRACE_STAGE_IDS, "Profiler stages share the trace event ID space");
+static_assert(STAGE_COUNT <= 32, "One reset bit per stage");
+
+extern const char *const PROFILE_STAGE_NAMES[STAGE_COUNT];
+
+// 4 sub-buckets per power of two: values are known within 25%
+#define PROFILE_SUB_BUCKETS 4
+#define PROFILE_BUCKETS     (32 * PROFILE_SUB_BUCKETS)
+
+struct StageStats {
+  uint32_t count;
+  uint32_t minUs;
+  uint32_t avgUs;
+  uint32_t p99Us;
+  uint32_t maxUs;
+};
+
+class StageProfiler {
+public:
+  void record(ProfileStage stage, uint32_t cycles);
+  // Any task: each stage is cleared by its own task at its next record()
+  void reset();
+  StageStats stats(ProfileStage stage) const;
+
+private:
+  struct Stage {
+    uint32_t buckets[PROFILE_BUCKETS];
+    uint32_t count;
+    uint64_t sumCycles;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+  };
+
+  static uint8_t bucketIndex(uint32_t cycles);
+  static uint32_t bucketUpperBound(uint8_t index);
+
+  Stage _stages[STAGE_COUNT] = {};
+  std::atomic<uint32_t> _resetPending{0}; // One bit per stage
+};
+
+extern StageProfiler profiler;
+
+#if HEAP_TRACKING
+extern thread_local uint8_t heapTrackerStage; // heap_tracker.cpp, per task
+#endif
+
+class ScopedStageTimer {
+public:
+  explicit ScopedStageTimer(ProfileStage stage) : _stage(stage), _start(ESP.getCycleCount()) {
+#if HEAP_TRACKING
+    _prevHeapStage = heapTrackerStage;
+    heapTrackerStage = _stage;
+#endif
+#if TRACE_ENABLED
+    tracer.record(_stage, 'B');
+#endif
+  }
+  ~ScopedStageTimer() {
+#if PROFILER_ENABLED
+    profiler.record(_stage, ESP.getCycleCount() - _start);
+#endif
+#if TRACE_ENABLED
+    tracer.record(_stage, 'E');
+#endif
+#if HEAP_TRACKING
+    heapTrackerStage = _prevHeapStage;
+#endif
+  }
+
+private:
+  ProfileStage _stage;
+  uint32_t _start;
+#if HEAP_TRACKING
+  uint8_t _prevHeapStage;
+#endif
+};
+
+#if PROFILER_ENABLED || TRACE_ENABLED || HEAP_TRACKING
+  #define PROFILE_STAGE(stage) ScopedStageTimer SCOPE_CONCAT(_profileScope, __LINE__)(stage)
+#else
+  #define PROFILE_STAGE(stage)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,75 @@
+// Satellites in view
+// Fixed-size table filled from GSV (PRN, elevation, azimuth, SNR) and GSA
+// (used in the fix) sentences. A constellation's entries are replaced at the
+// end of each GSV cycle, so satellites that set drop out of the table. NMEA
+// 4.10 GSV for secondary signals (L2, L5, E5...) is ignored, SNR is L1.
+//
+// Parsing runs in loop(); consumers get a SkyView copy.
+
+#ifndef SAT_TABLE_H
+#define SAT_TABLE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum GnssSystem : uint8_t {
+  GNSS_GPS,
+  GNSS_GLONASS,
+  GNSS_GALILEO,
+  GNSS_BEIDOU,
+  GNSS_QZSS,
+  GNSS_SBAS,
+  GNSS_OTHER,
+  GNSS_COUNT
+};
+
+// RINEX letters: G R E C J S
+extern const char GNSS_LETTERS[GNSS_COUNT];
+
+#define SAT_ELEVATION_UNKNOWN -1
+
+struct SatInfo {
+  uint16_t prn;       // As reported in NMEA
+  GnssSystem system;
+  int8_t elevation;   // Degrees, SAT_ELEVATION_UNKNOWN if not reported
+  uint16_t azimuth;   // Degrees
+  uint8_t snr;        // dB-Hz, 0 = not tracked
+  bool used;          // In the last GSA solution
+};
+
+struct SkyView {
+  uint8_t count;
+  uint8_t used;
+  SatInfo sats[SAT_TABLE_SIZE];
+};
+
+class SatTable {
+public:
+  // Every checksum-valid sentence: GSV and GSA are parsed, the rest only
+  // closes a GSA batch
+  void onSentence(const char *sentence, size_t len);
+  void view(SkyView *out) const;
+  uint8_t count() const { return _count; }
+  uint32_t dropped() const { return _dropped; }
+
+private:
+  struct Entry {
+    SatInfo info;
+    GnssSystem talker; // Whose GSV cycle reported it
+    uint8_t cycle;
+  };
+
+  void parseGsv(GnssSystem talker, char **fields, uint8_t count);
+  void parseGsa(GnssSystem talker, char **fields, uint8_t count);
+  Entry *find(GnssSystem system, uint16_t prn);
+
+  Entry _entries[SAT_TABLE_SIZE];
+  uint8_t _count = 0;
+  uint8_t _cycle[GNSS_COUNT] = {};
+  bool _inGsaBatch = false;
+  uint32_t _dropped = 0; // Satellites that didn't fit
+};
+
+extern SatTable satTable;
+
+#endif // SAT_TABLE_H
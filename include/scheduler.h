@@ -0,0 +1,91 @@
+// Cooperative job scheduler
+// One per task. Jobs register once, either periodic (every()) or run only
+// when triggered (onTrigger()), and the owning task alternates runDue() and
+// waitNext(). waitNext() sleeps on the task notification until the earliest
+// deadline, so a task with nothing due uses no CPU, and that time is
+// counted as idle.
+//
+// Any task may trigger() a job: it becomes due now and the owner wakes up.
+// A periodic job that was triggered starts its next period from that run.
+//
+// Deadlines sit in a binary min-heap of job indices, so the next one is the
+// root and rescheduling is O(log n). A periodic job that falls a whole
+// period behind (started late, or ran longer than its period) skips the
+// missed runs and counts an overrun instead of running back to back.
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+typedef uint8_t JobId;
+typedef void (*JobFn)();
+
+static_assert(SCHEDULER_MAX_JOBS <= 32, "Triggers are one bit per job");
+
+// Read by /metrics from the AsyncTCP task, like LatencyHistogram
+struct JobStats {
+  const char *name;
+  uint32_t periodMs;     // 0: runs only when triggered
+  uint32_t runs;
+  uint32_t overruns;     // Periodic jobs that missed at least one period
+  uint64_t busyUs;
+  uint32_t maxRunUs;
+  uint32_t maxLateUs;    // Worst start after the deadline (periodic runs)
+};
+
+class Scheduler {
+public:
+  explicit Scheduler(const char *taskName) : _taskName(taskName) {}
+
+  // Before the owner task starts. The first run is one period from now.
+  JobId every(const char *name, uint32_t periodMs, JobFn fn);
+  JobId onTrigger(const char *name, JobFn fn);
+
+  // Any task: run the job as soon as the owner gets to it
+  void trigger(JobId job);
+
+  // Owner task only: runs every job that is due, in deadline order
+  void runDue();
+  // Owner task only: sleeps until the next deadline or a trigger
+  void waitNext();
+
+  const char *taskName() const { return _taskName; }
+  uint8_t jobCount() const { return _jobCount; }
+  const JobStats &stats(JobId job) const { return _jobs[job].stats; }
+  uint64_t idleUs() const { return _idleUs; }
+  uint32_t wakeups() const { return _wakeups; }
+
+private:
+  struct Job {
+    JobFn fn;
+    int64_t deadlineUs;
+    uint8_t heapPos;     // NOT_QUEUED while an event-only job waits for a trigger
+    JobStats stats;
+  };
+
+  static constexpr uint8_t NOT_QUEUED = 0xFF;
+
+  JobId add(const char *name, uint32_t periodMs, JobFn fn);
+  void schedule(JobId job, int64_t deadlineUs);
+  void siftUp(uint8_t pos);
+  void siftDown(uint8_t pos);
+  void swap(uint8_t a, uint8_t b);
+  void run(JobId job, int64_t nowUs);
+
+  const char *_taskName;
+  Job _jobs[SCHEDULER_MAX_JOBS];
+  uint8_t _jobCount = 0;
+  JobId _heap[SCHEDULER_MAX_JOBS];
+  uint8_t _heapSize = 0;
+
+  std::atomic<uint32_t> _triggered{0};
+  std::atomic<TaskHandle_t> _owner{nullptr}; // Known from the first runDue()
+
+  uint64_t _idleUs = 0;
+  uint32_t _wakeups = 0;
+};
+
+#endif // SCHEDULER_H
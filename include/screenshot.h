@@ -0,0 +1,28 @@
+// TFT screenshots over HTTP
+// /screenshot.bmp and /screenshot.png stream the last frame presented by the
+// framebuffer (frame_buffer.h) one row at a time through a chunked response:
+// about 1 KB of state per request instead of a 115 KB copy, and the display
+// task is never waited on.
+//
+// BMP is 16-bit RGB565 with bitfield masks, top-down, so rows go out as
+// stored. PNG is 8-bit RGB in stored (uncompressed) deflate blocks, one per
+// row, with the CRC-32 and Adler-32 computed while streaming.
+
+#ifndef SCREENSHOT_H
+#define SCREENSHOT_H
+
+#include <Arduino.h>
+#include "config.h"
+
+class AsyncWebServerRequest;
+
+enum ScreenshotFormat : uint8_t {
+  SCREENSHOT_BMP,
+  SCREENSHOT_PNG
+};
+
+// 503 when drawing goes straight to the TFT: the widgets only draw what
+// changed, so there is no frame to read back
+void sendScreenshotResponse(AsyncWebServerRequest *request, ScreenshotFormat format);
+
+#endif // SCREENSHOT_H
@@ -0,0 +1,66 @@
+// Status NeoPixel engine
+// Any task sets a pattern (solid, blink, breathe, two-color alternation);
+// a one-shot esp_timer works out the color, and re-arms itself for the
+// moment the color next changes. Setting the pattern that is already shown
+// costs a mutex and a compare, and a frame is only sent when the color
+// actually changes: twice a second while blinking, never while solid.
+//
+// Frames go out on the RMT peripheral without waiting for the transfer
+// (24 bits, 30 us), so neither the CPU nor interrupts are held up by the
+// WS2812 protocol.
+
+#ifndef STATUS_LED_H
+#define STATUS_LED_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <driver/rmt.h>
+#include <esp_timer.h>
+#include "config.h"
+
+enum LedPattern : uint8_t {
+  LED_OFF,
+  LED_SOLID,       // color
+  LED_BLINK,       // color / off, NEOPIXEL_BLINK_INTERVAL each
+  LED_BREATHE,     // color fading in and out over NEOPIXEL_BREATHE_PERIOD_MS
+  LED_ALTERNATE    // color / color2, NEOPIXEL_BLINK_INTERVAL each
+};
+
+class StatusLed {
+public:
+  void begin();
+
+  // Any task, never blocks on the LED. Colors are 0xRRGGBB.
+  void set(LedPattern pattern, uint32_t color, uint32_t color2 = NEOPIXEL_COLOR_OFF);
+
+  uint32_t writes() const { return _writes; }
+
+private:
+  struct Request {
+    LedPattern pattern;
+    uint32_t color;
+    uint32_t color2;
+  };
+
+  static void onTimer(void *arg);
+  void step();
+  void wake();
+  bool emit(uint32_t color);
+
+  SemaphoreHandle_t _lock = nullptr;
+  esp_timer_handle_t _timer = nullptr;
+  Request _request = {LED_OFF, 0, 0}; // Under _lock
+  bool _changed = false;               // Under _lock
+
+  // esp_timer task only
+  Request _shownRequest = {LED_OFF, 0, 0};
+  int64_t _startUs = 0;               // When _shownRequest was picked up
+  uint32_t _shown = UINT32_MAX;       // Last color sent, after brightness
+  rmt_item32_t _items[24 * NEOPIXEL_NUM_PIXELS];
+
+  std::atomic<uint32_t> _writes{0};
+};
+
+extern StatusLed statusLed;
+
+#endif // STATUS_LED_H
@@ -0,0 +1,20 @@
+// Bounded snprintf-style appending into fixed char buffers
+
+#ifndef STR_APPEND_H
+#define STR_APPEND_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stddef.h>
+
+// Appends at *len and never overruns cap (the result is truncated instead)
+inline void appendf(char *buf, size_t cap, size_t *len, const char *fmt, ...) {
+  if (*len >= cap) return;
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf + *len, cap - *len, fmt, args);
+  va_end(args);
+  if (n > 0) *len = (*len + n < cap) ? *len + n : cap - 1;
+}
+
+#endif // STR_APPEND_H
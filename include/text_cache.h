@@ -0,0 +1,76 @@
+// Pre-rasterized text cache
+// Strings that are drawn again and again (splash screen title and status
+// lines) are rasterized once into an RGB565 block in PSRAM and then blitted
+// with a single window write, instead of going through drawPixel()/fillRect()
+// for every set bit of every glyph on each redraw.
+//
+// Rasterization draws the string once at scale 1 into a 1-bit canvas, then
+// resamples it with 4x4 supersampling, so any scale works, not just the
+// integer sizes of setTextSize(), and edges come out anti-aliased against the
+// background colour. Entries are keyed on text, font, scale and colours and
+// evicted least recently used within TEXT_CACHE_BYTES.
+//
+// Only the display task draws text, so the cache has no locking.
+
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "config.h"
+
+class Adafruit_SPITFT;
+
+#define TEXT_CACHE_TEXT_MAX 32
+
+struct CachedText {
+  uint16_t *pixels; // w * h RGB565, row-major
+  int16_t w, h;
+  int16_t dx, dy;   // Top-left corner relative to the text cursor
+};
+
+class TextCache {
+public:
+  // tft is used for the window write when drawing straight to the panel
+  void begin(Adafruit_SPITFT *tft) { _tft = tft; }
+
+  // Rasterizes on a miss. nullptr font is the built-in 6x8 font; y is the
+  // cursor position as for print() (baseline for custom fonts, top otherwise).
+  // Returns nullptr if the text doesn't fit the cache.
+  const CachedText *get(const char *text, const GFXfont *font, float scale, uint16_t fg, uint16_t bg);
+
+  void draw(Adafruit_GFX &gfx, const CachedText &text, int16_t x, int16_t y);
+  // Horizontally centred on the screen. Falls back to plain print() at the
+  // nearest integer scale if the text can't be cached.
+  void drawCentered(Adafruit_GFX &gfx, const char *text, const GFXfont *font, float scale,
+                    uint16_t fg, uint16_t bg, int16_t y);
+
+  uint32_t hits() const { return _hits; }
+  uint32_t misses() const { return _misses; }
+  size_t bytes() const { return _bytes; }
+
+private:
+  struct Entry {
+    CachedText text;
+    uint32_t hash;      // 0 = free slot
+    const GFXfont *font;
+    uint16_t scale256;  // Scale in 1/256
+    uint16_t fg, bg;
+    uint32_t lastUse;
+    char str[TEXT_CACHE_TEXT_MAX];
+  };
+
+  bool rasterize(Entry &e, const char *text, const GFXfont *font, float scale, uint16_t fg, uint16_t bg);
+  void release(Entry &e);
+
+  Adafruit_SPITFT *_tft = nullptr;
+  Entry _entries[TEXT_CACHE_ENTRIES] = {};
+  size_t _bytes = 0;
+  uint32_t _useCounter = 0;
+  uint32_t _hits = 0;
+  uint32_t _misses = 0;
+};
+
+extern TextCache textCache;
+
+#endif // TEXT_CACHE_H
@@ -0,0 +1,145 @@
+// Retained-mode TFT widgets
+// Each widget remembers what it last put on screen (text, colour, bounds) and
+// only redraws when its value changes, and then only its own bounding box:
+// text is printed with an opaque background and only the part of the old
+// bounds the new text doesn't cover is cleared. Pages call set() every frame
+// and draw() on the widgets; nothing is pushed for unchanged values.
+//
+// Text uses the built-in 6x8 GFX font, so bounds are computed, not measured.
+
+#ifndef TFT_WIDGETS_H
+#define TFT_WIDGETS_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+#define WIDGET_TEXT_MAX 40
+
+enum WidgetAlign : uint8_t { ALIGN_LEFT, ALIGN_CENTER, ALIGN_RIGHT };
+
+struct WidgetStats {
+  uint32_t pixels;  // Pixels written to the display (text cells + fills)
+  uint32_t redraws; // Widget draws that actually touched the display
+};
+
+extern WidgetStats widgetStats;
+
+// Marks every widget as not drawn. Call after clearing the area they live in
+// (page switch, splash screen).
+void invalidateWidgets();
+// For widgets outside this file: drawn in an older generation = not on screen
+uint32_t currentWidgetGeneration();
+
+class TextWidget {
+public:
+  // x is the left edge, the centre or the right edge depending on align
+  TextWidget(int16_t x, int16_t y, uint8_t size, uint16_t bg, WidgetAlign align = ALIGN_LEFT)
+    : _x(x), _y(y), _size(size), _align(align), _bg(bg) {}
+  // For widget arrays: construct, then place() before the first draw
+  TextWidget() : TextWidget(0, 0, 1, 0) {}
+  void place(int16_t x, int16_t y, uint8_t size, uint16_t bg, WidgetAlign align = ALIGN_LEFT) {
+    _x = x; _y = y; _size = size; _bg = bg; _align = align;
+  }
+
+  void set(const char *text, uint16_t color);
+  void set(const String &text, uint16_t color) { set(text.c_str(), color); }
+  // Returns true if anything was drawn
+  bool draw(Adafruit_GFX &gfx);
+
+private:
+  int16_t _x, _y;
+  uint8_t _size;
+  WidgetAlign _align;
+  uint16_t _bg;
+
+  char _text[WIDGET_TEXT_MAX] = "";
+  uint16_t _color = 0;
+  bool _dirty = true;
+
+  // What is on screen
+  uint32_t _generation = 0;
+  int16_t _drawnX = 0;
+  uint16_t _drawnW = 0;
+};
+
+// Horizontal bar inside a 1 px frame. A value change only fills the strip
+// between the old and the new end of the bar.
+class BarWidget {
+public:
+  BarWidget(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t frameColor, uint16_t bg)
+    : _x(x), _y(y), _w(w), _h(h), _frameColor(frameColor), _bg(bg) {}
+  // For widget arrays: construct, then place() before the first draw
+  BarWidget() : BarWidget(0, 0, 2, 2, 0, 0) {}
+  void place(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t frameColor, uint16_t bg) {
+    _x = x; _y = y; _w = w; _h = h; _frameColor = frameColor; _bg = bg;
+  }
+
+  void set(uint32_t value, uint32_t max, uint16_t color);
+  bool draw(Adafruit_GFX &gfx);
+
+private:
+  int16_t _x, _y;
+  uint16_t _w, _h;
+  uint16_t _frameColor, _bg;
+
+  uint16_t _fill = 0; // Inner width to fill
+  uint16_t _color = 0;
+
+  uint32_t _generation = 0;
+  uint16_t _drawnFill = 0;
+  uint16_t _drawnColor = 0;
+};
+
+// Polar sky plot: centre is the zenith, the outer ring the horizon, north up.
+// Rings at 0, 30 and 60 degrees of elevation. Only points that moved,
+// appeared, disappeared or changed colour are erased and redrawn; the grid is
+// repaired under erased points and neighbours they overlapped are redrawn.
+#define SKY_PLOT_MAX_POINTS 32
+#define SKY_DOT_RADIUS      3
+
+struct SkyPlotPoint {
+  uint16_t id;        // Stable per satellite
+  int8_t elevation;   // Degrees
+  uint16_t azimuth;   // Degrees, clockwise from north
+  uint16_t color;
+  bool filled;        // Filled dot, otherwise a ring
+};
+
+class SkyPlotWidget {
+public:
+  SkyPlotWidget(int16_t cx, int16_t cy, int16_t radius, uint16_t gridColor, uint16_t bg)
+    : _cx(cx), _cy(cy), _r(radius), _gridColor(gridColor), _bg(bg) {}
+
+  void set(const SkyPlotPoint *points, uint8_t count);
+  bool draw(Adafruit_GFX &gfx);
+
+private:
+  struct Dot {
+    uint16_t id;
+    int16_t x, y;
+    uint16_t color;
+    bool filled;
+    bool operator==(const Dot &o) const {
+      return id == o.id && x == o.x && y == o.y && color == o.color && filled == o.filled;
+    }
+  };
+
+  bool onGrid(int16_t x, int16_t y) const;
+  void drawGrid(Adafruit_GFX &gfx, int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+  void drawDot(Adafruit_GFX &gfx, const Dot &dot);
+  void eraseDot(Adafruit_GFX &gfx, const Dot &dot);
+
+  int16_t _cx, _cy, _r;
+  uint16_t _gridColor, _bg;
+
+  Dot _want[SKY_PLOT_MAX_POINTS];
+  uint8_t _wantCount = 0;
+  bool _dirty = true;
+
+  // What is on screen
+  uint32_t _generation = 0;
+  Dot _drawn[SKY_PLOT_MAX_POINTS];
+  uint8_t _drawnCount = 0;
+};
+
+#endif // TFT_WIDGETS_H
@@ -0,0 +1,104 @@
+// Chrome-trace event recorder
+// Flight recorder for firmware timing analysis: begin/end/instant events with
+// a microsecond timestamp, the recording task and its core go into a
+// fixed-size ring in PSRAM. /trace.json streams the ring in Chrome Trace Event
+// format, loadable in chrome://tracing or ui.perfetto.dev, with one track per
+// task (several tasks share each core, so per-core tracks would break the
+// begin/end nesting) and the core as an event argument.
+//
+// Recording is a relaxed atomic slot reservation plus an 8-byte store, so it
+// is safe from both cores and never blocks. The ring keeps the latest
+// TRACE_BUFFER_EVENTS events (6.5 s of history at 10 kHz). Not for ISRs.
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+class AsyncWebServerRequest;
+
+#define SCOPE_CONCAT_(a, b) a##b
+#define SCOPE_CONCAT(a, b) SCOPE_CONCAT_(a, b)
+
+// IDs below TRACE_STAGE_IDS are the profiler stages (ProfileStage)
+#define TRACE_STAGE_IDS 16
+
+// Tasks numbered on their first event; later ones share track 0
+#define TRACE_MAX_TASKS    16
+#define TRACE_TASK_UNKNOWN 0xFF
+
+enum TraceEventId : uint8_t {
+  TRACE_EPOCH = TRACE_STAGE_IDS, // Snapshot publication and its outputs
+  TRACE_WS_BROADCAST,            // ws.textAll() of the periodic update
+  TRACE_WS_EVENT,                // WebSocket connect/disconnect (AsyncTCP task)
+  TRACE_FIX_CHANGE,              // Instant: fix acquired or lost
+  TRACE_WIFI_EVENT,              // Instant: WiFi connected or timed out
+  TRACE_ID_END
+};
+
+struct TraceEvent {
+  uint32_t tsUs;  // Low 32 bits of esp_timer_get_time()
+  uint8_t id;
+  char phase;     // 'B', 'E' or 'i'
+  uint8_t core;
+  uint8_t task;   // Track number (TraceRecorder::taskName())
+};
+
+extern thread_local uint8_t traceTaskId; // trace.cpp, TRACE_TASK_UNKNOWN until the task's first event
+
+class TraceRecorder {
+public:
+  bool begin();
+
+  void setEnabled(bool enabled) { _enabled = enabled && _events != nullptr; }
+  bool enabled() const { return _enabled; }
+  uint32_t recorded() const { return _head.load(std::memory_order_relaxed); }
+
+  inline void record(uint8_t id, char phase) {
+    if (!_enabled || _exports.load(std::memory_order_relaxed) != 0) return;
+    uint32_t slot = _head.fetch_add(1, std::memory_order_relaxed) & (TRACE_BUFFER_EVENTS - 1);
+    TraceEvent &e = _events[slot];
+    e.tsUs = (uint32_t)esp_timer_get_time();
+    e.id = id;
+    e.phase = phase;
+    e.core = xPortGetCoreID();
+    e.task = traceTaskId != TRACE_TASK_UNKNOWN ? traceTaskId : registerTask();
+  }
+
+  // Streams the ring as chunked JSON. Recording is paused while any export
+  // runs; enabled() and setEnabled() are unaffected.
+  void sendJson(AsyncWebServerRequest *request);
+
+private:
+  uint8_t registerTask();
+
+  TraceEvent *_events = nullptr;
+  char _taskNames[TRACE_MAX_TASKS][configMAX_TASK_NAME_LEN] = {};
+  std::atomic<uint8_t> _taskCount{1}; // Track 0: tasks past TRACE_MAX_TASKS
+  std::atomic<uint32_t> _head{0};
+  volatile bool _enabled = false;
+  std::atomic<uint8_t> _exports{0}; // /trace.json responses in progress
+};
+
+extern TraceRecorder tracer;
+
+class ScopedTrace {
+public:
+  explicit ScopedTrace(uint8_t id) : _id(id) { tracer.record(_id, 'B'); }
+  ~ScopedTrace() { tracer.record(_id, 'E'); }
+
+private:
+  uint8_t _id;
+};
+
+#if TRACE_ENABLED
+  #define TRACE_SCOPE(id)   ScopedTrace SCOPE_CONCAT(_traceScope, __LINE__)(id)
+  #define TRACE_INSTANT(id) tracer.record(id, 'i')
+#else
+  #define TRACE_SCOPE(id)
+  #define TRACE_INSTANT(id)
+#endif
+
+#endif // TRACE_H
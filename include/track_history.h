@@ -0,0 +1,40 @@
+// In-memory breadcrumb track
+// Ring of the last TRACK_HISTORY_SIZE fixed-point positions, appended by
+// loop() on each epoch with a fix once the receiver has moved at least
+// TRACK_MIN_SPACING_CM. Every point gets a sequence number so readers (the
+// map page on the display task) can fetch only what they haven't seen.
+
+#ifndef TRACK_HISTORY_H
+#define TRACK_HISTORY_H
+
+#include <Arduino.h>
+#include "config.h"
+
+struct TrackPoint {
+  int32_t latE7;
+  int32_t lngE7;
+};
+
+class TrackHistory {
+public:
+  void begin();
+  // Returns true if the point was kept
+  bool add(int32_t latE7, int32_t lngE7);
+  void clear();
+
+  // Sequence number of the next point to be added; the ring holds
+  // [max(0, next - TRACK_HISTORY_SIZE), next)
+  uint32_t next() const { return _next; }
+  // Copies up to max points starting at *from (moved up to the oldest one
+  // still held). Advances *from past the copied points.
+  size_t read(uint32_t *from, TrackPoint *out, size_t max);
+
+private:
+  SemaphoreHandle_t _lock = nullptr;
+  TrackPoint _points[TRACK_HISTORY_SIZE];
+  volatile uint32_t _next = 0;
+};
+
+extern TrackHistory trackHistory;
+
+#endif // TRACK_HISTORY_H
@@ -0,0 +1,58 @@
+// Breadcrumb track map
+// Projects the track history (track_history.h) into a screen rectangle,
+// equirectangular around a reference point, at a 1-2-5 scale in cm per pixel
+// chosen to fit the whole track. While the scale holds, each frame only reads
+// the points added since the last one and draws their segments. A point
+// leaving the view triggers a rescale: new reference and scale, full redraw.
+//
+// A scale bar with its distance label sits in a strip below the map.
+
+#ifndef TRACK_MAP_H
+#define TRACK_MAP_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "tft_widgets.h"
+#include "track_history.h"
+
+#define TRACK_MAP_MIN_CM_PER_PX 10  // Closest zoom: 24 m across the screen
+#define TRACK_MAP_MARGIN        4   // Pixels kept free around the track
+#define TRACK_MAP_SCALE_BAR_H   14  // Strip under the map
+
+class TrackMapWidget {
+public:
+  // h includes the scale bar strip
+  TrackMapWidget(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t trailColor, uint16_t headColor,
+                 uint16_t textColor, uint16_t bg);
+
+  // Returns true if anything was drawn
+  bool draw(Adafruit_GFX &gfx, TrackHistory &history);
+
+  uint32_t cmPerPixel() const { return _cmPerPx; }
+  uint32_t rescales() const { return _rescales; }
+
+private:
+  bool project(const TrackPoint &p, int16_t *sx, int16_t *sy) const;
+  void fit(TrackHistory &history);
+  void redrawAll(Adafruit_GFX &gfx, TrackHistory &history);
+  void drawScaleBar(Adafruit_GFX &gfx);
+  void appendPoint(Adafruit_GFX &gfx, int16_t sx, int16_t sy);
+
+  int16_t _x, _y, _w, _mapH;
+  uint16_t _trailColor, _headColor, _textColor, _bg;
+  TextWidget _scaleLabel;
+
+  // Projection
+  int32_t _refLat = 0, _refLng = 0;
+  int32_t _lngScaleQ16 = 65536;
+  uint32_t _cmPerPx = TRACK_MAP_MIN_CM_PER_PX;
+
+  // What is on screen
+  uint32_t _generation = 0;
+  uint32_t _nextPoint = 0; // History sequence number of the next point to draw
+  bool _hasHead = false;
+  int16_t _headX = 0, _headY = 0;
+  uint32_t _rescales = 0;
+};
+
+#endif // TRACK_MAP_H
@@ -0,0 +1,93 @@
+// UDP multicast/broadcast fix stream
+// Sends one compact binary datagram per epoch. A single send serves every
+// receiver on the LAN, so there is no per-receiver state or cost on the ESP32.
+//
+// Packet format (version 1, little-endian, 60 bytes, no padding):
+//
+//   off  size  field        description
+//   0    4     magic        UDP_FIX_MAGIC ("GPSF")
+//   4    1     version      UDP_FIX_VERSION
+//   5    1     flags        UDP_FIX_FLAG_* bits below
+//   6    2     length       Total packet length in bytes
+//   8    4     sequence     +1 per datagram; a gap means lost datagrams
+//   12   4     epoch        GpsSnapshot epoch counter
+//   16   8     epochUs      Device time (us since boot) when the epoch was published
+//   24   8     ppsUs        Device time of the last PPS rising edge (0 = no PPS)
+//   32   4     utcDate      YYYYMMDD (0 = invalid)
+//   36   4     utcTimeMs    Milliseconds since UTC midnight
+//   40   4     latE7        Latitude, 1e-7 degrees
+//   44   4     lonE7        Longitude, 1e-7 degrees
+//   48   4     altitudeCm   Altitude MSL, centimeters
+//   52   2     speedCms     Ground speed, cm/s
+//   54   2     courseCdeg   Course over ground, 1/100 degree
+//   56   2     hdopX100     HDOP x 100
+//   58   1     satellites   Satellites used in fix
+//   59   1     reserved
+//
+// epochUs - ppsUs is the publication delay after the PPS edge that marks the
+// start of the UTC second, which lets receivers align datagrams from several
+// testers. See tools/udp_fix_receiver.py for a reference receiver.
+
+#ifndef UDP_FIX_H
+#define UDP_FIX_H
+
+#include <Arduino.h>
+#include <AsyncUDP.h>
+#include "config.h"
+#include "gps_snapshot.h"
+
+#define UDP_FIX_MAGIC   0x46535047UL // "GPSF" in little-endian byte order
+#define UDP_FIX_VERSION 1
+
+#define UDP_FIX_FLAG_FIX      0x01
+#define UDP_FIX_FLAG_ALTITUDE 0x02
+#define UDP_FIX_FLAG_SPEED    0x04
+#define UDP_FIX_FLAG_COURSE   0x08
+#define UDP_FIX_FLAG_HDOP     0x10
+#define UDP_FIX_FLAG_TIME     0x20
+#define UDP_FIX_FLAG_PPS      0x40
+
+struct __attribute__((packed)) UdpFixPacket {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t flags;
+  uint16_t length;
+  uint32_t sequence;
+  uint32_t epoch;
+  int64_t epochUs;
+  int64_t ppsUs;
+  uint32_t utcDate;
+  uint32_t utcTimeMs;
+  int32_t latE7;
+  int32_t lonE7;
+  int32_t altitudeCm;
+  uint16_t speedCms;
+  uint16_t courseCdeg;
+  uint16_t hdopX100;
+  uint8_t satellites;
+  uint8_t reserved;
+};
+
+static_assert(sizeof(UdpFixPacket) == 60, "UdpFixPacket layout is part of the wire format");
+
+class UdpFixSender {
+public:
+  void begin();
+  void end() { _running = false; }
+
+  // ppsUs: device time of the last PPS edge, 0 if PPS is not wired
+  void send(const GpsSnapshot &snapshot, int64_t epochUs, int64_t ppsUs);
+
+  uint32_t sent() const { return _sent; }
+  uint32_t errors() const { return _errors; }
+
+private:
+  AsyncUDP _udp;
+  IPAddress _group;
+  uint32_t _sequence = 0;
+  uint32_t _sent = 0;
+  uint32_t _errors = 0;
+  bool _running = false;
+};
+
+#endif // UDP_FIX_H
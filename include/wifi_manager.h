@@ -0,0 +1,119 @@
+// WiFi connection manager
+// Event-driven station state machine, run by the network task:
+//
+//   SCANNING    asynchronous scan, the strongest configured SSID wins
+//   CONNECTING  WiFi.begin() on that access point (BSSID and channel pinned),
+//               until GOT_IP, a disconnect event or WIFI_CONNECT_TIMEOUT
+//   CONNECTED   until a disconnect event. While the RSSI is below
+//               WIFI_ROAM_RSSI, a background scan every
+//               WIFI_ROAM_CHECK_INTERVAL looks for a configured access point
+//               at least WIFI_ROAM_MARGIN_DB stronger and moves to it.
+//   BACKOFF     after a failure: WIFI_RETRY_DELAY, doubled per failure up to
+//               WIFI_RETRY_MAX_DELAY, then back to SCANNING
+//
+// WiFi.onEvent() callbacks only queue the event id; update() never waits,
+// so nothing here stalls the network task (and the GPS task never sees WiFi
+// at all). update() reports link changes so the caller can start and stop
+// its servers.
+
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "config.h"
+
+enum WifiState : uint8_t {
+  WIFI_STATE_SCANNING,
+  WIFI_STATE_CONNECTING,
+  WIFI_STATE_CONNECTED,
+  WIFI_STATE_BACKOFF
+};
+
+enum WifiLinkChange : uint8_t {
+  WIFI_LINK_UNCHANGED,
+  WIFI_LINK_UP,          // Got an IP address
+  WIFI_LINK_DOWN,        // Lost the link (including to roam)
+  WIFI_LINK_FAILED       // First failed attempt since boot or since the link went down
+};
+
+class WifiManager {
+public:
+  // Before begin()
+  void addNetwork(const char *ssid, const char *password);
+  // Called from the Arduino event task after each queued event, to wake the
+  // task that runs update()
+  void onEvent(void (*callback)()) { _onEvent = callback; }
+  void begin();
+
+  // Network task only
+  WifiLinkChange update();
+
+  // Counters below are read by /metrics from the AsyncTCP task: 32-bit, so
+  // a read is never torn
+
+  WifiState state() const { return _state; }
+  bool connected() const { return _state == WIFI_STATE_CONNECTED; }
+
+  uint32_t connects() const { return _connects; }
+  uint32_t failedAttempts() const { return _failedAttempts; }
+  uint32_t roams() const { return _roams; }
+  uint32_t lastConnectMs() const { return _lastConnectMs; }   // Scan start to IP
+  uint32_t connectMsSum() const { return _connectMsSum; }
+  uint32_t outages() const { return _outages; }
+  uint32_t lastOutageMs() const { return _lastOutageMs; }     // Link down to IP again
+  uint32_t maxOutageMs() const { return _maxOutageMs; }
+  uint32_t outageMsSum() const { return _outageMsSum; }
+
+private:
+  struct Network {
+    const char *ssid;
+    const char *password;
+  };
+
+  struct Event {
+    arduino_event_id_t id;
+    uint8_t reason;      // STA_DISCONNECTED only
+  };
+
+  void handleEvent(const Event &event, WifiLinkChange *change);
+  void onScanDone(WifiLinkChange *change);
+  void startScan();
+  bool pickBest(int16_t count, int32_t *bestRssi);
+  void connectBest();
+  void fail(WifiLinkChange *change);
+  void linkDown(WifiLinkChange *change);
+
+  Network _networks[WIFI_MAX_NETWORKS];
+  uint8_t _networkCount = 0;
+  QueueHandle_t _events = nullptr;
+  void (*_onEvent)() = nullptr;
+
+  WifiState _state = WIFI_STATE_SCANNING;
+  unsigned long _stateMs = 0;       // When _state was entered
+  unsigned long _attemptStartMs = 0; // Scan that led to the current attempt
+  unsigned long _linkDownMs = 0;     // 0 = link was never up, or is up
+  unsigned long _lastRoamCheckMs = 0;
+  uint32_t _backoffMs = 0;
+  uint8_t _failStreak = 0;
+  bool _roamScan = false;            // Scan started while connected
+
+  // Chosen by the last scan
+  uint8_t _bestNetwork = 0;
+  uint8_t _bestBssid[6] = {};
+  int32_t _bestChannel = 0;
+
+  uint32_t _connects = 0;
+  uint32_t _failedAttempts = 0;
+  uint32_t _roams = 0;
+  uint32_t _lastConnectMs = 0;
+  uint32_t _connectMsSum = 0;
+  uint32_t _outages = 0;
+  uint32_t _lastOutageMs = 0;
+  uint32_t _maxOutageMs = 0;
+  uint32_t _outageMsSum = 0;
+};
+
+extern WifiManager wifiManager;
+
+#endif // WIFI_MANAGER_H
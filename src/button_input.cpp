@@ -0,0 +1,158 @@
+// Interrupt-driven buttons with gestures
+
+#include "button_input.h"
+#include <soc/gpio_reg.h>
+
+static_assert(PIN_BUTTON_1 < 32 && PIN_BUTTON_2 < 32, "The ISR reads the buttons from GPIO_IN_REG");
+
+#define US_PER_MS ((int64_t)1000)
+#define MAX_SLEEP_MS ((int64_t)60000)
+
+ButtonInput buttonInput;
+
+void ButtonInput::begin() {
+  _edges = xQueueCreate(BUTTON_EDGE_QUEUE_LEN, sizeof(Edge));
+  const uint8_t pins[BUTTON_COUNT] = {PIN_BUTTON_1, PIN_BUTTON_2};
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    Button &b = _buttons[i];
+    b.owner = this;
+    b.id = i;
+    b.pin = pins[i];
+    pinMode(b.pin, INPUT_PULLUP);
+    b.pressed = digitalRead(b.pin) == LOW; // Held at boot: no gesture until released
+    b.consumed = b.pressed;
+    attachInterruptArg(digitalPinToInterrupt(b.pin), onInterrupt, &b, CHANGE);
+  }
+}
+
+// Buttons are active low
+void IRAM_ATTR ButtonInput::onInterrupt(void *arg) {
+  Button *b = static_cast<Button *>(arg);
+  Edge edge = {b->id, ((REG_READ(GPIO_IN_REG) >> b->pin) & 1) == 0, esp_timer_get_time()};
+  BaseType_t woken = pdFALSE;
+  if (xQueueSendFromISR(b->owner->_edges, &edge, &woken) != pdTRUE) {
+    b->owner->_droppedEdges++; // The debounce re-read still catches the final level
+  }
+  if (woken) portYIELD_FROM_ISR();
+}
+
+bool ButtonInput::wait(ButtonEvent *out, uint32_t maxWaitMs) {
+  int64_t limitUs = esp_timer_get_time() + maxWaitMs * US_PER_MS;
+  for (;;) {
+    int64_t now = esp_timer_get_time();
+    poll(now);
+    if (_pendingCount > 0) {
+      *out = _pending[_pendingHead];
+      _pendingHead = (_pendingHead + 1) % PENDING_MAX;
+      _pendingCount--;
+      return true;
+    }
+    if (now >= limitUs) return false;
+
+    int64_t untilUs = min(limitUs, nextDeadlineUs());
+    // Capped so pdMS_TO_TICKS cannot overflow: the loop just waits again
+    int64_t waitMs = untilUs > now ? min((untilUs - now + US_PER_MS - 1) / US_PER_MS, MAX_SLEEP_MS) : 0;
+    TickType_t ticks = pdMS_TO_TICKS(waitMs);
+    Edge edge;
+    if (xQueueReceive(_edges, &edge, ticks) == pdTRUE) {
+      _edgeLatency.record(esp_timer_get_time() - edge.us);
+      onEdge(edge);
+    }
+  }
+}
+
+// ============================================================================
+// DEBOUNCE
+// ============================================================================
+void ButtonInput::onEdge(const Edge &edge) {
+  Button &b = _buttons[edge.button];
+  if (edge.us - b.acceptedUs < BUTTON_DEBOUNCE_MS * US_PER_MS) {
+    b.recheck = true; // Bouncing: read the settled level when the window ends
+  } else if (edge.pressed != b.pressed) {
+    accept(b, edge.pressed, edge.us);
+  }
+}
+
+void ButtonInput::accept(Button &b, bool pressed, int64_t us) {
+  b.pressed = pressed;
+  b.acceptedUs = us;
+  if (pressed) {
+    onPress(b, us);
+  } else {
+    onRelease(b, us);
+  }
+}
+
+// ============================================================================
+// GESTURES
+// ============================================================================
+void ButtonInput::onPress(Button &b, int64_t us) {
+  b.pressUs = us;
+  b.consumed = false;
+  if (b.clickPending) {
+    b.clickPending = false;
+    b.secondPress = true;
+  }
+
+  Button &other = _buttons[b.id == BUTTON_1 ? BUTTON_2 : BUTTON_1];
+  if (other.pressed && !other.consumed) {
+    emit(GESTURE_CHORD, BUTTON_1, min(other.pressUs, us));
+    for (Button &x : _buttons) {
+      x.consumed = true;
+      x.clickPending = false;
+      x.secondPress = false;
+    }
+  }
+}
+
+void ButtonInput::onRelease(Button &b, int64_t us) {
+  if (b.consumed) return;
+  if (b.secondPress) {
+    b.secondPress = false;
+    emit(GESTURE_DOUBLE, (ButtonId)b.id, b.clickPressUs);
+    return;
+  }
+  b.clickPending = true;
+  b.clickPressUs = b.pressUs;
+  b.releaseUs = us;
+}
+
+// Timed transitions: settled level after a bounce, end of the double press
+// window, long press
+void ButtonInput::poll(int64_t nowUs) {
+  for (Button &b : _buttons) {
+    if (b.recheck && nowUs - b.acceptedUs >= BUTTON_DEBOUNCE_MS * US_PER_MS) {
+      b.recheck = false;
+      bool pressed = digitalRead(b.pin) == LOW;
+      if (pressed != b.pressed) accept(b, pressed, nowUs);
+    }
+    if (b.clickPending && nowUs - b.releaseUs >= BUTTON_DOUBLE_PRESS_MS * US_PER_MS) {
+      b.clickPending = false;
+      emit(GESTURE_SHORT, (ButtonId)b.id, b.clickPressUs);
+    }
+    if (b.pressed && !b.consumed && nowUs - b.pressUs >= BUTTON_LONG_PRESS_MS * US_PER_MS) {
+      if (b.secondPress) {
+        emit(GESTURE_SHORT, (ButtonId)b.id, b.clickPressUs); // Click, then hold
+        b.secondPress = false;
+      }
+      emit(GESTURE_LONG, (ButtonId)b.id, b.pressUs);
+      b.consumed = true;
+    }
+  }
+}
+
+int64_t ButtonInput::nextDeadlineUs() const {
+  int64_t next = INT64_MAX;
+  for (const Button &b : _buttons) {
+    if (b.recheck) next = min(next, b.acceptedUs + BUTTON_DEBOUNCE_MS * US_PER_MS);
+    if (b.clickPending) next = min(next, b.releaseUs + BUTTON_DOUBLE_PRESS_MS * US_PER_MS);
+    if (b.pressed && !b.consumed) next = min(next, b.pressUs + BUTTON_LONG_PRESS_MS * US_PER_MS);
+  }
+  return next;
+}
+
+void ButtonInput::emit(ButtonGesture gesture, ButtonId button, int64_t pressUs) {
+  if (_pendingCount == PENDING_MAX) return; // The UI task is far behind: drop
+  _pending[(_pendingHead + _pendingCount) % PENDING_MAX] = {gesture, button, pressUs};
+  _pendingCount++;
+}
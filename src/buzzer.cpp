@@ -0,0 +1,113 @@
+// Buzzer melody sequencer
+
+#include "buzzer.h"
+
+Buzzer buzzer;
+
+namespace {
+struct Melody {
+  const BuzzerNote *notes;
+  uint8_t count;
+  uint8_t priority;   // Higher preempts lower
+};
+
+const BuzzerNote PAGE_CHANGE[] = {{BUZZER_FREQ_FIX, 30}};
+const BuzzerNote TOGGLE_ON[] = {{BUZZER_FREQ_LOST, 50}, {BUZZER_FREQ_FIX, 80}};
+const BuzzerNote TOGGLE_OFF[] = {{BUZZER_FREQ_FIX, 50}, {BUZZER_FREQ_LOST, 80}};
+const BuzzerNote WIFI_UP[] = {{BUZZER_FREQ_FIX, 60}, {0, 40}, {BUZZER_FREQ_FIX, 60}};
+const BuzzerNote WIFI_FAILED[] = {{BUZZER_FREQ_LOST, BUZZER_DURATION * 2}};
+// Rising for acquired, falling for lost, so they can be told apart by ear
+const BuzzerNote FIX_ACQUIRED[] = {{BUZZER_FREQ_FIX, BUZZER_DURATION / 2}, {0, 40},
+                                   {BUZZER_FREQ_FIX * 5 / 4, BUZZER_DURATION}};
+const BuzzerNote FIX_LOST[] = {{BUZZER_FREQ_LOST * 5 / 4, BUZZER_DURATION}, {0, 40},
+                               {BUZZER_FREQ_LOST, BUZZER_DURATION * 2}};
+
+#define MELODY(notes, priority) {notes, sizeof(notes) / sizeof(notes[0]), priority}
+
+const Melody MELODIES[MELODY_COUNT] = {
+  MELODY(PAGE_CHANGE, 0),
+  MELODY(TOGGLE_ON, 1),
+  MELODY(TOGGLE_OFF, 1),
+  MELODY(WIFI_UP, 1),
+  MELODY(WIFI_FAILED, 2),
+  MELODY(FIX_ACQUIRED, 2),
+  MELODY(FIX_LOST, 3),
+};
+} // namespace
+
+void Buzzer::begin() {
+  if (!BUZZER_ENABLED) return;
+  _queue = xQueueCreate(BUZZER_QUEUE_LEN, sizeof(BuzzerMelody));
+
+  esp_timer_create_args_t args = {};
+  args.callback = onTimer;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "buzzer";
+  if (esp_timer_create(&args, &_timer) != ESP_OK) {
+    DEBUG_PRINTLN("  - Buzzer timer FAILED");
+    _timer = nullptr;
+  }
+}
+
+void Buzzer::play(BuzzerMelody melody) {
+  if (!BUZZER_ENABLED || _muted || _queue == nullptr || _timer == nullptr) return;
+  if (xQueueSend(_queue, &melody, 0) != pdTRUE) {
+    _dropped++;
+    return;
+  }
+  // Wake the sequencer now. If its callback re-armed the timer between the
+  // stop and the start, the second round cancels that.
+  for (uint8_t i = 0; i < 2; i++) {
+    esp_timer_stop(_timer);
+    if (esp_timer_start_once(_timer, 0) == ESP_OK) break;
+  }
+}
+
+void Buzzer::onTimer(void *arg) {
+  static_cast<Buzzer *>(arg)->step();
+}
+
+void Buzzer::arm(uint64_t delayUs) {
+  esp_timer_stop(_timer);
+  esp_timer_start_once(_timer, delayUs);
+}
+
+// Runs when a note ends and whenever play() queued a melody
+void Buzzer::step() {
+  bool started = false;
+  BuzzerMelody request;
+  while (xQueueReceive(_queue, &request, 0) == pdTRUE) {
+    if (request >= MELODY_COUNT) continue;
+    if (_melody >= 0) {
+      if (MELODIES[request].priority < MELODIES[_melody].priority) {
+        _dropped++;
+        continue;
+      }
+      _preempted++;
+    }
+    _melody = request;
+    _next = 0;
+    _played++;
+    started = true;
+  }
+  if (_melody < 0) return;
+
+  int64_t now = esp_timer_get_time();
+  if (!started && now < _noteEndUs) {
+    // Woken for a melody that lost to this one: finish the note
+    arm(_noteEndUs - now);
+    return;
+  }
+
+  const Melody &m = MELODIES[_melody];
+  if (_next >= m.count) {
+    ledcWriteTone(BUZZER_LEDC_CHANNEL, 0);
+    _melody = -1;
+    return;
+  }
+  const BuzzerNote &note = m.notes[_next++];
+  ledcWriteTone(BUZZER_LEDC_CHANNEL, note.frequency); // 0 silences the channel
+  _noteEndUs = now + note.durationMs * 1000LL;
+  arm(note.durationMs * 1000ULL);
+}
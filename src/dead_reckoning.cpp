@@ -0,0 +1,59 @@
+// Dead reckoning between fixes
+
+#include "dead_reckoning.h"
+#include "coord_e7.h"
+
+DrErrorTracker drErrors;
+
+bool drPredict(const GpsSnapshot &fix, uint32_t horizonMs, DrPrediction *out) {
+  out->latE7 = fix.latE7;
+  out->lngE7 = fix.lngE7;
+  out->horizonMs = 0;
+  out->predicted = false;
+  if (!DR_ENABLED || !fix.locationValid || !fix.speedValid || !fix.courseValid) return false;
+  if (fix.locationAgeMs == ULONG_MAX || fix.locationAgeMs > DR_MAX_HORIZON_MS) return false;
+  if (fix.speedKmph < DR_MIN_SPEED_KMPH || horizonMs == 0) return false;
+
+  horizonMs = min(horizonMs, (uint32_t)DR_MAX_HORIZON_MS);
+  float distCm = (float)fix.speedKmph * horizonMs / 36.0f; // km/h = 1/36 cm/ms
+  float courseRad = (float)fix.courseDeg * (float)(M_PI / 180.0);
+  int32_t east = (int32_t)lroundf(distCm * sinf(courseRad));
+  int32_t north = (int32_t)lroundf(distCm * cosf(courseRad));
+  coordE7Move(fix.latE7, fix.lngE7, east, north, &out->latE7, &out->lngE7);
+  out->horizonMs = horizonMs;
+  out->predicted = true;
+  return true;
+}
+
+// ============================================================================
+// ERROR TRACKING
+// ============================================================================
+void DrErrorTracker::onSnapshot(const GpsSnapshot &s) {
+  if (!snapshotHasFix(s)) {
+    _hasPrev = false;
+    return;
+  }
+  if (_hasPrev) {
+    // Fix arrival times, so both sides carry the same serial delay
+    unsigned long prevAt = _prev.publishedMs - _prev.locationAgeMs;
+    unsigned long at = s.publishedMs - s.locationAgeMs;
+    DrPrediction p;
+    if (drPredict(_prev, at - prevAt, &p)) {
+      uint32_t err = coordE7DistanceCm(p.latE7, p.lngE7, s.latE7, s.lngE7);
+      _sumErrorCm += err;
+      _sumHoldCm += coordE7DistanceCm(_prev.latE7, _prev.lngE7, s.latE7, s.lngE7);
+      _maxErrorCm = max(_maxErrorCm, err);
+      _count++;
+    }
+  }
+  _prev = s;
+  _hasPrev = true;
+}
+
+void DrErrorTracker::reset() {
+  _hasPrev = false;
+  _count = 0;
+  _sumErrorCm = 0;
+  _sumHoldCm = 0;
+  _maxErrorCm = 0;
+}
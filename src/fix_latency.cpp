@@ -0,0 +1,78 @@
+// End-to-end fix latency
+
+#include "fix_latency.h"
+
+FixLatencyTracker fixLatency;
+
+// Within a burst loop() drains the UART every GPS_RX_WAKE_BYTES (8N1 frames)
+static_assert(LATENCY_BURST_GAP_MS * 1000LL > GPS_RX_WAKE_BYTES * 10000000LL / GPS_BAUD_RATE,
+              "Every UART wake-up would start a new burst");
+
+const char *const LATENCY_HOP_NAMES[HOP_COUNT] = {
+  "pps_uart", "uart_valid", "valid_publish", "publish_ws", "publish_tft", "uart_ws", "uart_tft"
+};
+
+void FixLatencyTracker::record(LatencyHop h, int64_t fromUs, int64_t toUs) {
+  if (fromUs == 0 || toUs < fromUs) return;
+  int64_t us = toUs - fromUs;
+  _hops[h].record(us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+}
+
+void FixLatencyTracker::onUartData(int64_t nowUs) {
+  if (_lastUartUs == 0 || nowUs - _lastUartUs >= LATENCY_BURST_GAP_MS * 1000LL) {
+    _burstStartUs = nowUs;
+  }
+  _lastUartUs = nowUs;
+}
+
+void FixLatencyTracker::onSentenceValid(int64_t nowUs) {
+  _validatedUs = nowUs;
+}
+
+// An epoch still waiting for an output when the next one is published is
+// retired as is: the output only ever shows the newest snapshot.
+void FixLatencyTracker::retire() {
+  if (_current.publishedUs != 0) {
+    _last = _current;
+  }
+}
+
+void FixLatencyTracker::onPublished(uint32_t epoch, int64_t nowUs, int64_t ppsUs) {
+  retire();
+
+  _current = {};
+  _current.epoch = epoch;
+  _current.firstByteUs = _burstStartUs;
+  _current.validatedUs = _validatedUs;
+  _current.publishedUs = nowUs;
+  // Only a PPS edge that precedes the burst by less than a second belongs to it
+  if (ppsUs != 0 && ppsUs <= _burstStartUs && _burstStartUs - ppsUs < 1000000LL) {
+    _current.ppsUs = ppsUs;
+  }
+
+  record(HOP_PPS_UART, _current.ppsUs, _current.firstByteUs);
+  record(HOP_UART_VALID, _current.firstByteUs, _current.validatedUs);
+  record(HOP_VALID_PUBLISH, _current.validatedUs, nowUs);
+}
+
+void FixLatencyTracker::onWsQueued(uint32_t epoch, int64_t nowUs) {
+  if (epoch != _current.epoch || _current.publishedUs == 0 || _current.wsQueuedUs != 0) return;
+  _current.wsQueuedUs = nowUs;
+  record(HOP_PUBLISH_WS, _current.publishedUs, nowUs);
+  record(HOP_UART_WS, _current.firstByteUs, nowUs);
+  if (_current.tftFlushedUs != 0) retire();
+}
+
+void FixLatencyTracker::onTftFlushed(uint32_t epoch, int64_t nowUs) {
+  if (epoch != _current.epoch || _current.publishedUs == 0 || _current.tftFlushedUs != 0) return;
+  _current.tftFlushedUs = nowUs;
+  record(HOP_PUBLISH_TFT, _current.publishedUs, nowUs);
+  record(HOP_UART_TFT, _current.firstByteUs, nowUs);
+  if (_current.wsQueuedUs != 0) retire();
+}
+
+void FixLatencyTracker::reset() {
+  for (uint8_t i = 0; i < HOP_COUNT; i++) {
+    _hops[i].reset();
+  }
+}
@@ -0,0 +1,209 @@
+// PSRAM framebuffer with background flush
+
+#include "frame_buffer.h"
+#include <Adafruit_SPITFT.h>
+
+static_assert(FRAMEBUFFER_FLUSH_CORE != GPS_TASK_CORE || FRAMEBUFFER_FLUSH_PRIORITY < GPS_TASK_PRIORITY,
+              "A flush on the GPS core must not time-slice with UART ingest");
+
+FrameBuffer frameBuffer;
+
+const char *const FLUSH_STATE_NAMES[FLUSH_STATE_COUNT] = {"idle", "partial", "full"};
+
+bool FrameBuffer::begin(Adafruit_SPITFT *tft) {
+  size_t bytes = TFT_WIDTH * TFT_HEIGHT * sizeof(uint16_t);
+  _buffer = (uint16_t *)ps_malloc(bytes);
+  _shadow = (uint16_t *)ps_malloc(bytes);
+  _idle = xSemaphoreCreateBinary();
+  if (_buffer == nullptr || _shadow == nullptr || _idle == nullptr) {
+    DEBUG_PRINTLN("Framebuffer: PSRAM allocation failed, drawing directly");
+    free(_buffer);
+    free(_shadow);
+    _buffer = _shadow = nullptr;
+    return false;
+  }
+
+  _tft = tft;
+  memset(_buffer, 0, bytes);
+  memset(_shadow, 0, bytes);
+  xSemaphoreGive(_idle);
+  xTaskCreatePinnedToCore(flushTask, "tft_flush", 3072, this, FRAMEBUFFER_FLUSH_PRIORITY, &_task,
+                          FRAMEBUFFER_FLUSH_CORE);
+  DEBUG_PRINTF("Framebuffer: 2 x %u bytes in PSRAM, flush on core %d\n", (unsigned)bytes, FRAMEBUFFER_FLUSH_CORE);
+  return true;
+}
+
+// ============================================================================
+// DRAWING
+// ============================================================================
+void FrameBuffer::markDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+  int16_t tx0 = x / FB_TILE, tx1 = (x + w - 1) / FB_TILE;
+  int16_t ty0 = y / FB_TILE, ty1 = (y + h - 1) / FB_TILE;
+  for (int16_t ty = ty0; ty <= ty1; ty++) {
+    for (int16_t tx = tx0; tx <= tx1; tx++) {
+      uint16_t t = ty * FB_TILES_X + tx;
+      _dirty[t / 32] |= 1UL << (t % 32);
+    }
+  }
+}
+
+void FrameBuffer::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= TFT_WIDTH || y >= TFT_HEIGHT) return;
+  _buffer[y * TFT_WIDTH + x] = color;
+  uint16_t t = (y / FB_TILE) * FB_TILES_X + x / FB_TILE;
+  _dirty[t / 32] |= 1UL << (t % 32);
+}
+
+void FrameBuffer::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  // Clip to the screen
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > TFT_WIDTH) w = TFT_WIDTH - x;
+  if (y + h > TFT_HEIGHT) h = TFT_HEIGHT - y;
+  if (w <= 0 || h <= 0) return;
+
+  for (int16_t row = 0; row < h; row++) {
+    uint16_t *p = &_buffer[(y + row) * TFT_WIDTH + x];
+    for (int16_t i = 0; i < w; i++) {
+      p[i] = color;
+    }
+  }
+  markDirty(x, y, w, h);
+}
+
+void FrameBuffer::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void FrameBuffer::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void FrameBuffer::fillScreen(uint16_t color) {
+  fillRect(0, 0, TFT_WIDTH, TFT_HEIGHT, color);
+}
+
+void FrameBuffer::drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) {
+  // Clip to the screen, keeping track of where the visible part starts
+  int16_t srcX = 0, srcY = 0, stride = w;
+  if (x < 0) { srcX = -x; w += x; x = 0; }
+  if (y < 0) { srcY = -y; h += y; y = 0; }
+  if (x + w > TFT_WIDTH) w = TFT_WIDTH - x;
+  if (y + h > TFT_HEIGHT) h = TFT_HEIGHT - y;
+  if (w <= 0 || h <= 0) return;
+
+  for (int16_t row = 0; row < h; row++) {
+    memcpy(&_buffer[(y + row) * TFT_WIDTH + x], &bitmap[(srcY + row) * stride + srcX], w * sizeof(uint16_t));
+  }
+  markDirty(x, y, w, h);
+}
+
+// ============================================================================
+// FLUSH
+// ============================================================================
+// Horizontal runs of dirty tiles, merged with an identical rect ending just above
+void FrameBuffer::buildRects() {
+  _rectCount = 0;
+  for (int16_t ty = 0; ty < FB_TILES_Y; ty++) {
+    size_t rowStart = _rectCount;
+    int16_t tx = 0;
+    while (tx < FB_TILES_X) {
+      uint16_t t = ty * FB_TILES_X + tx;
+      if (!(_dirty[t / 32] & (1UL << (t % 32)))) {
+        tx++;
+        continue;
+      }
+      int16_t start = tx;
+      while (tx < FB_TILES_X && (_dirty[(ty * FB_TILES_X + tx) / 32] & (1UL << ((ty * FB_TILES_X + tx) % 32)))) {
+        tx++;
+      }
+
+      Rect r;
+      r.x = start * FB_TILE;
+      r.y = ty * FB_TILE;
+      r.w = min((int16_t)(tx * FB_TILE), (int16_t)TFT_WIDTH) - r.x;
+      r.h = min((int16_t)(r.y + FB_TILE), (int16_t)TFT_HEIGHT) - r.y;
+
+      bool merged = false;
+      for (size_t i = 0; i < rowStart; i++) {
+        Rect &above = _rects[i];
+        if (above.x == r.x && above.w == r.w && above.y + above.h == r.y) {
+          above.h += r.h;
+          merged = true;
+          break;
+        }
+      }
+      if (!merged) _rects[_rectCount++] = r;
+    }
+  }
+  memset(_dirty, 0, sizeof(_dirty));
+}
+
+void FrameBuffer::present(uint32_t tag) {
+  if (_buffer == nullptr) return;
+  xSemaphoreTake(_idle, portMAX_DELAY);
+
+  buildRects();
+  if (_rectCount == 0) {
+    xSemaphoreGive(_idle);
+    return;
+  }
+  for (size_t i = 0; i < _rectCount; i++) {
+    const Rect &r = _rects[i];
+    for (int16_t row = r.y; row < r.y + r.h; row++) {
+      memcpy(&_shadow[row * TFT_WIDTH + r.x], &_buffer[row * TFT_WIDTH + r.x], r.w * sizeof(uint16_t));
+    }
+  }
+  _tag = tag;
+  xTaskNotifyGive(_task);
+}
+
+void FrameBuffer::flush() {
+  int64_t start = esp_timer_get_time();
+  uint32_t pixels = 0;
+  for (size_t i = 0; i < _rectCount; i++) {
+    pixels += (uint32_t)_rects[i].w * _rects[i].h;
+  }
+  _flushing.store(pixels == (uint32_t)TFT_WIDTH * TFT_HEIGHT ? FLUSH_FULL : FLUSH_PARTIAL,
+                  std::memory_order_relaxed);
+
+  _tft->startWrite();
+  for (size_t i = 0; i < _rectCount; i++) {
+    const Rect &r = _rects[i];
+    _tft->setAddrWindow(r.x, r.y, r.w, r.h);
+    for (int16_t row = r.y; row < r.y + r.h; row++) {
+      _tft->writePixels(&_shadow[row * TFT_WIDTH + r.x], r.w, true, false);
+    }
+  }
+  _tft->endWrite();
+  _flushing.store(FLUSH_IDLE, std::memory_order_relaxed);
+
+  int64_t end = esp_timer_get_time();
+  _flushTime.record(end - start);
+  _pixelsFlushed += pixels;
+  _flushedTag = _tag;
+  _flushedUs = end;
+  _flushed.store(true, std::memory_order_release);
+  if (_onFlushed != nullptr) _onFlushed();
+}
+
+void FrameBuffer::flushTask(void *arg) {
+  FrameBuffer *fb = (FrameBuffer *)arg;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    fb->flush();
+    xSemaphoreGive(fb->_idle);
+  }
+}
+
+void FrameBuffer::readShownRow(int16_t y, uint16_t *out) const {
+  memcpy(out, &_shadow[y * TFT_WIDTH], TFT_WIDTH * sizeof(uint16_t));
+}
+
+bool FrameBuffer::takeFlushed(uint32_t *tag, int64_t *flushedUs) {
+  if (!_flushed.load(std::memory_order_acquire)) return false;
+  *tag = _flushedTag;
+  *flushedUs = _flushedUs;
+  _flushed.store(false, std::memory_order_relaxed);
+  return true;
+}
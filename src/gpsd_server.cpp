@@ -0,0 +1,328 @@
+// gpsd-compatible JSON protocol server
+// Reports follow the gpsd JSON protocol (proto 3.x), one object per line.
+
+#include "gpsd_server.h"
+#include "lock_guard.h"
+#include "str_append.h"
+#include "num_format.h"
+
+namespace {
+// Minimal lookup of "key":true/false (or a number for "raw") in a ?WATCH object
+bool findBool(const char *obj, const char *key, bool *value) {
+  const char *p = strstr(obj, key);
+  if (p == nullptr) return false;
+  p += strlen(key);
+  while (*p == ' ' || *p == ':' || *p == '"') p++;
+  if (strncmp(p, "true", 4) == 0) { *value = true; return true; }
+  if (strncmp(p, "false", 5) == 0) { *value = false; return true; }
+  if (*p >= '0' && *p <= '9') { *value = *p != '0'; return true; }
+  return false;
+}
+} // namespace
+
+GpsdServer::GpsdServer(uint16_t port) : _server(port) {
+  memset(_clients, 0, sizeof(_clients));
+  memset(&_last, 0, sizeof(_last));
+  memset(&_lastSky, 0, sizeof(_lastSky));
+  _last.locationAgeMs = ULONG_MAX;
+}
+
+// ============================================================================
+// START / STOP
+// ============================================================================
+void GpsdServer::begin() {
+  if (_running) return;
+  if (_lock == nullptr) {
+    _lock = xSemaphoreCreateMutex();
+  }
+
+  _server.onClient([](void *arg, AsyncClient *tcp) {
+    static_cast<GpsdServer *>(arg)->handleConnect(tcp);
+  }, this);
+  _server.setNoDelay(true);
+  _server.begin();
+  _running = true;
+  DEBUG_PRINTF("gpsd server started on port %d\n", GPSD_PORT);
+}
+
+void GpsdServer::end() {
+  if (!_running) return;
+  _running = false;
+  _server.end();
+
+  // Close outside the lock: close() fires the disconnect callback synchronously
+  AsyncClient *toClose[GPSD_MAX_CLIENTS];
+  size_t n = 0;
+  {
+    LockGuard guard(_lock);
+    for (Client &c : _clients) {
+      if (c.tcp != nullptr) toClose[n++] = c.tcp;
+    }
+  }
+  for (size_t i = 0; i < n; i++) {
+    toClose[i]->close(true);
+  }
+  DEBUG_PRINTLN("gpsd server stopped");
+}
+
+// ============================================================================
+// PUBLICATION
+// ============================================================================
+void GpsdServer::publish(const GpsSnapshot &snapshot, const SkyView &sky) {
+  if (!_running) return;
+
+  size_t tpvLen = 0;
+  size_t skyLen = 0;
+  if (_clientCount > 0) {
+    tpvLen = formatTpv(_tpv, sizeof(_tpv), snapshot);
+    skyLen = formatSky(_sky, sizeof(_sky), snapshot, sky);
+  }
+
+  LockGuard guard(_lock);
+  _last = snapshot;
+  _lastSky = sky;
+  for (Client &c : _clients) {
+    if (c.tcp == nullptr || !c.watchJson) continue;
+    sendLine(c, _tpv, tpvLen);
+    sendLine(c, _sky, skyLen);
+  }
+}
+
+void GpsdServer::forwardNmea(const char *sentence, size_t len) {
+  if (!_running || _clientCount == 0) return;
+
+  char line[NMEA_MAX_SENTENCE + 2];
+  if (len > NMEA_MAX_SENTENCE) len = NMEA_MAX_SENTENCE;
+  memcpy(line, sentence, len);
+  line[len++] = '\r';
+  line[len++] = '\n';
+
+  LockGuard guard(_lock);
+  for (Client &c : _clients) {
+    if (c.tcp != nullptr && c.watchNmea) sendLine(c, line, len);
+  }
+}
+
+void GpsdServer::sendLine(Client &client, const char *line, size_t len) {
+  if (len == 0) return;
+  if (!client.tcp->canSend() || client.tcp->space() < len) {
+    _totalDrops++;
+    return;
+  }
+  client.tcp->add(line, len, ASYNC_WRITE_FLAG_COPY);
+  client.tcp->send();
+}
+
+GpsdServer::Client *GpsdServer::findClient(AsyncClient *tcp) {
+  for (Client &c : _clients) {
+    if (c.tcp == tcp) return &c;
+  }
+  return nullptr;
+}
+
+// ============================================================================
+// CLIENT CALLBACKS (AsyncTCP task)
+// ============================================================================
+void GpsdServer::handleConnect(AsyncClient *tcp) {
+  tcp->onDisconnect([](void *arg, AsyncClient *c) {
+    static_cast<GpsdServer *>(arg)->handleDisconnect(c);
+  }, this);
+  tcp->onData([](void *arg, AsyncClient *c, void *data, size_t len) {
+    static_cast<GpsdServer *>(arg)->handleData(c, static_cast<const char *>(data), len);
+  }, this);
+  tcp->setNoDelay(true);
+
+  bool accepted = false;
+  if (_running) {
+    LockGuard guard(_lock);
+    Client *entry = findClient(nullptr);
+    if (entry != nullptr) {
+      memset(entry, 0, sizeof(Client));
+      entry->tcp = tcp;
+      _clientCount++;
+      accepted = true;
+
+      // gpsd greets every client with its VERSION object
+      sendLine(*entry, _reply, formatVersion(_reply, sizeof(_reply)));
+    }
+  }
+
+  if (!accepted) {
+    DEBUG_PRINTF("gpsd client %s rejected (server full)\n", tcp->remoteIP().toString().c_str());
+    tcp->close(true);
+    return;
+  }
+  DEBUG_PRINTF("gpsd client connected from %s\n", tcp->remoteIP().toString().c_str());
+}
+
+void GpsdServer::handleDisconnect(AsyncClient *tcp) {
+  {
+    LockGuard guard(_lock);
+    Client *c = findClient(tcp);
+    if (c != nullptr) {
+      c->tcp = nullptr;
+      _clientCount--;
+    }
+  }
+  delete tcp;
+}
+
+void GpsdServer::handleData(AsyncClient *tcp, const char *data, size_t len) {
+  LockGuard guard(_lock);
+  Client *c = findClient(tcp);
+  if (c == nullptr) return;
+
+  // Commands are terminated by ';' and/or a newline
+  for (size_t i = 0; i < len; i++) {
+    char ch = data[i];
+    if (ch == ';' || ch == '\n' || ch == '\r') {
+      if (c->rxLen > 0) {
+        c->rx[c->rxLen] = '\0';
+        handleCommand(*c, c->rx);
+        c->rxLen = 0;
+      }
+    } else if (c->rxLen < GPSD_RX_BUFFER - 1) {
+      c->rx[c->rxLen++] = ch;
+    }
+  }
+}
+
+void GpsdServer::handleCommand(Client &client, const char *cmd) {
+  // Called under _lock
+  char *line = _reply;
+  const size_t cap = sizeof(_reply);
+  size_t len = 0;
+
+  if (strncmp(cmd, "?WATCH", 6) == 0) {
+    const char *args = strchr(cmd, '{');
+    if (args != nullptr) {
+      bool enable = true;
+      bool json = false;
+      bool nmea = false;
+      bool raw = false;
+      findBool(args, "\"enable\"", &enable);
+      bool hasJson = findBool(args, "\"json\"", &json);
+      bool hasNmea = findBool(args, "\"nmea\"", &nmea);
+      bool hasRaw = findBool(args, "\"raw\"", &raw);
+
+      if (enable) {
+        // Like gpsd, a bare enable defaults to JSON reports
+        if (!hasJson && !hasNmea && !hasRaw) json = true;
+        client.watchJson = json;
+        client.watchNmea = nmea || raw;
+        len = formatDevices(line, cap);
+        sendLine(client, line, len);
+      } else {
+        client.watchJson = false;
+        client.watchNmea = false;
+      }
+    }
+    len = formatWatch(line, cap, client);
+  } else if (strncmp(cmd, "?POLL", 5) == 0) {
+    len = formatPoll(line, cap);
+  } else if (strncmp(cmd, "?VERSION", 8) == 0) {
+    len = formatVersion(line, cap);
+  } else if (strncmp(cmd, "?DEVICES", 8) == 0) {
+    len = formatDevices(line, cap);
+  } else {
+    appendf(line, cap, &len, "{\"class\":\"ERROR\",\"message\":\"Unrecognized request '%.32s'\"}\n", cmd);
+  }
+  sendLine(client, line, len);
+}
+
+// ============================================================================
+// REPORT FORMATTING
+// ============================================================================
+size_t GpsdServer::formatVersion(char *buf, size_t cap) {
+  size_t len = 0;
+  appendf(buf, cap, &len,
+          "{\"class\":\"VERSION\",\"release\":\"%s\",\"rev\":\"%s %s\",\"proto_major\":3,\"proto_minor\":11}\n",
+          GPSD_RELEASE, PROJECT_NAME, PROJECT_VERSION);
+  return len;
+}
+
+size_t GpsdServer::formatDevices(char *buf, size_t cap) {
+  size_t len = 0;
+  appendf(buf, cap, &len,
+          "{\"class\":\"DEVICES\",\"devices\":[{\"class\":\"DEVICE\",\"path\":\"%s\","
+          "\"driver\":\"NMEA0183\",\"subtype\":\"%s\",\"flags\":1,\"native\":0,"
+          "\"bps\":%d,\"parity\":\"N\",\"stopbits\":1,\"cycle\":%.2f}]}\n",
+          GPSD_DEVICE_PATH, GPS_MODEL, GPS_BAUD_RATE, GPS_UPDATE_RATE / 1000.0);
+  return len;
+}
+
+size_t GpsdServer::formatWatch(char *buf, size_t cap, const Client &client) {
+  bool enabled = client.watchJson || client.watchNmea;
+  size_t len = 0;
+  appendf(buf, cap, &len,
+          "{\"class\":\"WATCH\",\"enable\":%s,\"json\":%s,\"nmea\":%s,\"raw\":0,"
+          "\"scaled\":false,\"timing\":false,\"split24\":false,\"pps\":false}\n",
+          enabled ? "true" : "false",
+          client.watchJson ? "true" : "false",
+          client.watchNmea ? "true" : "false");
+  return len;
+}
+
+size_t GpsdServer::formatTpv(char *buf, size_t cap, const GpsSnapshot &s) {
+  bool fix = snapshotHasFix(s);
+  int mode = !fix ? 1 : (s.altitudeValid ? 3 : 2);
+
+  size_t len = 0;
+  appendf(buf, cap, &len, "{\"class\":\"TPV\",\"device\":\"%s\",\"mode\":%d", GPSD_DEVICE_PATH, mode);
+  if (s.dateValid && s.timeValid && s.year > 2000) {
+    appendf(buf, cap, &len, ",\"time\":\"%04u-%02u-%02uT%02u:%02u:%02u.%02u0Z\"",
+            s.year, s.month, s.day, s.hour, s.minute, s.second, s.centisecond);
+  }
+  if (fix) {
+    char lat[16], lng[16];
+    fmtScaled(lat, sizeof(lat), s.latE7, 7, FMT_WIRE_COORD);
+    fmtScaled(lng, sizeof(lng), s.lngE7, 7, FMT_WIRE_COORD);
+    appendf(buf, cap, &len, ",\"lat\":%s,\"lon\":%s", lat, lng);
+    if (s.altitudeValid) {
+      appendf(buf, cap, &len, ",\"alt\":%.1f,\"altMSL\":%.1f", s.altitudeM, s.altitudeM);
+    }
+    if (s.courseValid) appendf(buf, cap, &len, ",\"track\":%.1f", s.courseDeg);
+    if (s.speedValid) appendf(buf, cap, &len, ",\"speed\":%.3f", s.speedKmph / 3.6);
+  }
+  appendf(buf, cap, &len, "}\n");
+  return len;
+}
+
+size_t GpsdServer::formatSky(char *buf, size_t cap, const GpsSnapshot &s, const SkyView &sky) {
+  size_t len = 0;
+  appendf(buf, cap, &len, "{\"class\":\"SKY\",\"device\":\"%s\"", GPSD_DEVICE_PATH);
+  if (s.hdopValid) appendf(buf, cap, &len, ",\"hdop\":%.2f", s.hdop);
+  appendf(buf, cap, &len, ",\"nSat\":%u,\"uSat\":%u,\"satellites\":[",
+          (unsigned)sky.count, (unsigned)s.satellites);
+  // Like gpsd, el/az are left out until the receiver reports them
+  for (uint8_t i = 0; i < sky.count; i++) {
+    const SatInfo &sat = sky.sats[i];
+    appendf(buf, cap, &len, "%s{\"PRN\":%u", i > 0 ? "," : "", (unsigned)sat.prn);
+    if (sat.elevation != SAT_ELEVATION_UNKNOWN) {
+      appendf(buf, cap, &len, ",\"el\":%d,\"az\":%u", sat.elevation, (unsigned)sat.azimuth);
+    }
+    appendf(buf, cap, &len, ",\"ss\":%u,\"used\":%s}", (unsigned)sat.snr, sat.used ? "true" : "false");
+  }
+  appendf(buf, cap, &len, "]}\n");
+  return len;
+}
+
+size_t GpsdServer::formatPoll(char *buf, size_t cap) {
+  const GpsSnapshot &s = _last;
+  size_t len = 0;
+  appendf(buf, cap, &len, "{\"class\":\"POLL\",");
+  if (s.dateValid && s.timeValid && s.year > 2000) {
+    appendf(buf, cap, &len, "\"time\":\"%04u-%02u-%02uT%02u:%02u:%02u.%02u0Z\",",
+            s.year, s.month, s.day, s.hour, s.minute, s.second, s.centisecond);
+  }
+  appendf(buf, cap, &len, "\"active\":1,\"tpv\":[");
+
+  // Embed the TPV/SKY objects without their newline
+  if (len < cap) len += formatTpv(buf + len, cap - len, s);
+  if (len > 0 && buf[len - 1] == '\n') len--;
+  appendf(buf, cap, &len, "],\"sky\":[");
+  if (len < cap) len += formatSky(buf + len, cap - len, s, _lastSky);
+  if (len > 0 && buf[len - 1] == '\n') len--;
+  appendf(buf, cap, &len, "]}\n");
+  return len;
+}
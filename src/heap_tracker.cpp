@@ -0,0 +1,129 @@
+// Heap allocation tracker and fragmentation history
+
+#include "heap_tracker.h"
+
+HeapTracker heapTracker;
+
+// Stage the current task is in, maintained by ScopedStageTimer. Per task:
+// several tasks share each core and get preempted in the middle of a stage.
+thread_local uint8_t heapTrackerStage = HEAP_BUCKET_UNSTAGED;
+
+const char *heapBucketName(uint8_t bucket) {
+  if (bucket < STAGE_COUNT) return PROFILE_STAGE_NAMES[bucket];
+  if (bucket == HEAP_BUCKET_OTHER_TASKS) return "other_tasks";
+  return "unstaged";
+}
+
+void HeapTracker::begin() {
+  _loopTask = xTaskGetCurrentTaskHandle();
+  sample();
+}
+
+void HeapTracker::onLoopEnd() {
+  if (_loopResetPending.exchange(false, std::memory_order_relaxed)) {
+    _maxLoopAllocs = 0;
+    _loopsWithAllocs = 0;
+    _loops = 0;
+  }
+  uint32_t n = _loopTaskAllocs - _allocsAtLoopStart;
+  _allocsAtLoopStart = _loopTaskAllocs;
+  _lastLoopAllocs = n;
+  if (n > _maxLoopAllocs) _maxLoopAllocs = n;
+  if (n > 0) _loopsWithAllocs++;
+  _loops++;
+
+  if (millis() - _lastSampleMs >= HEAP_SAMPLE_INTERVAL_MS) {
+    sample();
+  }
+}
+
+// Must not allocate: runs inside malloc()
+void IRAM_ATTR HeapTracker::onAlloc(size_t size) {
+  uint8_t index = currentBucket();
+  if (_loopTask != nullptr && xTaskGetCurrentTaskHandle() == _loopTask) {
+    _loopTaskAllocs++;
+  }
+  _buckets[index].allocs.fetch_add(1, std::memory_order_relaxed);
+  _buckets[index].bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void IRAM_ATTR HeapTracker::onFree() {
+  _buckets[currentBucket()].frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The calling task's stage; outside any stage, unstaged for the loop task
+// (setup) and other_tasks for everything else
+uint8_t IRAM_ATTR HeapTracker::currentBucket() const {
+  uint8_t stage = heapTrackerStage;
+  if (stage != HEAP_BUCKET_UNSTAGED) return stage;
+  if (_loopTask != nullptr && xTaskGetCurrentTaskHandle() == _loopTask) return HEAP_BUCKET_UNSTAGED;
+  return HEAP_BUCKET_OTHER_TASKS;
+}
+
+HeapBucketStats HeapTracker::bucket(uint8_t index) const {
+  const Bucket &b = _buckets[index];
+  return {b.allocs.load(std::memory_order_relaxed), b.frees.load(std::memory_order_relaxed),
+          b.bytes.load(std::memory_order_relaxed)};
+}
+
+void HeapTracker::resetCounters() {
+  for (Bucket &b : _buckets) {
+    b.allocs.store(0, std::memory_order_relaxed);
+    b.frees.store(0, std::memory_order_relaxed);
+    b.bytes.store(0, std::memory_order_relaxed);
+  }
+  _loopResetPending.store(true, std::memory_order_relaxed);
+}
+
+void HeapTracker::sample() {
+  HeapSample &s = _history[_historyHead];
+  s.uptimeS = millis() / 1000;
+  s.freeBytes = ESP.getFreeHeap();
+  s.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  s.minFreeBytes = ESP.getMinFreeHeap();
+  _historyHead = (_historyHead + 1) % HEAP_HISTORY_SIZE;
+  if (_historyCount < HEAP_HISTORY_SIZE) _historyCount++;
+  _lastSampleMs = millis();
+}
+
+HeapSample HeapTracker::historyAt(size_t i) const {
+  size_t oldest = (_historyHead + HEAP_HISTORY_SIZE - _historyCount) % HEAP_HISTORY_SIZE;
+  return _history[(oldest + i) % HEAP_HISTORY_SIZE];
+}
+
+// ============================================================================
+// LINK-TIME WRAPPERS (-Wl,--wrap=malloc,...)
+// ============================================================================
+#if HEAP_TRACKING
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *IRAM_ATTR __wrap_malloc(size_t size) {
+  void *p = __real_malloc(size);
+  if (p != nullptr) heapTracker.onAlloc(size);
+  return p;
+}
+
+void *IRAM_ATTR __wrap_calloc(size_t n, size_t size) {
+  void *p = __real_calloc(n, size);
+  if (p != nullptr) heapTracker.onAlloc(n * size);
+  return p;
+}
+
+// Growing a String is a realloc: count it as a new allocation
+void *IRAM_ATTR __wrap_realloc(void *ptr, size_t size) {
+  void *p = __real_realloc(ptr, size);
+  if (p != nullptr && size > 0) heapTracker.onAlloc(size);
+  if (ptr != nullptr && (p != nullptr || size == 0)) heapTracker.onFree();
+  return p;
+}
+
+void IRAM_ATTR __wrap_free(void *ptr) {
+  if (ptr != nullptr) heapTracker.onFree();
+  __real_free(ptr);
+}
+}
+#endif
@@ -1,21 +1,45 @@
-// Version: 1.8.2
+// Version: 1.33.0
 // ESP32-S3 DevKitC-1 N16R8 - GPS GT-U7 Tester - TFT Display Enhancements
 // Main Application File
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WiFiMulti.h>
 #include <ESPAsyncWebServer.h>
 #include <AsyncTCP.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7789.h>
 #include <TinyGPSPlus.h>
 #include <ArduinoJson.h>
-#include <Adafruit_NeoPixel.h>
 #include "config.h"
 #include "webpage.h" // Externalized web page content
 #include "DrSugiyama_Regular28pt7b.h" // Custom font for startup
 #include "secrets.h"
+#include "nmea_server.h"
+#include "gpsd_server.h"
+#include "gps_snapshot.h"
+#include "udp_fix.h"
+#include "buzzer.h"
+#include "status_led.h"
+#include "wifi_manager.h"
+#include "button_input.h"
+#include "mqtt_publisher.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "trace.h"
+#include "fix_latency.h"
+#include "heap_tracker.h"
+#include "tft_widgets.h"
+#include "frame_buffer.h"
+#include "display_state.h"
+#include "text_cache.h"
+#include "num_format.h"
+#include "sat_table.h"
+#include "track_history.h"
+#include "track_map.h"
+#include "dead_reckoning.h"
+#include "screenshot.h"
+#include "app_tasks.h"
+#include "scheduler.h"
 
 // ============================================================================
 // GLOBAL OBJECTS
@@ -23,43 +47,65 @@
 // Utilisation de pointeurs pour les objets matériels afin d'éviter une initialisation précoce
 Adafruit_ST7789 *tftPtr = nullptr;
 TinyGPSPlus gps;
-WiFiMulti wifiMulti;
 AsyncWebServer server(WEB_SERVER_PORT);
 AsyncWebSocket ws("/ws");
-Adafruit_NeoPixel *pixelPtr = nullptr;
+NmeaTcpServer nmeaServer(NMEA_TCP_PORT);
+GpsdServer gpsdServer(GPSD_PORT);
+UdpFixSender udpFixSender;
+MqttPublisher mqttPublisher;
 
 // Helper macro to access TFT (for easy migration back if needed)
 #define tft (*tftPtr)
+// Drawing target: the PSRAM framebuffer, or the TFT itself without one
+Adafruit_GFX *gfxPtr = nullptr;
+#define gfx (*gfxPtr)
 
 
 // ============================================================================
 // GLOBAL VARIABLES
 // ============================================================================
 HardwareSerial gpsSerial(2); // Using UART2 for GPS
-uint8_t currentPage = PAGE_GPS_DATA;
-bool lastButton1State = HIGH;
-unsigned long lastButton1Press = 0;
-unsigned long lastDisplayUpdate = 0;
-unsigned long lastGPSData = 0;
+uint8_t currentPage = PAGE_GPS_DATA; // Owned by the display task
+unsigned long lastGPSData = 0;       // Owned by the GPS task
 unsigned long gpsFixAcquiredTime = 0;
 bool previousFixStatus = false;
-bool wifiConnected = false;
-String ipAddress = "";
+unsigned long ttffStartMs = 0;       // TTFF test running since (GPS task, 0 = none)
+uint32_t ttffMs = 0;                 // Last TTFF test result (0 = none)
+std::atomic<bool> trackRecording(true);     // Breadcrumbs are added to trackHistory
+std::atomic<bool> wifiConnected(false);     // Written by the network task
+String ipAddress = "";                      // Owned by the network task (netStatus for the others)
 bool webServerSetupDone = false;
-int connectedClients = 0;
+std::atomic<int> connectedClients(0);       // WebSocket clients, counted by AsyncTCP callbacks
+
+// Cross-task state (app_tasks.h)
+SeqLock<GpsStatus> gpsStatus;
+SeqLock<NetStatus> netStatus;
+SeqLock<WsQueuedStamp> wsQueuedStamp;
+SeqLock<LatencyStatus> latencyStatus;
+TaskHandle_t networkTaskHandle = nullptr;
+TaskHandle_t uiTaskHandle = nullptr;
+
+// Periodic and triggered work of the GPS and network tasks (scheduler.h)
+Scheduler gpsScheduler("gps");
+Scheduler networkScheduler("network");
+JobId gpsReadJob, gpsResetJob, ttffTestJob, fixLatencyJob, latencyResetJob;  // GPS task
+JobId wifiJob, mqttEpochJob, wsBroadcastJob;                 // Network task
 
 // --- Display Layout Constants (consider moving to config.h) ---
 const int TFT_HEADER_HEIGHT = 60; // Reduced header height
 const int TFT_PAGE_START_Y = TFT_HEADER_HEIGHT + 1; // Y-start for page content
 const int TFT_LINE_HEIGHT = 20; // Line spacing for font size 2
+const int TFT_CONTENT_Y = TFT_PAGE_START_Y + TFT_LINE_HEIGHT + 10; // First row below the page title
+bool displayNeedsClear = true; // Set when something drew over the widgets (splash screen)
 
-
-// NeoPixel status variables
-enum LedState { OFF, SOLID, BLINKING };
-LedState ledState = SOLID;
-uint32_t ledColor = NEOPIXEL_COLOR_BLUE;
-bool ledOn = true;
-unsigned long lastBlinkTime = 0;
+// Display task and its inputs (display_state.h)
+TaskHandle_t displayTaskHandle = nullptr;
+QueueHandle_t displayStateQueue = nullptr;
+QueueHandle_t displayEventQueue = nullptr;
+// Frame completion when drawing straight to the TFT (see takeFlushedFrame)
+std::atomic<bool> directFrameFlushed(false);
+uint32_t directFlushedEpoch = 0;
+int64_t directFlushedUs = 0;
 
 
 // GPS statistics
@@ -67,6 +113,26 @@ uint32_t totalSentences = 0;
 uint32_t failedChecksums = 0;
 uint32_t validSentences = 0;
 
+// Raw NMEA line being received (forwarded once TinyGPSPlus validates it)
+char nmeaLine[NMEA_MAX_SENTENCE];
+size_t nmeaLineLen = 0;
+
+// Per-epoch fix snapshot (GPS task; the other tasks read gpsStatus)
+GpsSnapshot gpsSnapshot = {};
+bool epochHasGGA = false;
+bool epochHasRMC = false;
+
+// PPS edge timestamp (esp_timer microseconds, 0 = no PPS seen yet). Atomic:
+// two 32-bit halves written by the ISR would tear under the GPS task
+std::atomic<int64_t> ppsLastEdgeUs(0);
+volatile uint32_t ppsEdgeCount = 0;
+
+// UART data waiting for the GPS task: when the UART event task woke it and
+// what the framebuffer flush (same core, lower priority) was sending then
+std::atomic<int64_t> gpsRxWakeUs(0);
+std::atomic<FlushState> gpsRxWakeFlush(FLUSH_IDLE);
+LatencyHistogram gpsWakeTime[FLUSH_STATE_COUNT];  // Wake-up to the GPS task reading, per flush state
+
 // ============================================================================
 // FUNCTION PROTOTYPES
 // ============================================================================
@@ -75,20 +141,51 @@ void setupSerial();
 void setupDisplay();
 void setupWiFi();
 void setupWebServer();
+void startNetworkServices();
+void stopNetworkServices();
 void setupGPS();
-void handleButton();
+void beginGpsSerial();
+void setupJobs();
+void handleButtonEvent(const ButtonEvent &event);
+void startTtffTest();
 void updateGPS();
 void updateDisplay();
-void drawHeader();
-void drawPageGPSData();
-void drawPageDiagnostics();
-void drawPageSatellites();
-void setLedStatus(LedState state, uint32_t color);
-void updateLed();
-void playTone(int frequency, int duration);
+void updateWsLatency();
+void networkTask(void *arg);
+void updateWiFi();
+void broadcastWs();
+void uiTask(void *arg);
+void displayTask(void *arg);
+void handleDisplayEvent(const DisplayEvent &event, unsigned long *splashUntil);
+void renderFrame(const DisplayState &state);
+void publishDisplayState();
+void requestDisplayRefresh();
+void publishGpsStatus();
+void publishNetStatus();
+void publishLatencyStatus();
+void showInitScreen(const String& line1, const String& line2 = "", const String& line3 = "", uint16_t holdMs = 0);
+bool takeFlushedFrame(uint32_t *epoch, int64_t *flushedUs);
+void drawHeader(const DisplayState &state);
+void drawPageGPSData(const DisplayState &state);
+void drawPageDiagnostics(const DisplayState &state);
+void drawPageSatellites(const DisplayState &state);
+void drawPageSky(const DisplayState &state);
+void drawPageMap();
+void drawPageProfiler();
+void drawPageTitle(const char *title);
+void presentDisplay(uint32_t epoch);
+void drawWidgets(std::initializer_list<TextWidget *> widgets);
 void resetGPS();
-String getGPSJson();
-void drawInitScreen(const String& line1, const String& line2 = "", const String& line3 = "");
+void onNmeaSentence(const char *sentence, size_t len);
+void trackEpoch(const char *sentence, size_t len);
+void publishSnapshot();
+void IRAM_ATTR onPpsEdge();
+void publishMqttStats();
+bool renderMetricsFamily(MetricsWriter &w, uint8_t index);
+void jobSamples(MetricsWriter &w, const char *name, const char *help, const char *type,
+                uint64_t (*value)(const JobStats &s), bool microseconds = false);
+String getGPSJson(const GpsStatus &status);
+void drawInitScreen(const DisplayEvent &splash);
 void onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
                       AwsEventType type, void *arg, uint8_t *data, size_t len);
 
@@ -100,12 +197,19 @@ void setup() {
   Serial.begin(SERIAL_DEBUG_BAUD);
   delay(1000);
   DEBUG_PRINTLN("\n\n=== BOOT STARTING ===");
+  heapTracker.begin();
 
   DEBUG_PRINTLN("Setting up pins...");
   setupPins();
+  setupJobs();
+
+  if (TRACE_ENABLED) {
+    tracer.begin();
+  }
+  trackHistory.begin();
 
   DEBUG_PRINTLN("Setting LED status...");
-  setLedStatus(SOLID, NEOPIXEL_COLOR_BLUE); // Blue during init
+  statusLed.set(LED_BREATHE, NEOPIXEL_COLOR_BLUE); // Breathing blue during init
 
   DEBUG_PRINTLN("Setting up display...");
   setupDisplay();
@@ -121,8 +225,15 @@ void setup() {
   DEBUG_PRINT("Version: ");
   DEBUG_PRINTLN(PROJECT_VERSION);
   DEBUG_PRINTLN("=================================");
-  DEBUG_PRINTLN("Setup complete. Starting main loop...");
-
+  publishGpsStatus();
+  publishDisplayState();
+
+  // loop() carries on as the GPS task (app_tasks.h)
+  configASSERT(xPortGetCoreID() == GPS_TASK_CORE && uxTaskPriorityGet(nullptr) == GPS_TASK_PRIORITY);
+  xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK, nullptr, NETWORK_TASK_PRIORITY,
+                          &networkTaskHandle, NETWORK_TASK_CORE);
+  xTaskCreatePinnedToCore(uiTask, "ui", UI_TASK_STACK, nullptr, UI_TASK_PRIORITY, &uiTaskHandle, UI_TASK_CORE);
+  DEBUG_PRINTLN("Setup complete. Starting tasks...");
 }
 
 // ============================================================================
@@ -130,27 +241,17 @@ void setup() {
 // ============================================================================
 void setupPins() {
   DEBUG_PRINTLN("  - Setting up buttons...");
-  pinMode(PIN_BUTTON_1, INPUT_PULLUP);
-  pinMode(PIN_BUTTON_2, INPUT_PULLUP);
+  buttonInput.begin();
 
   DEBUG_PRINTLN("  - Initializing NeoPixel...");
-  // Create NeoPixel object dynamically to avoid early initialization crash
-  pixelPtr = new Adafruit_NeoPixel(NEOPIXEL_NUM_PIXELS, PIN_NEOPIXEL, NEO_GRB + NEO_KHZ800);
-  if (pixelPtr != nullptr) {
-    pixelPtr->begin();
-    pixelPtr->setBrightness(NEOPIXEL_BRIGHTNESS);
-    pixelPtr->clear();
-    pixelPtr->show();
-    DEBUG_PRINTLN("  - NeoPixel OK");
-  } else {
-    DEBUG_PRINTLN("  - NeoPixel FAILED to allocate!");
-  }
+  statusLed.begin();
 
   DEBUG_PRINTLN("  - Setting up buzzer (LEDC)...");
   // Initialize LEDC for the buzzer (tone function)
   // This prevents the "LEDC is not initialized" crash
   ledcSetup(BUZZER_LEDC_CHANNEL, BUZZER_FREQ_FIX, 8); // Setup channel with default freq, 8-bit resolution
   ledcAttachPin(PIN_BUZZER, BUZZER_LEDC_CHANNEL);
+  buzzer.begin();
   DEBUG_PRINTLN("  - Buzzer OK");
 
   DEBUG_PRINTLN("  - Setting up TFT backlight...");
@@ -159,6 +260,7 @@ void setupPins() {
 
   DEBUG_PRINTLN("  - Setting up GPS PPS pin...");
   pinMode(PIN_GPS_PPS, INPUT);
+  attachInterrupt(digitalPinToInterrupt(PIN_GPS_PPS), onPpsEdge, RISING);
   DEBUG_PRINTLN("  - Pin setup complete");
 }
 
@@ -173,40 +275,46 @@ void setupSerial() {
 // ============================================================================
 // DRAW INITIALIZATION SCREEN
 // ============================================================================
-void drawInitScreen(const String& line1, const String& line2, const String& line3) {
-  tft.fillScreen(TFT_COLOR_BG);
+// Queued for the display task, which draws it and holds it for holdMs
+void showInitScreen(const String& line1, const String& line2, const String& line3, uint16_t holdMs) {
+  if (displayEventQueue == nullptr) return;
+  DisplayEvent event = {};
+  event.type = DISPLAY_EVENT_SPLASH;
+  event.holdMs = holdMs;
+  strlcpy(event.lines[0], line1.c_str(), sizeof(event.lines[0]));
+  strlcpy(event.lines[1], line2.c_str(), sizeof(event.lines[1]));
+  strlcpy(event.lines[2], line3.c_str(), sizeof(event.lines[2]));
+  xQueueSend(displayEventQueue, &event, portMAX_DELAY);
+}
+
+void drawInitScreen(const DisplayEvent &splash) {
+  const char *line1 = splash.lines[0];
+  const char *line2 = splash.lines[1];
+  const char *line3 = splash.lines[2];
 
-  // --- Draw Title ("morfredus") with custom font ---
-  tft.setFont(&DrSugiyama_Regular28pt7b);
-  tft.setTextColor(TFT_COLOR_WARNING);
-  tft.setTextSize(1.8); // Augmentation de la taille de la police personnalisée
-  int16_t x1, y1;
-  uint16_t w, h;
-  tft.getTextBounds("morfredus", 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor((TFT_WIDTH - w) / 2, 60);
-  tft.print("morfredus");
+  gfx.fillScreen(TFT_COLOR_BG);
+  displayNeedsClear = true;
+
+  // Pre-rasterized once, then a block copy per splash (text_cache.h)
+  // --- Draw Title ("morfredus") with custom font, true fractional scale ---
+  textCache.drawCentered(gfx, "morfredus", &DrSugiyama_Regular28pt7b, SPLASH_TITLE_SCALE,
+                         TFT_COLOR_WARNING, TFT_COLOR_BG, 60);
 
   // --- Draw Subtitle ("GPS Tester") ---
-  tft.setFont(); // Reset to default font
-  tft.setTextSize(3);
-  tft.setTextColor(TFT_COLOR_TEXT); // Changed to TEXT for consistency with other status messages
-  tft.getTextBounds("GPS Tester", 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor((TFT_WIDTH - w) / 2, 95);
-  tft.print("GPS Tester");
+  textCache.drawCentered(gfx, "GPS Tester", nullptr, 3, TFT_COLOR_TEXT, TFT_COLOR_BG, 95);
 
   // --- Draw status lines with default font ---
-  tft.setTextColor(TFT_COLOR_TEXT);
-  tft.setTextSize(2); // Reverted to original size 2
-  tft.getTextBounds(line1, 0, 0, &x1, &y1, &w, &h); tft.setCursor((TFT_WIDTH - w) / 2, 150); tft.print(line1);
-  tft.getTextBounds(line2, 0, 0, &x1, &y1, &w, &h); tft.setCursor((TFT_WIDTH - w) / 2, 180); tft.print(line2);
-  tft.getTextBounds(line3, 0, 0, &x1, &y1, &w, &h); tft.setCursor((TFT_WIDTH - w) / 2, 210); tft.print(line3);
+  textCache.drawCentered(gfx, line1, nullptr, 2, TFT_COLOR_TEXT, TFT_COLOR_BG, 150);
+  textCache.drawCentered(gfx, line2, nullptr, 2, TFT_COLOR_TEXT, TFT_COLOR_BG, 180);
+  textCache.drawCentered(gfx, line3, nullptr, 2, TFT_COLOR_TEXT, TFT_COLOR_BG, 210);
+
+  presentDisplay(0);
 }
 
 // ============================================================================
 // DISPLAY SETUP
 // ============================================================================
 void setupDisplay() {
-  updateLed(); // Show blue color
   DEBUG_PRINTLN("Initializing TFT display...");
   
   // Création dynamique de l'objet TFT pour éviter les crashs d'initialisation précoce
@@ -220,9 +328,21 @@ void setupDisplay() {
   tft.init(TFT_WIDTH, TFT_HEIGHT);
   tft.setRotation(TFT_ROTATION);
   tft.fillScreen(TFT_COLOR_BG);
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  tft.setTextWrap(false);
-  drawInitScreen("Initializing...");
+  gfxPtr = tftPtr;
+  if (USE_TFT_SPRITE && frameBuffer.begin(tftPtr)) {
+    gfxPtr = &frameBuffer;
+    frameBuffer.onFlushed([]() { gpsScheduler.trigger(fixLatencyJob); });
+  }
+  textCache.begin(tftPtr);
+  gfx.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
+  gfx.setTextWrap(false);
+
+  displayStateQueue = xQueueCreate(1, sizeof(DisplayState));
+  displayEventQueue = xQueueCreate(DISPLAY_EVENT_QUEUE_LEN, sizeof(DisplayEvent));
+  xTaskCreatePinnedToCore(displayTask, "display", DISPLAY_TASK_STACK, nullptr, DISPLAY_TASK_PRIORITY,
+                          &displayTaskHandle, DISPLAY_TASK_CORE);
+
+  showInitScreen("Initializing...");
   DEBUG_PRINTLN("TFT display initialized");
 }
 
@@ -230,41 +350,92 @@ void setupDisplay() {
 // GPS SETUP
 // ============================================================================
 void setupGPS() {
-  updateLed(); // Show blue color
   DEBUG_PRINTLN("Initializing GPS...");
-  gpsSerial.begin(GPS_BAUD_RATE, SERIAL_8N1, PIN_GPS_RXD, PIN_GPS_TXD);
+  gpsSnapshot.locationAgeMs = ULONG_MAX;
+  beginGpsSerial();
   DEBUG_PRINTF("GPS Serial initialized on RX:%d TX:%d at %d baud\n",
                PIN_GPS_RXD, PIN_GPS_TXD, GPS_BAUD_RATE);
 }
 
+// Also after a GPS reset: end() drops the callbacks and the UART event task,
+// and begin() restores the default RX FIFO threshold
+void beginGpsSerial() {
+  gpsSerial.begin(GPS_BAUD_RATE, SERIAL_8N1, PIN_GPS_RXD, PIN_GPS_TXD);
+  gpsSerial.setRxFIFOFull(GPS_RX_WAKE_BYTES);
+  gpsSerial.onReceiveError([](hardwareSerial_error_t) { metrics.uartErrors++; });
+  // UART event task: wakes the GPS task instead of it polling available()
+  gpsSerial.onReceive([]() {
+    int64_t pending = 0;
+    if (gpsRxWakeUs.compare_exchange_strong(pending, esp_timer_get_time())) {
+      gpsRxWakeFlush.store(frameBuffer.flushState(), std::memory_order_relaxed);
+    }
+    gpsScheduler.trigger(gpsReadJob);
+  });
+}
+
+// ============================================================================
+// SCHEDULED JOBS
+// ============================================================================
+// Before the tasks start. New periodic work goes here, not in the task loops.
+void setupJobs() {
+  // GPS task: the UART and the parser
+  gpsReadJob = gpsScheduler.every("gps_read", GPS_CHECK_INTERVAL, updateGPS); // And on UART data
+  gpsResetJob = gpsScheduler.onTrigger("gps_reset", resetGPS);
+  ttffTestJob = gpsScheduler.onTrigger("ttff_test", startTtffTest);
+  fixLatencyJob = gpsScheduler.onTrigger("fix_latency", []() {
+    updateDisplay();
+    updateWsLatency();
+    publishLatencyStatus();
+  });
+  latencyResetJob = gpsScheduler.onTrigger("latency_reset", []() {
+    fixLatency.reset();
+    publishLatencyStatus();
+  });
+
+  // Network task
+  wifiJob = networkScheduler.every("wifi", NETWORK_WIFI_INTERVAL, updateWiFi); // And on WiFi events
+  wsBroadcastJob = networkScheduler.every("ws_broadcast", WEB_UPDATE_INTERVAL, broadcastWs); // And on epochs, fix changes
+  networkScheduler.every("ws_cleanup", WS_CLEANUP_INTERVAL, []() {
+    if (webServerSetupDone) ws.cleanupClients();
+  });
+  if (MQTT_ENABLED) {
+    mqttEpochJob = networkScheduler.onTrigger("mqtt_epoch", []() { mqttPublisher.addQueuedEpochs(); });
+    networkScheduler.every("mqtt", MQTT_LOOP_INTERVAL, []() {
+      PROFILE_STAGE(STAGE_MQTT);
+      mqttPublisher.loop(wifiConnected);
+    });
+    networkScheduler.every("mqtt_stats", MQTT_STATS_INTERVAL, publishMqttStats);
+  }
+}
+
 // ============================================================================
 // WIFI SETUP
 // ============================================================================
 void setupWiFi() {
-  updateLed(); // Show blue color
-  drawInitScreen("Searching" , "for WiFi...");
+  showInitScreen("Searching" , "for WiFi...");
   DEBUG_PRINTLN("Connecting to WiFi...");
 
-  WiFi.mode(WIFI_STA);
-  wifiMulti.addAP(WIFI_SSID_1, WIFI_PASSWORD_1);
-  wifiMulti.addAP(WIFI_SSID_2, WIFI_PASSWORD_2);
+  wifiManager.addNetwork(WIFI_SSID_1, WIFI_PASSWORD_1);
+  wifiManager.addNetwork(WIFI_SSID_2, WIFI_PASSWORD_2);
+  // Starts the first scan; the network task runs the rest (updateWiFi)
+  wifiManager.onEvent([]() { networkScheduler.trigger(wifiJob); });
+  wifiManager.begin();
+
+  if (MQTT_ENABLED) {
+    mqttPublisher.begin(); // Needs the STA MAC for its client ID
+  }
 
-  // La connexion est maintenant gérée de manière non bloquante dans la loop()
-  // On lance juste la première tentative ici.
-  wifiMulti.run();
   ipAddress = "Connecting...";
+  publishNetStatus();
   DEBUG_PRINTLN("WiFi connection process started...");
 }
 
 // ============================================================================
 // WEB SERVER SETUP
 // ============================================================================
+// Routes only, once; the servers listen while the link is up
+// (startNetworkServices / stopNetworkServices)
 void setupWebServer() {
-  if (!wifiConnected) {
-    DEBUG_PRINTLN("Skipping web server setup (no WiFi)");
-    return;
-  }
-
   DEBUG_PRINTLN("Setting up web server...");
 
   ws.onEvent(onWebSocketEvent);
@@ -279,25 +450,206 @@ void setupWebServer() {
 
   server.on("/reset", HTTP_POST, [](AsyncWebServerRequest *request) {
     DEBUG_PRINTLN("GPS reset requested via web");
-    resetGPS();
+    gpsScheduler.trigger(gpsResetJob); // The UART and the parser belong to the GPS task
     request->send(200, "text/plain", "GPS module reset command sent");
   });
 
+  server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+    sendMetricsResponse(request, renderMetricsFamily);
+  });
+
+  // What the TFT shows, for remote support
+  server.on("/screenshot.bmp", HTTP_GET, [](AsyncWebServerRequest *request) {
+    sendScreenshotResponse(request, SCREENSHOT_BMP);
+  });
+  server.on("/screenshot.png", HTTP_GET, [](AsyncWebServerRequest *request) {
+    sendScreenshotResponse(request, SCREENSHOT_PNG);
+  });
+
+  server.on("/api/profile", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (request->hasParam("reset")) {
+      profiler.reset(); // Each stage is cleared by its own task, from its next run
+    }
+
+    JsonDocument doc;
+    doc["enabled"] = PROFILER_ENABLED;
+    doc["cpuMHz"] = getCpuFrequencyMhz();
+    JsonArray stages = doc["stages"].to<JsonArray>();
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+      StageStats st = profiler.stats((ProfileStage)i);
+      JsonObject o = stages.add<JsonObject>();
+      o["name"] = PROFILE_STAGE_NAMES[i];
+      o["count"] = st.count;
+      o["minUs"] = st.minUs;
+      o["avgUs"] = st.avgUs;
+      o["p99Us"] = st.p99Us;
+      o["maxUs"] = st.maxUs;
+    }
+
+    String output;
+    serializeJson(doc, output);
+    request->send(200, "application/json", output);
+  });
+
+  server.on("/api/heap", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (request->hasParam("reset")) {
+      heapTracker.resetCounters(); // The loop counters at the end of the next loop()
+    }
+
+    uint32_t freeBytes = ESP.getFreeHeap();
+    uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    JsonDocument doc;
+    doc["free"] = freeBytes;
+    doc["largestBlock"] = largest;
+    doc["minFree"] = ESP.getMinFreeHeap();
+    doc["fragmentationPct"] = heapFragmentationPct(freeBytes, largest);
+    doc["psramFree"] = ESP.getFreePsram();
+    doc["psramLargestBlock"] = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+
+    doc["tracking"] = HEAP_TRACKING;
+    JsonObject loopAllocs = doc["loopAllocs"].to<JsonObject>();
+    loopAllocs["target"] = 0;
+    loopAllocs["last"] = heapTracker.lastLoopAllocs();
+    loopAllocs["max"] = heapTracker.maxLoopAllocs();
+    loopAllocs["loopsWithAllocs"] = heapTracker.loopsWithAllocs();
+    loopAllocs["loops"] = heapTracker.loops();
+    JsonArray stages = doc["stages"].to<JsonArray>();
+    for (uint8_t i = 0; i < HEAP_BUCKETS; i++) {
+      HeapBucketStats b = heapTracker.bucket(i);
+      JsonObject o = stages.add<JsonObject>();
+      o["name"] = heapBucketName(i);
+      o["allocs"] = b.allocs;
+      o["frees"] = b.frees;
+      o["bytes"] = b.bytes;
+    }
+
+    JsonArray history = doc["history"].to<JsonArray>();
+    for (size_t i = 0; i < heapTracker.historyCount(); i++) {
+      HeapSample s = heapTracker.historyAt(i);
+      JsonObject o = history.add<JsonObject>();
+      o["t"] = s.uptimeS;
+      o["free"] = s.freeBytes;
+      o["largestBlock"] = s.largestBlock;
+      o["fragmentationPct"] = heapFragmentationPct(s.freeBytes, s.largestBlock);
+    }
+
+    String output;
+    serializeJson(doc, output);
+    request->send(200, "application/json", output);
+  });
+
+  server.on("/api/latency", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (request->hasParam("reset")) {
+      gpsScheduler.trigger(latencyResetJob); // The tracker belongs to the GPS task
+    }
+
+    LatencyStatus status;
+    latencyStatus.read(&status);
+    JsonDocument doc;
+    const EpochTiming &e = status.lastEpoch;
+    JsonObject last = doc["lastEpoch"].to<JsonObject>();
+    last["epoch"] = e.epoch;
+    last["ppsUs"] = e.ppsUs;
+    last["firstByteUs"] = e.firstByteUs;
+    last["validatedUs"] = e.validatedUs;
+    last["publishedUs"] = e.publishedUs;
+    last["wsQueuedUs"] = e.wsQueuedUs;
+    last["tftFlushedUs"] = e.tftFlushedUs;
+    JsonArray hops = doc["hops"].to<JsonArray>();
+    for (uint8_t i = 0; i < HOP_COUNT; i++) {
+      const LatencyHistogram &h = status.hops[i];
+      JsonObject o = hops.add<JsonObject>();
+      o["name"] = LATENCY_HOP_NAMES[i];
+      o["count"] = h.count();
+      o["minUs"] = h.minUs();
+      o["avgUs"] = h.avgUs();
+      o["maxUs"] = h.maxUs();
+    }
+
+    String output;
+    serializeJson(doc, output);
+    request->send(200, "application/json", output);
+  });
+
+  server.on("/trace", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (request->hasParam("enable")) {
+      tracer.setEnabled(request->getParam("enable")->value() != "0");
+    }
+    char json[64];
+    snprintf(json, sizeof(json), "{\"enabled\":%s,\"recorded\":%lu}",
+             tracer.enabled() ? "true" : "false", (unsigned long)tracer.recorded());
+    request->send(200, "application/json", json);
+  });
+
+  server.on("/trace.json", HTTP_GET, [](AsyncWebServerRequest *request) {
+    tracer.sendJson(request);
+  });
+
+  server.on("/api/nmea", HTTP_GET, [](AsyncWebServerRequest *request) {
+    NmeaTcpServer::ClientStats stats[NMEA_TCP_MAX_CLIENTS];
+    size_t count = nmeaServer.getClientStats(stats, NMEA_TCP_MAX_CLIENTS);
+
+    JsonDocument doc;
+    doc["port"] = NMEA_TCP_PORT;
+    doc["bytesSent"] = nmeaServer.totalBytesSent();
+    doc["drops"] = nmeaServer.totalDrops();
+    JsonArray clients = doc["clients"].to<JsonArray>();
+    for (size_t i = 0; i < count; i++) {
+      JsonObject c = clients.add<JsonObject>();
+      c["id"] = stats[i].id;
+      c["ip"] = stats[i].ip.toString();
+      c["bytesSent"] = stats[i].bytesSent;
+      c["sentences"] = stats[i].sentencesSent;
+      c["drops"] = stats[i].drops;
+      c["connectedMs"] = stats[i].connectedMs;
+    }
+
+    String output;
+    serializeJson(doc, output);
+    request->send(200, "application/json", output);
+  });
+
+}
+
+// Network task, on each WiFi link change
+void startNetworkServices() {
   server.begin();
   DEBUG_PRINTLN("Web server started");
+
+  if (NMEA_TCP_ENABLED) {
+    nmeaServer.begin();
+  }
+  if (GPSD_ENABLED) {
+    gpsdServer.begin();
+  }
+  if (UDP_FIX_ENABLED) {
+    udpFixSender.begin();
+  }
   DEBUG_PRINT("Access at: http://");
   DEBUG_PRINTLN(ipAddress);
 }
 
+void stopNetworkServices() {
+  ws.closeAll();
+  server.end();
+  nmeaServer.end();
+  gpsdServer.end();
+  udpFixSender.end();
+  DEBUG_PRINTLN("Network services stopped");
+}
+
 // ============================================================================
 // WEBSOCKET EVENT HANDLER
 // ============================================================================
 void onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
                       AwsEventType type, void *arg, uint8_t *data, size_t len) {
+  TRACE_SCOPE(TRACE_WS_EVENT);
   if (type == WS_EVT_CONNECT) {
     DEBUG_PRINTF("WebSocket client #%u connected\n", client->id());
     connectedClients++;
-    client->text(getGPSJson());
+    GpsStatus status;
+    gpsStatus.read(&status);
+    client->text(getGPSJson(status));
   } else if (type == WS_EVT_DISCONNECT) {
     DEBUG_PRINTF("WebSocket client #%u disconnected\n", client->id());
     connectedClients--;
@@ -305,93 +657,196 @@ void onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
 }
 
 // ============================================================================
-// MAIN LOOP
+// MAIN LOOP (GPS TASK)
 // ============================================================================
+// Runs the GPS task's jobs (setupJobs), then sleeps until UART data, a
+// trigger from another task or the next deadline
 void loop() {
-  static unsigned long wifiConnectStart = millis();
+  uint32_t loopStart = micros();
+  {
+    PROFILE_STAGE(STAGE_LOOP);
+    gpsScheduler.runDue();
+  }
+  metrics.loopTime.record(micros() - loopStart);
+  heapTracker.onLoopEnd();
+
+  gpsScheduler.waitNext();
+}
+
+// ============================================================================
+// NETWORK TASK
+// ============================================================================
+// WiFi, WebSocket and MQTT jobs (setupJobs). The GPS task triggers
+// mqtt_epoch and ws_broadcast on each epoch, ws_broadcast on fix changes.
+void networkTask(void *arg) {
+  for (;;) {
+    networkScheduler.runDue();
+    networkScheduler.waitNext();
+  }
+}
+
+// --- Mise à jour WebSocket ---
+// Le serveur doit être initialisé et des clients connectés. Chaque époque
+// et chaque changement de fix sont envoyés tout de suite (déclenchés par la
+// tâche GPS) ; la période WEB_UPDATE_INTERVAL ne sert que sans époque.
+void broadcastWs() {
+  if (!webServerSetupDone || connectedClients == 0) return;
+  PROFILE_STAGE(STAGE_WEB);
+  TRACE_SCOPE(TRACE_WS_BROADCAST);
+  GpsStatus status;
+  gpsStatus.read(&status);
+  ws.textAll(getGPSJson(status));
+  wsQueuedStamp.write({status.fix.epoch, esp_timer_get_time()});
+  gpsScheduler.trigger(fixLatencyJob);
+  metrics.wsMessages++;
+}
+
 
-  // --- Gestion de la connexion WiFi (non-bloquant) ---
-  if (!wifiConnected) {
-    if (wifiMulti.run() == WL_CONNECTED) {
-      DEBUG_PRINTLN(">>> WiFi connection successful!");
+// --- Gestion de la connexion WiFi (wifi_manager.h) ---
+// Servers follow the link: started on each connection, stopped when it drops
+void updateWiFi() {
+  static bool everConnected = false;
+  PROFILE_STAGE(STAGE_WIFI);
+  switch (wifiManager.update()) {
+    case WIFI_LINK_UP:
+      TRACE_INSTANT(TRACE_WIFI_EVENT);
       wifiConnected = true;
       ipAddress = WiFi.localIP().toString();
-      DEBUG_PRINTLN("\nWiFi connected!");
       DEBUG_PRINT("IP address: "); DEBUG_PRINTLN(ipAddress);
       DEBUG_PRINT("Connected to: "); DEBUG_PRINTLN(WiFi.SSID());
-      drawInitScreen("Connected to:", WiFi.SSID(), "IP: " + ipAddress);
-      delay(2000); // Pause for 2 seconds as requested
-      setLedStatus(BLINKING, NEOPIXEL_COLOR_GREEN); // Start searching for GPS (green blinking)
-      playTone(BUZZER_FREQ_FIX, BUZZER_DURATION);
-    } else if (millis() - wifiConnectStart > WIFI_CONNECT_TIMEOUT) {
-      // Timeout de connexion
+      if (!everConnected) {
+        showInitScreen("Connected to:", WiFi.SSID(), "IP: " + ipAddress, 2000); // Held by the display task
+        everConnected = true;
+      }
+      if (!webServerSetupDone) {
+        setupWebServer();
+        webServerSetupDone = true;
+      }
+      startNetworkServices();
+      publishNetStatus();
+      statusLed.set(LED_BLINK, NEOPIXEL_COLOR_GREEN); // Start searching for GPS (green blinking)
+      buzzer.play(MELODY_WIFI_UP);
+      break;
+    case WIFI_LINK_DOWN:
+      TRACE_INSTANT(TRACE_WIFI_EVENT);
+      wifiConnected = false;
+      stopNetworkServices();
+      ipAddress = "Connecting...";
+      publishNetStatus();
+      statusLed.set(LED_BREATHE, NEOPIXEL_COLOR_BLUE);
+      break;
+    case WIFI_LINK_FAILED:
+      // Keeps retrying with backoff
+      TRACE_INSTANT(TRACE_WIFI_EVENT);
       ipAddress = "No WiFi";
-      DEBUG_PRINTLN("\nWiFi connection failed (timeout)!");
-      setLedStatus(SOLID, NEOPIXEL_COLOR_RED); // Error state
-      playTone(BUZZER_FREQ_LOST, BUZZER_DURATION * 2);
-      wifiConnectStart = millis(); // Évite de retenter immédiatement
-    }
-  }
-
-  // --- Initialisation du serveur web (une fois le WiFi connecté) ---
-  if (wifiConnected && !webServerSetupDone) {
-    DEBUG_PRINTLN(">>> WiFi is connected, proceeding to web server setup...");
-    setupWebServer();
-    webServerSetupDone = true;
+      DEBUG_PRINTLN("WiFi connection failed, retrying in the background");
+      publishNetStatus();
+      statusLed.set(LED_SOLID, NEOPIXEL_COLOR_RED); // Error state
+      buzzer.play(MELODY_WIFI_FAILED);
+      break;
+    case WIFI_LINK_UNCHANGED:
+      break;
   }
+}
 
-  // --- Tâches principales ---
-  handleButton();
-  updateGPS();
-  updateLed();
-  updateDisplay();
+// Header contents for the display task
+void publishNetStatus() {
+  NetStatus net = {};
+  net.wifiConnected = wifiConnected;
+  strlcpy(net.ip, ipAddress.c_str(), sizeof(net.ip));
+  netStatus.write(net);
+  requestDisplayRefresh();
+}
 
-  // --- Mise à jour WebSocket ---
-  // Le serveur doit être initialisé et des clients connectés
-  if (webServerSetupDone && connectedClients > 0) {
-    static unsigned long lastWebUpdate = 0;
-    if (millis() - lastWebUpdate > WEB_UPDATE_INTERVAL) {
-      ws.textAll(getGPSJson());
-      lastWebUpdate = millis();
+// ============================================================================
+// UI TASK
+// ============================================================================
+// Button gestures, woken by the button ISRs (the LED and buzzer run from
+// timers, see status_led.h and buzzer.h)
+void uiTask(void *arg) {
+  for (;;) {
+    ButtonEvent event;
+    if (buttonInput.wait(&event, UINT32_MAX)) {
+      handleButtonEvent(event);
     }
   }
-
-  if (webServerSetupDone) {
-    ws.cleanupClients();
-  }
 }
 
 // ============================================================================
-// BUTTON HANDLER
+// BUTTON ACTIONS
 // ============================================================================
-void handleButton() {
-  bool button1State = digitalRead(PIN_BUTTON_1);
-
-  if (button1State == LOW && lastButton1State == HIGH) {
-    if (millis() - lastButton1Press > BUTTON_DEBOUNCE_MS) {
-      currentPage++;
-      if (currentPage >= NUM_PAGES) {
-        currentPage = 0;
+//   button 1: short = next page, double = first page, long = track recording on/off
+//   button 2: short = previous page, double = first page, long = TTFF test (cold start)
+//   both:     buzzer mute on/off
+void handleButtonEvent(const ButtonEvent &event) {
+  PROFILE_STAGE(STAGE_BUTTON);
+  DEBUG_PRINTF("Button %u gesture %u, %lu us after the press\n", event.button + 1, event.gesture,
+               (unsigned long)(esp_timer_get_time() - event.pressUs));
+  DisplayEvent page = {};
+  switch (event.gesture) {
+    case GESTURE_SHORT:
+      page.type = event.button == BUTTON_1 ? DISPLAY_EVENT_NEXT_PAGE : DISPLAY_EVENT_PREV_PAGE;
+      xQueueSend(displayEventQueue, &page, 0);
+      buzzer.play(MELODY_PAGE_CHANGE);
+      break;
+    case GESTURE_DOUBLE:
+      page.type = DISPLAY_EVENT_FIRST_PAGE;
+      xQueueSend(displayEventQueue, &page, 0);
+      buzzer.play(MELODY_PAGE_CHANGE);
+      break;
+    case GESTURE_LONG:
+      if (event.button == BUTTON_1) {
+        bool recording = !trackRecording;
+        if (recording) trackHistory.clear(); // A new recording starts a new track
+        trackRecording = recording;
+        DEBUG_PRINTLN(recording ? "Track recording started" : "Track recording stopped");
+        buzzer.play(recording ? MELODY_TOGGLE_ON : MELODY_TOGGLE_OFF);
+        requestDisplayRefresh();
+      } else {
+        gpsScheduler.trigger(ttffTestJob);
+        buzzer.play(MELODY_TOGGLE_ON);
       }
-      DEBUG_PRINTF("Page changed to: %d\n", currentPage);
-      lastDisplayUpdate = 0;
-      playTone(2000, 50);
-    }
-    lastButton1Press = millis();
+      break;
+    case GESTURE_CHORD:
+      if (buzzer.muted()) {
+        buzzer.setMuted(false);
+        buzzer.play(MELODY_TOGGLE_ON);
+      } else {
+        buzzer.play(MELODY_TOGGLE_OFF); // Last sound before muting
+        buzzer.setMuted(true);
+      }
+      break;
   }
-
-  lastButton1State = button1State;
 }
 
 // ============================================================================
 // GPS UPDATE
 // ============================================================================
 void updateGPS() {
+  PROFILE_STAGE(STAGE_GPS);
+  int64_t wokenUs = gpsRxWakeUs.exchange(0);
+  if (wokenUs != 0) {
+    gpsWakeTime[gpsRxWakeFlush.load(std::memory_order_relaxed)].record(esp_timer_get_time() - wokenUs);
+  }
+  if (gpsSerial.available() > 0) {
+    fixLatency.onUartData(esp_timer_get_time());
+  }
   while (gpsSerial.available() > 0) {
     char c = gpsSerial.read();
+    metrics.uartBytes++;
+
+    // Keep a copy of the raw sentence for the NMEA outputs
+    if (c == '$') nmeaLineLen = 0;
+    if (c != '\r' && c != '\n' && nmeaLineLen < NMEA_MAX_SENTENCE) {
+      nmeaLine[nmeaLineLen++] = c;
+    }
+
     if (gps.encode(c)) {
       validSentences++;
       lastGPSData = millis();
+      fixLatency.onSentenceValid(esp_timer_get_time());
+      onNmeaSentence(nmeaLine, nmeaLineLen);
+      nmeaLineLen = 0;
     }
   }
 
@@ -403,458 +858,1100 @@ void updateGPS() {
   // --- Gestion de l'état de la LED en fonction du GPS ---
   if (wifiConnected && millis() - lastGPSData > GPS_TIMEOUT && lastGPSData != 0) {
     // Erreur : Aucune donnée GPS reçue depuis un certain temps
-    setLedStatus(SOLID, NEOPIXEL_COLOR_RED);
+    statusLed.set(LED_ALTERNATE, NEOPIXEL_COLOR_RED, NEOPIXEL_COLOR_BLUE);
     if (previousFixStatus) { // Si on vient de perdre le fix à cause du timeout
       DEBUG_PRINTLN("GPS FIX LOST (Timeout)!");
-      if (BUZZER_ENABLED) playTone(BUZZER_FREQ_LOST, BUZZER_DURATION * 2);
-      ws.textAll(getGPSJson());
+      TRACE_INSTANT(TRACE_FIX_CHANGE);
+      buzzer.play(MELODY_FIX_LOST);
+      networkScheduler.trigger(wsBroadcastJob);
     }
   } else if (currentFixStatus) {
     // Fix GPS acquis et valide
-    setLedStatus(SOLID, NEOPIXEL_COLOR_GREEN);
+    statusLed.set(LED_SOLID, NEOPIXEL_COLOR_GREEN);
     if (!previousFixStatus) {
       DEBUG_PRINTLN("GPS FIX ACQUIRED!");
+      TRACE_INSTANT(TRACE_FIX_CHANGE);
       gpsFixAcquiredTime = millis();
-      if (BUZZER_ENABLED) playTone(BUZZER_FREQ_FIX, BUZZER_DURATION);
-      ws.textAll(getGPSJson());
+      publishDisplayState();
+      buzzer.play(MELODY_FIX_ACQUIRED);
+      networkScheduler.trigger(wsBroadcastJob);
     }
   } else {
     // Pas de fix, en recherche (si le WiFi est connecté)
-    if (wifiConnected) setLedStatus(BLINKING, NEOPIXEL_COLOR_GREEN);
+    if (wifiConnected) statusLed.set(LED_BLINK, NEOPIXEL_COLOR_GREEN);
     if (previousFixStatus) {
       DEBUG_PRINTLN("GPS FIX LOST!");
-      if (BUZZER_ENABLED) {
-        playTone(BUZZER_FREQ_LOST, BUZZER_DURATION * 2);
-      }
-      ws.textAll(getGPSJson()); // Send immediate update on fix lost
+      TRACE_INSTANT(TRACE_FIX_CHANGE);
+      buzzer.play(MELODY_FIX_LOST);
+      networkScheduler.trigger(wsBroadcastJob); // Send immediate update on fix lost
     }
   }
   previousFixStatus = currentFixStatus;
+
+  // TTFF test: the first position computed after the cold start
+  if (ttffStartMs != 0 && gps.location.isValid() && gps.location.age() < millis() - ttffStartMs) {
+    ttffMs = millis() - ttffStartMs - gps.location.age();
+    ttffStartMs = 0;
+    DEBUG_PRINTF("TTFF: %lu ms\n", (unsigned long)ttffMs);
+    publishGpsStatus();
+    publishDisplayState();
+  }
+}
+
+// ============================================================================
+// RAW NMEA OUTPUT
+// ============================================================================
+// Called for every checksum-valid sentence ("$...*hh", without CR/LF)
+void onNmeaSentence(const char *sentence, size_t len) {
+  if (len == 0 || sentence[0] != '$') return;
+  metrics.sentences[nmeaSentenceType(sentence, len)]++;
+  nmeaServer.broadcast(sentence, len);
+  gpsdServer.forwardNmea(sentence, len);
+  satTable.onSentence(sentence, len);
+  trackEpoch(sentence, len);
+}
+
+// ============================================================================
+// EPOCH SNAPSHOT
+// ============================================================================
+// An epoch is complete once both GGA and RMC have been received. If a module
+// only sends one of them, the epoch is closed when that sentence repeats.
+void trackEpoch(const char *sentence, size_t len) {
+  if (len < 6) return;
+  const char *type = sentence + 3; // Skip "$" and the talker ID
+  bool isGGA = strncmp(type, "GGA", 3) == 0;
+  bool isRMC = strncmp(type, "RMC", 3) == 0;
+  if (!isGGA && !isRMC) return;
+
+  if ((isGGA && epochHasGGA) || (isRMC && epochHasRMC)) {
+    publishSnapshot();
+    epochHasGGA = false;
+    epochHasRMC = false;
+  }
+  epochHasGGA |= isGGA;
+  epochHasRMC |= isRMC;
+
+  if (epochHasGGA && epochHasRMC) {
+    publishSnapshot();
+    epochHasGGA = false;
+    epochHasRMC = false;
+  }
+}
+
+void publishSnapshot() {
+  TRACE_SCOPE(TRACE_EPOCH);
+  GpsSnapshot &s = gpsSnapshot;
+  s.epoch++;
+  s.publishedMs = millis();
+  int64_t ppsUs = ppsLastEdgeUs.load(std::memory_order_relaxed); // One edge for all the outputs
+
+  s.locationValid = gps.location.isValid();
+  // Raw degrees, not lat()/lng(): no software double math per epoch
+  const RawDegrees &rawLat = gps.location.rawLat();
+  const RawDegrees &rawLng = gps.location.rawLng();
+  s.latE7 = coordE7FromRaw(rawLat.deg, rawLat.billionths, rawLat.negative);
+  s.lngE7 = coordE7FromRaw(rawLng.deg, rawLng.billionths, rawLng.negative);
+  s.locationAgeMs = gps.location.age();
+
+  s.altitudeValid = gps.altitude.isValid();
+  s.altitudeM = gps.altitude.meters();
+  s.speedValid = gps.speed.isValid();
+  s.speedKmph = gps.speed.kmph();
+  s.courseValid = gps.course.isValid();
+  s.courseDeg = gps.course.deg();
+  s.hdopValid = gps.hdop.isValid();
+  s.hdop = gps.hdop.hdop();
+  s.satellites = gps.satellites.value();
+
+  s.dateValid = gps.date.isValid();
+  s.year = gps.date.year();
+  s.month = gps.date.month();
+  s.day = gps.date.day();
+  s.timeValid = gps.time.isValid();
+  s.hour = gps.time.hour();
+  s.minute = gps.time.minute();
+  s.second = gps.time.second();
+  s.centisecond = gps.time.centisecond();
+
+  SkyView sky;
+  satTable.view(&sky);
+  gpsdServer.publish(s, sky);
+  if (UDP_FIX_ENABLED && wifiConnected) {
+    udpFixSender.send(s, esp_timer_get_time(), ppsUs);
+  }
+  if (snapshotHasFix(s) && trackRecording) {
+    trackHistory.add(s.latE7, s.lngE7);
+  }
+  drErrors.onSnapshot(s);
+  fixLatency.onPublished(s.epoch, esp_timer_get_time(), ppsUs);
+  publishLatencyStatus();
+  publishGpsStatus();
+  // Now rather than at the next broadcast period: publish_ws times the pipeline
+  networkScheduler.trigger(wsBroadcastJob);
+  if (MQTT_ENABLED) {
+    mqttPublisher.queueEpoch(s); // Every epoch, batched by the network task
+    networkScheduler.trigger(mqttEpochJob);
+  }
+  publishDisplayState();
+}
+
+// Copy of the GPS task's state for the network task and the AsyncTCP callbacks
+void publishGpsStatus() {
+  GpsStatus status;
+  status.fix = gpsSnapshot;
+  status.validSentences = validSentences;
+  status.failedChecksums = failedChecksums;
+  status.totalSentences = totalSentences;
+  status.charsProcessed = gps.charsProcessed();
+  status.satellitesInView = satTable.count();
+  status.drChecks = drErrors.count();
+  status.drMaxErrorCm = drErrors.maxErrorCm();
+  status.drErrorSumCm = drErrors.sumErrorCm();
+  status.drHoldSumCm = drErrors.sumHoldErrorCm();
+  status.ttffMs = ttffMs;
+  gpsStatus.write(status);
+}
+
+// Same for the fix latency tracker, after each change to it
+void publishLatencyStatus() {
+  static LatencyStatus status; // GPS task only, kept off its stack
+  status.lastEpoch = fixLatency.lastEpoch();
+  for (uint8_t i = 0; i < HOP_COUNT; i++) {
+    status.hops[i] = fixLatency.hop((LatencyHop)i);
+  }
+  latencyStatus.write(status);
+}
+
+// ============================================================================
+// PROMETHEUS METRICS
+// ============================================================================
+// One metric family group per index, rendered on demand by /metrics (on the
+// AsyncTCP task: GPS state comes from the gpsStatus seqlock)
+bool renderMetricsFamily(MetricsWriter &w, uint8_t index) {
+  GpsStatus status;
+  if (index == 1 || index == 6) {
+    gpsStatus.read(&status);
+  }
+  switch (index) {
+    case 0:
+      w.gauge("gps_tester_heap_free_bytes", "Free internal heap", ESP.getFreeHeap());
+      w.gauge("gps_tester_heap_min_free_bytes", "Lowest free internal heap since boot", ESP.getMinFreeHeap());
+      w.gauge("gps_tester_heap_largest_block_bytes", "Largest free internal heap block",
+              heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+      w.gauge("gps_tester_heap_fragmentation_ratio", "1 - largest block / free internal heap",
+              heapFragmentationPct(ESP.getFreeHeap(),
+                                   heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)) / 100.0);
+      w.gauge("gps_tester_psram_free_bytes", "Free PSRAM", ESP.getFreePsram());
+      w.gauge("gps_tester_psram_largest_block_bytes", "Largest free PSRAM block",
+              heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+      return true;
+    case 1:
+      w.counter("gps_tester_uart_bytes_total", "Bytes read from the GPS UART", metrics.uartBytes);
+      w.counter("gps_tester_uart_errors_total", "GPS UART receive errors", metrics.uartErrors);
+      w.counter("gps_tester_nmea_valid_total", "Checksum-valid NMEA sentences", status.validSentences);
+      w.counter("gps_tester_nmea_checksum_failures_total", "NMEA sentences with a bad checksum", status.failedChecksums);
+      return true;
+    case 2: {
+      w.header("gps_tester_nmea_sentences_total", "Valid NMEA sentences by type", "counter");
+      char labels[16];
+      for (uint8_t i = 0; i < NMEA_TYPE_COUNT; i++) {
+        snprintf(labels, sizeof(labels), "type=\"%s\"", NMEA_TYPE_NAMES[i]);
+        w.sample("gps_tester_nmea_sentences_total", labels, (uint64_t)metrics.sentences[i]);
+      }
+      return true;
+    }
+    case 3:
+      w.histogram("gps_tester_loop_duration_seconds", "Duration of one loop() iteration", metrics.loopTime);
+      return true;
+    case 4:
+      w.histogram("gps_tester_display_frame_seconds", "Duration of a TFT page redraw", metrics.displayFrame);
+      w.gauge("gps_tester_display_frame_pixels", "Pixels written to the TFT by the last redraw", metrics.displayFramePixels);
+      w.counter("gps_tester_display_pixels_total", "Pixels written to the TFT", widgetStats.pixels);
+      w.counter("gps_tester_text_cache_hits_total", "Text drawn from the pre-rasterized cache", textCache.hits());
+      w.counter("gps_tester_text_cache_misses_total", "Text rasterized into the cache", textCache.misses());
+      w.gauge("gps_tester_text_cache_bytes", "PSRAM used by cached text", textCache.bytes());
+      return true;
+    case 5: {
+      // The slowest client's backlog, growing long before its queue is full
+      size_t wsQueued = 0;
+      for (const AsyncWebSocketClient &client : ws.getClients()) {
+        wsQueued = max(wsQueued, client.queueLen());
+      }
+      w.gauge("gps_tester_ws_clients", "Connected WebSocket clients", ws.count());
+      w.gauge("gps_tester_ws_queue_length", "Messages waiting in the longest WebSocket client send queue", wsQueued);
+      w.gauge("gps_tester_ws_queue_full", "1 if a WebSocket client send queue is full", ws.availableForWriteAll() ? 0 : 1);
+      w.counter("gps_tester_ws_messages_total", "WebSocket broadcasts", metrics.wsMessages);
+      w.gauge("gps_tester_nmea_tcp_clients", "Connected NMEA TCP clients", nmeaServer.clientCount());
+      w.counter("gps_tester_nmea_tcp_bytes_total", "Bytes sent to NMEA TCP clients", nmeaServer.totalBytesSent());
+      w.counter("gps_tester_nmea_tcp_drops_total", "Sentences dropped for slow NMEA TCP clients", nmeaServer.totalDrops());
+      w.gauge("gps_tester_gpsd_clients", "Connected gpsd clients", gpsdServer.clientCount());
+      return true;
+    }
+    case 6: {
+      const GpsSnapshot &fix = status.fix;
+      unsigned long age = snapshotLocationAge(fix);
+      w.gauge("gps_tester_fix", "1 if the GPS has a valid fix", snapshotHasFix(fix) ? 1 : 0);
+      w.gauge("gps_tester_fix_age_seconds", "Age of the last position", age == ULONG_MAX ? NAN : age / 1000.0);
+      w.gauge("gps_tester_satellites", "Satellites used in fix", fix.satellites);
+      w.gauge("gps_tester_satellites_in_view", "Satellites reported by GSV", status.satellitesInView);
+      w.counter("gps_tester_epochs_total", "Published GPS epochs", fix.epoch);
+      w.counter("gps_tester_dr_checks_total", "Fixes compared with the dead-reckoned prediction", status.drChecks);
+      w.counter("gps_tester_dr_error_centimeters_total", "Distance between predictions and the next fix",
+                status.drErrorSumCm);
+      w.counter("gps_tester_dr_hold_error_centimeters_total", "Distance between the previous and the next fix",
+                status.drHoldSumCm);
+      w.gauge("gps_tester_dr_error_max_meters", "Worst dead-reckoning error", status.drMaxErrorCm / 100.0);
+      w.gauge("gps_tester_ttff_seconds", "Time to first fix of the last TTFF test",
+              status.ttffMs != 0 ? status.ttffMs / 1000.0 : NAN);
+      w.counter("gps_tester_uptime_seconds_total", "Seconds since boot", millis() / 1000);
+      return true;
+    }
+    case 7:
+      w.histogram("gps_tester_display_flush_seconds", "Duration of a framebuffer flush to the TFT",
+                  frameBuffer.flushTime());
+      w.counter("gps_tester_display_flushed_pixels_total", "Pixels sent to the TFT by the framebuffer",
+                frameBuffer.pixelsFlushed());
+      // GPS task wake-ups during flushes on its core, worst case per flush state
+      w.header("gps_tester_gps_wake_max_seconds", "Longest GPS task wake-up, by framebuffer flush", "gauge");
+      for (uint8_t s = 0; s < FLUSH_STATE_COUNT; s++) {
+        char labels[24];
+        snprintf(labels, sizeof(labels), "flush=\"%s\"", FLUSH_STATE_NAMES[s]);
+        w.sample("gps_tester_gps_wake_max_seconds", labels, gpsWakeTime[s].maxUs() / 1e6);
+      }
+      return true;
+    case 8:
+      w.gauge("gps_tester_wifi_connected", "1 while the WiFi link is up", wifiConnected ? 1 : 0);
+      w.gauge("gps_tester_wifi_rssi_dbm", "Signal strength of the current access point",
+              wifiConnected ? (double)WiFi.RSSI() : NAN);
+      w.counter("gps_tester_wifi_connects_total", "WiFi connections (boot, reconnects and roams)", wifiManager.connects());
+      w.counter("gps_tester_wifi_failed_attempts_total", "WiFi scans or connections that failed", wifiManager.failedAttempts());
+      w.counter("gps_tester_wifi_roams_total", "Moves to a stronger access point", wifiManager.roams());
+      w.gauge("gps_tester_wifi_connect_seconds", "Scan start to IP address, last connection",
+              wifiManager.lastConnectMs() / 1000.0);
+      w.header("gps_tester_wifi_connect_seconds_total", "Scan start to IP address, all connections", "counter");
+      w.sample("gps_tester_wifi_connect_seconds_total", nullptr, wifiManager.connectMsSum() / 1000.0);
+      w.counter("gps_tester_wifi_outages_total", "WiFi link drops that were recovered", wifiManager.outages());
+      w.header("gps_tester_wifi_outage_seconds_total", "Time without WiFi after a drop", "counter");
+      w.sample("gps_tester_wifi_outage_seconds_total", nullptr, wifiManager.outageMsSum() / 1000.0);
+      w.gauge("gps_tester_wifi_outage_max_seconds", "Longest recovered WiFi outage", wifiManager.maxOutageMs() / 1000.0);
+      return true;
+    case 9:
+      w.counter("gps_tester_buzzer_melodies_total", "Buzzer melodies started", buzzer.played());
+      w.counter("gps_tester_buzzer_preempted_total", "Buzzer melodies cut short by a higher priority one",
+                buzzer.preempted());
+      w.counter("gps_tester_buzzer_dropped_total", "Buzzer melodies dropped (queue full or lower priority)",
+                buzzer.dropped());
+      w.counter("gps_tester_led_writes_total", "Frames sent to the status NeoPixel", statusLed.writes());
+      w.counter("gps_tester_metrics_truncated_families_total", "/metrics families dropped for not fitting their buffer",
+                metrics.truncatedFamilies);
+      return true;
+    case 10:
+      w.histogram("gps_tester_button_edge_latency_seconds", "Button interrupt to UI task delay",
+                  buttonInput.edgeLatency());
+      w.counter("gps_tester_button_edges_dropped_total", "Button edges lost to a full queue",
+                buttonInput.droppedEdges());
+      return true;
+    case 11: {
+      w.header("gps_tester_task_idle_seconds_total", "Time a task slept waiting for its next job", "counter");
+      char labels[24];
+      for (const Scheduler *sched : {&gpsScheduler, &networkScheduler}) {
+        snprintf(labels, sizeof(labels), "task=\"%s\"", sched->taskName());
+        w.sample("gps_tester_task_idle_seconds_total", labels, sched->idleUs() / 1e6);
+      }
+      w.header("gps_tester_task_wakeups_total", "Times a task woke up to run its jobs", "counter");
+      for (const Scheduler *sched : {&gpsScheduler, &networkScheduler}) {
+        snprintf(labels, sizeof(labels), "task=\"%s\"", sched->taskName());
+        w.sample("gps_tester_task_wakeups_total", labels, (uint64_t)sched->wakeups());
+      }
+      return true;
+    }
+    // Scheduled jobs: one metric per family, there are up to 2 x SCHEDULER_MAX_JOBS samples
+    case 12:
+      jobSamples(w, "gps_tester_job_runs_total", "Scheduled job runs", "counter",
+                 [](const JobStats &s) -> uint64_t { return s.runs; });
+      return true;
+    case 13:
+      jobSamples(w, "gps_tester_job_overruns_total", "Periodic job runs that missed at least one period", "counter",
+                 [](const JobStats &s) -> uint64_t { return s.overruns; });
+      return true;
+    case 14:
+      jobSamples(w, "gps_tester_job_run_seconds_total", "Time spent running a scheduled job", "counter",
+                 [](const JobStats &s) -> uint64_t { return s.busyUs; }, true);
+      return true;
+    case 15:
+      jobSamples(w, "gps_tester_job_run_max_seconds", "Longest run of a scheduled job", "gauge",
+                 [](const JobStats &s) -> uint64_t { return s.maxRunUs; }, true);
+      return true;
+    case 16:
+      jobSamples(w, "gps_tester_job_late_max_seconds", "Latest start of a periodic job after its deadline", "gauge",
+                 [](const JobStats &s) -> uint64_t { return s.maxLateUs; }, true);
+      return true;
+    case 17:
+      // GPS ingest against the flush on its core (its maxima are in family 7)
+      w.header("gps_tester_gps_wake_seconds", "UART data to the GPS task reading it, by framebuffer flush",
+               "histogram");
+      for (uint8_t s = 0; s < FLUSH_STATE_COUNT; s++) {
+        char labels[24];
+        snprintf(labels, sizeof(labels), "flush=\"%s\"", FLUSH_STATE_NAMES[s]);
+        w.histogramSamples("gps_tester_gps_wake_seconds", labels, gpsWakeTime[s]);
+      }
+      return true;
+    default: {
+      // One fix latency series per family call, they don't fit together
+      uint8_t hop = index - 18;
+      if (hop >= HOP_COUNT) return false;
+      if (hop == 0) {
+        w.header("gps_tester_fix_latency_seconds", "Fix latency per pipeline hop", "histogram");
+      }
+      LatencyStatus status;
+      latencyStatus.read(&status);
+      char labels[24];
+      snprintf(labels, sizeof(labels), "hop=\"%s\"", LATENCY_HOP_NAMES[hop]);
+      w.histogramSamples("gps_tester_fix_latency_seconds", labels, status.hops[hop]);
+      return true;
+    }
+  }
+}
+
+// One sample per job of both schedulers
+void jobSamples(MetricsWriter &w, const char *name, const char *help, const char *type,
+                uint64_t (*value)(const JobStats &s), bool microseconds) {
+  w.header(name, help, type);
+  char labels[48];
+  for (const Scheduler *sched : {&gpsScheduler, &networkScheduler}) {
+    for (JobId job = 0; job < sched->jobCount(); job++) {
+      const JobStats &s = sched->stats(job);
+      snprintf(labels, sizeof(labels), "task=\"%s\",job=\"%s\"", sched->taskName(), s.name);
+      if (microseconds) {
+        w.sample(name, labels, value(s) / 1e6);
+      } else {
+        w.sample(name, labels, value(s));
+      }
+    }
+  }
+}
+
+// ============================================================================
+// MQTT STATISTICS
+// ============================================================================
+void publishMqttStats() {
+  GpsStatus status;
+  gpsStatus.read(&status);
+  char json[384];
+  size_t len = snprintf(json, sizeof(json),
+      "{\"uptime\":%lu,\"validSentences\":%lu,\"failedChecksums\":%lu,\"totalChars\":%lu,"
+      "\"heapFree\":%lu,\"psramFree\":%lu,\"mqttQueued\":%u,\"mqttDropped\":%lu,\"mqttDroppedEpochs\":%lu,"
+      "\"nmeaClients\":%u,\"gpsdClients\":%u,\"wsClients\":%d}",
+      millis() / 1000, (unsigned long)status.validSentences, (unsigned long)status.failedChecksums,
+      (unsigned long)status.charsProcessed, (unsigned long)ESP.getFreeHeap(),
+      (unsigned long)ESP.getFreePsram(), (unsigned)mqttPublisher.queuedBatches(),
+      (unsigned long)mqttPublisher.droppedBatches(), (unsigned long)mqttPublisher.droppedEpochs(),
+      (unsigned)nmeaServer.clientCount(),
+      (unsigned)gpsdServer.clientCount(), connectedClients.load());
+  if (len < sizeof(json)) {
+    mqttPublisher.publishStats(json, len);
+  }
+}
+
+// ============================================================================
+// PPS INTERRUPT
+// ============================================================================
+void IRAM_ATTR onPpsEdge() {
+  ppsLastEdgeUs.store(esp_timer_get_time(), std::memory_order_relaxed);
+  ppsEdgeCount++;
 }
 
 // ============================================================================
 // DISPLAY UPDATE
 // ============================================================================
+// GPS task side of the display: frames are drawn by displayTask(), only the
+// fix latency bookkeeping for frames that reached the panel happens here.
 void updateDisplay() {
-  if (millis() - lastDisplayUpdate < GPS_UPDATE_RATE) {
-    return;
+  uint32_t flushedEpoch;
+  int64_t flushedUs;
+  if (takeFlushedFrame(&flushedEpoch, &flushedUs)) {
+    fixLatency.onTftFlushed(flushedEpoch, flushedUs);
+  }
+}
+
+// Same for the WebSocket frames queued by the network task
+void updateWsLatency() {
+  static uint32_t seen = 0;
+  WsQueuedStamp stamp;
+  uint32_t seq = wsQueuedStamp.read(&stamp);
+  if (seq != seen) {
+    seen = seq;
+    fixLatency.onWsQueued(stamp.epoch, stamp.queuedUs);
+  }
+}
+
+// Copies what the pages show into the display task's mailbox (GPS task)
+void publishDisplayState() {
+  if (displayStateQueue == nullptr) return;
+  DisplayState state;
+  state.fix = gpsSnapshot;
+  state.validSentences = validSentences;
+  state.failedChecksums = failedChecksums;
+  state.totalSentences = totalSentences;
+  state.fixAcquiredMs = gpsFixAcquiredTime;
+  state.ttffStartMs = ttffStartMs;
+  state.ttffMs = ttffMs;
+  satTable.view(&state.sky);
+  state.drChecks = drErrors.count();
+  state.drAvgErrorCm = drErrors.avgErrorCm();
+  state.drAvgHoldCm = drErrors.avgHoldErrorCm();
+  xQueueOverwrite(displayStateQueue, &state);
+  requestDisplayRefresh();
+}
+
+// Any task: redraw with the latest DisplayState and netStatus
+void requestDisplayRefresh() {
+  if (displayEventQueue == nullptr) return;
+  DisplayEvent refresh = {};
+  refresh.type = DISPLAY_EVENT_REFRESH;
+  xQueueSend(displayEventQueue, &refresh, 0); // A full queue already holds a wakeup
+}
+
+bool takeFlushedFrame(uint32_t *epoch, int64_t *flushedUs) {
+  if (frameBuffer.takeFlushed(epoch, flushedUs)) return true;
+  if (!directFrameFlushed.load(std::memory_order_acquire)) return false;
+  *epoch = directFlushedEpoch;
+  *flushedUs = directFlushedUs;
+  directFrameFlushed.store(false, std::memory_order_relaxed);
+  return true;
+}
+
+// ============================================================================
+// DISPLAY TASK
+// ============================================================================
+// Redraws on each published state or page change, at most every
+// DISPLAY_MIN_FRAME_MS, and every GPS_UPDATE_RATE otherwise (clocks, ages).
+// While the GPS page shows a dead-reckoned position it redraws at
+// DR_DISPLAY_RATE_HZ instead.
+void displayTask(void *arg) {
+  DisplayState state = {};
+  unsigned long lastFrame = 0;
+  unsigned long splashUntil = 0;
+
+  for (;;) {
+    uint32_t waitMs = GPS_UPDATE_RATE;
+    DrPrediction dr;
+    if (currentPage == PAGE_GPS_DATA && drPredictNow(state.fix, &dr) && dr.horizonMs < DR_MAX_HORIZON_MS) {
+      waitMs = 1000 / DR_DISPLAY_RATE_HZ;
+    }
+    long splashLeft = (long)(splashUntil - millis());
+    if (splashLeft > 0 && (uint32_t)splashLeft < waitMs) waitMs = splashLeft;
+
+    DisplayEvent event;
+    bool gotEvent = xQueueReceive(displayEventQueue, &event, pdMS_TO_TICKS(waitMs)) == pdTRUE;
+
+    // Events arriving faster than the frame budget are coalesced
+    unsigned long sinceFrame = millis() - lastFrame;
+    if (gotEvent && sinceFrame < DISPLAY_MIN_FRAME_MS) {
+      vTaskDelay(pdMS_TO_TICKS(DISPLAY_MIN_FRAME_MS - sinceFrame));
+    }
+    while (gotEvent) {
+      handleDisplayEvent(event, &splashUntil);
+      gotEvent = xQueueReceive(displayEventQueue, &event, 0) == pdTRUE;
+    }
+
+    if ((long)(splashUntil - millis()) > 0) continue;
+    if (xQueuePeek(displayStateQueue, &state, 0) != pdTRUE) continue;
+    renderFrame(state);
+    lastFrame = millis();
+  }
+}
+
+void handleDisplayEvent(const DisplayEvent &event, unsigned long *splashUntil) {
+  switch (event.type) {
+    case DISPLAY_EVENT_NEXT_PAGE:
+      currentPage++;
+      if (currentPage >= NUM_PAGES) {
+        currentPage = 0;
+      }
+      DEBUG_PRINTF("Page changed to: %d\n", currentPage);
+      break;
+    case DISPLAY_EVENT_PREV_PAGE:
+      currentPage = currentPage == 0 ? NUM_PAGES - 1 : currentPage - 1;
+      DEBUG_PRINTF("Page changed to: %d\n", currentPage);
+      break;
+    case DISPLAY_EVENT_FIRST_PAGE:
+      currentPage = PAGE_GPS_DATA;
+      break;
+    case DISPLAY_EVENT_SPLASH:
+      drawInitScreen(event);
+      *splashUntil = millis() + event.holdMs;
+      break;
+    case DISPLAY_EVENT_REFRESH:
+      break;
   }
+}
 
-  lastDisplayUpdate = millis();
+// Widgets only redraw what changed; the screen is cleared once after the
+// splash screen and on page changes.
+void renderFrame(const DisplayState &state) {
+  PROFILE_STAGE(STAGE_DISPLAY);
+  uint32_t frameStart = micros();
+  uint32_t pixelsBefore = widgetStats.pixels;
+
+  static uint8_t drawnPage = 0xFF;
+  if (displayNeedsClear || drawnPage != currentPage) {
+    gfx.fillRect(0, 0, TFT_WIDTH, TFT_HEADER_HEIGHT, TFT_COLOR_HEADER);
+    gfx.drawFastHLine(0, TFT_HEADER_HEIGHT, TFT_WIDTH, TFT_COLOR_SEPARATOR);
+    gfx.fillRect(0, TFT_PAGE_START_Y, TFT_WIDTH, TFT_HEIGHT - TFT_PAGE_START_Y, TFT_COLOR_BG);
+    widgetStats.pixels += TFT_WIDTH * TFT_HEIGHT;
+    invalidateWidgets();
+    displayNeedsClear = false;
+    drawnPage = currentPage;
+  }
 
-  drawHeader();
+  drawHeader(state);
 
   switch (currentPage) {
     case PAGE_GPS_DATA:
-      drawPageGPSData();
+      drawPageGPSData(state);
       break;
     case PAGE_DIAGNOSTICS:
-      drawPageDiagnostics();
+      drawPageDiagnostics(state);
       break;
     case PAGE_SATELLITES:
-      drawPageSatellites();
+      drawPageSatellites(state);
+      break;
+    case PAGE_SKY:
+      drawPageSky(state);
       break;
+    case PAGE_MAP:
+      drawPageMap();
+      break;
+    case PAGE_PROFILER:
+      drawPageProfiler();
+      break;
+  }
+
+  // With the framebuffer this is render time only, the SPI transfer is
+  // timed by the flush task
+  metrics.displayFrame.record(micros() - frameStart);
+  metrics.displayFramePixels = widgetStats.pixels - pixelsBefore;
+  presentDisplay(state.fix.epoch);
+}
+
+// Sends the frame to the panel (in the background with the framebuffer)
+void presentDisplay(uint32_t epoch) {
+  if (gfxPtr == &frameBuffer) {
+    frameBuffer.present(epoch);
+  } else if (epoch != 0) {
+    directFlushedEpoch = epoch;
+    directFlushedUs = esp_timer_get_time();
+    directFrameFlushed.store(true, std::memory_order_release);
+    gpsScheduler.trigger(fixLatencyJob);
+  }
+}
+
+void drawWidgets(std::initializer_list<TextWidget *> widgets) {
+  for (TextWidget *w : widgets) {
+    w->draw(gfx);
   }
 }
 
+// Shared by all pages, redrawn after each page switch
+void drawPageTitle(const char *title) {
+  static TextWidget widget(TFT_WIDTH / 2, TFT_PAGE_START_Y + 5, 2, TFT_COLOR_BG, ALIGN_CENTER);
+  widget.set(title, TFT_COLOR_WARNING);
+  widget.draw(gfx);
+}
+
 // ============================================================================
 // DRAW HEADER
 // ============================================================================
-void drawHeader() {
-  tft.fillRect(0, 0, TFT_WIDTH, TFT_HEADER_HEIGHT, TFT_COLOR_HEADER);
+void drawHeader(const DisplayState &state) {
+  static TextWidget title(TFT_WIDTH / 2, 5, 2, TFT_COLOR_HEADER, ALIGN_CENTER);
+  static TextWidget status(TFT_WIDTH / 2, 28, 2, TFT_COLOR_HEADER, ALIGN_CENTER);
+  static TextWidget ip(TFT_WIDTH - 5, 45, 1, TFT_COLOR_HEADER, ALIGN_RIGHT); // Right-aligned
 
-  int16_t x1, y1;
-  uint16_t w, h;
-  
-  // Project Name (Title)
-  tft.setTextSize(2); // Increased font size for header title
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_HEADER);
-  tft.getTextBounds(PROJECT_NAME, 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor((TFT_WIDTH - w) / 2, 5); // Centered, 5px from top
-  tft.print(PROJECT_NAME);
-
-  // GPS Status (centered)
-  tft.setTextSize(2);
-  bool hasFix = gps.location.isValid() && gps.location.age() < GPS_TIMEOUT;
-  String status = hasFix ? "FIX OK" : "NO FIX";
-  uint16_t statusColor = hasFix ? TFT_COLOR_VALUE : TFT_COLOR_ERROR;
-  tft.setTextColor(statusColor, TFT_COLOR_HEADER);
-  String statusStr = "Status: " + status;
-  tft.getTextBounds(statusStr, 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor((TFT_WIDTH - w) / 2, 28); // Centered, below title
-  tft.print(statusStr);
-  
-  // IP Address
-  tft.setTextSize(1);
-  if (!wifiConnected && ipAddress == "Connecting...") {
-      tft.setTextColor(TFT_COLOR_WARNING, TFT_COLOR_HEADER);
-  } else {
-      tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_HEADER);
-  }
-  tft.getTextBounds(ipAddress, 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor(TFT_WIDTH - 5 - w, 45); // Right-aligned, moved down
-  tft.print(ipAddress);
+  title.set(PROJECT_NAME, TFT_COLOR_TEXT);
+
+  bool hasFix = snapshotHasFix(state.fix);
+  status.set(hasFix ? "Status: FIX OK" : "Status: NO FIX", hasFix ? TFT_COLOR_VALUE : TFT_COLOR_ERROR);
 
-  tft.drawFastHLine(0, TFT_HEADER_HEIGHT, TFT_WIDTH, TFT_COLOR_SEPARATOR);
+  NetStatus net;
+  netStatus.read(&net);
+  bool connecting = !net.wifiConnected && strcmp(net.ip, "Connecting...") == 0;
+  ip.set(net.ip, connecting ? TFT_COLOR_WARNING : TFT_COLOR_TEXT);
+
+  drawWidgets({&title, &status, &ip});
 }
 
 // ============================================================================
 // DRAW PAGE: GPS DATA
 // ============================================================================
-void drawPageGPSData() {
-  int y = TFT_PAGE_START_Y + 5;
-  
-  tft.fillRect(0, TFT_PAGE_START_Y, TFT_WIDTH, TFT_HEIGHT - TFT_PAGE_START_Y, TFT_COLOR_BG);
-  
-  tft.setTextSize(2); // Increased font size for page title
-
-  int16_t x1, y1;
-  uint16_t w, h;
-  String pageTitle = "GPS DATA";
-  tft.setTextColor(TFT_COLOR_WARNING, TFT_COLOR_BG);
-  tft.getTextBounds(pageTitle, 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor((TFT_WIDTH - w) / 2, y); // Centered
-  tft.print(pageTitle);
-  y += TFT_LINE_HEIGHT + 5;
-
-  tft.setTextSize(2); // Increased font size for data
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-
-  // Lat / Lng on same line
-  String lat = gps.location.isValid() ? String(gps.location.lat(), 6) : "--";
-  String lng = gps.location.isValid() ? String(gps.location.lng(), 6) : "--";
-  tft.setCursor(5, y); tft.print("Lat:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(65, y); tft.print(lat.substring(0, 7)); // Truncate for space
-  y += TFT_LINE_HEIGHT;
-  tft.setCursor(5, y); tft.print("Lng:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(65, y); tft.print(lng.substring(0, 7)); // Truncate for space
-  y += TFT_LINE_HEIGHT;
+void drawPageGPSData(const DisplayState &state) {
+  const GpsSnapshot &fix = state.fix;
+  const int y = TFT_CONTENT_Y;
+  static TextWidget latLabel(5, y, 2, TFT_COLOR_BG), latValue(65, y, 2, TFT_COLOR_BG);
+  static TextWidget lngLabel(5, y + TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), lngValue(65, y + TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget altLabel(5, y + 2 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), altValue(65, y + 2 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget satLabel(150, y + 2 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), satValue(210, y + 2 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget spdLabel(5, y + 3 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), spdValue(65, y + 3 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget crsLabel(150, y + 3 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), crsValue(210, y + 3 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget utcLabel(5, y + 4 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), utcValue(65, y + 4 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget drFlag(5, y + 5 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget drError(5, y + 6 * TFT_LINE_HEIGHT, 1, TFT_COLOR_BG);
+
+  drawPageTitle("GPS DATA");
+
+  char buf[24];
+
+  // Lat / Lng on separate lines, truncated for space (FMT_TFT_COORD).
+  // Dead-reckoned between fixes, in TFT_COLOR_PREDICTED.
+  DrPrediction dr;
+  drPredictNow(fix, &dr);
+  uint16_t posColor = dr.predicted ? TFT_COLOR_PREDICTED : TFT_COLOR_VALUE;
+  latLabel.set("Lat:", TFT_COLOR_TEXT);
+  fmtScaledIf(fix.locationValid, buf, sizeof(buf), dr.latE7, 7, FMT_TFT_COORD);
+  latValue.set(buf, posColor);
+  lngLabel.set("Lng:", TFT_COLOR_TEXT);
+  fmtScaledIf(fix.locationValid, buf, sizeof(buf), dr.lngE7, 7, FMT_TFT_COORD);
+  lngValue.set(buf, posColor);
 
   // Alt / Sats on same line
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  String alt = gps.altitude.isValid() ? String(gps.altitude.meters(), 1) + "m" : "--";
-  String sats = String(gps.satellites.value());
-  tft.setCursor(5, y); tft.print("Alt:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(65, y); tft.print(alt);
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  tft.setCursor(150, y); tft.print("Sats:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(210, y); tft.print(sats);
-  y += TFT_LINE_HEIGHT;
+  altLabel.set("Alt:", TFT_COLOR_TEXT);
+  fmtFloatIf(fix.altitudeValid, buf, sizeof(buf), fix.altitudeM, FMT_TFT_ALT);
+  altValue.set(buf, TFT_COLOR_VALUE);
+  satLabel.set("Sats:", TFT_COLOR_TEXT);
+  fmtUint(buf, sizeof(buf), fix.satellites);
+  satValue.set(buf, TFT_COLOR_VALUE);
 
   // Speed / Course on same line
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  String spd = gps.speed.isValid() ? String(gps.speed.kmph(), 1) + "km/h" : "--";
-  String crs = gps.course.isValid() ? String(gps.course.deg(), 1) + "°" : "--";
-  tft.setCursor(5, y); tft.print("Spd:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(65, y); tft.print(spd);
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  tft.setCursor(150, y); tft.print("Crs:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(210, y); tft.print(crs);
-  y += TFT_LINE_HEIGHT;
-
-  // UTC Time and Date
-  if (gps.date.isValid() && gps.time.isValid()) {
-    tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-    char dateStr[32];
-    sprintf(dateStr, "%02d/%02d/%04d %02d:%02d:%02d",
-            gps.date.day(), gps.date.month(), gps.date.year(),
-            gps.time.hour(), gps.time.minute(), gps.time.second());
-    tft.setCursor(5, y);
-    tft.print("UTC:");
-    tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-    tft.setCursor(65, y);
-    tft.print(String(dateStr).substring(11)); // Time only, skipping the space
+  spdLabel.set("Spd:", TFT_COLOR_TEXT);
+  fmtFloatIf(fix.speedValid, buf, sizeof(buf), fix.speedKmph, FMT_TFT_SPEED);
+  spdValue.set(buf, TFT_COLOR_VALUE);
+  crsLabel.set("Crs:", TFT_COLOR_TEXT);
+  fmtFloatIf(fix.courseValid, buf, sizeof(buf), fix.courseDeg, FMT_COURSE);
+  crsValue.set(buf, TFT_COLOR_VALUE);
+
+  // UTC Time (blank until date and time are valid)
+  if (fix.dateValid && fix.timeValid) {
+    fmtClock(buf, sizeof(buf), fix.hour, fix.minute, fix.second);
+    utcLabel.set("UTC:", TFT_COLOR_TEXT);
+    utcValue.set(buf, TFT_COLOR_VALUE);
+  } else {
+    utcLabel.set("", TFT_COLOR_TEXT);
+    utcValue.set("", TFT_COLOR_VALUE);
+  }
+
+  // Dead reckoning: time extrapolated past the fix, and how far off the
+  // predictions have been from the next fix (vs. holding the last one)
+  if (dr.predicted) {
+    size_t n = strlcpy(buf, "DR +", sizeof(buf));
+    fmtScaled(buf + n, sizeof(buf) - n, dr.horizonMs, 3, FMT_TFT_SECONDS);
+    drFlag.set(buf, TFT_COLOR_PREDICTED);
+  } else {
+    drFlag.set("", TFT_COLOR_PREDICTED);
   }
+  if (state.drChecks > 0) {
+    char line[48]; // Fits two 32-bit cm values
+    char *p = line;
+    char *end = line + sizeof(line);
+    p += strlcpy(p, "DR error ", end - p);
+    p += fmtScaled(p, end - p, state.drAvgErrorCm, 2, FMT_TFT_DIST);
+    p += strlcpy(p, " avg, hold ", end - p);
+    fmtScaled(p, end - p, state.drAvgHoldCm, 2, FMT_TFT_DIST);
+    drError.set(line, TFT_COLOR_TEXT);
+  } else {
+    drError.set("", TFT_COLOR_TEXT);
+  }
+
+  drawWidgets({&latLabel, &latValue, &lngLabel, &lngValue, &altLabel, &altValue, &satLabel, &satValue,
+               &spdLabel, &spdValue, &crsLabel, &crsValue, &utcLabel, &utcValue, &drFlag, &drError});
 }
 
 // ============================================================================
 // DRAW PAGE: DIAGNOSTICS
 // ============================================================================
-void drawPageDiagnostics() {
-  int y = TFT_PAGE_START_Y + 5;
-  
-  tft.fillRect(0, TFT_PAGE_START_Y, TFT_WIDTH, TFT_HEIGHT - TFT_PAGE_START_Y, TFT_COLOR_BG);
-  
-  tft.setTextSize(2); // Increased font size for page title
+void drawPageDiagnostics(const DisplayState &state) {
+  const int y = TFT_CONTENT_Y;
+  static TextWidget modelLabel(5, y, 2, TFT_COLOR_BG), modelValue(100, y, 2, TFT_COLOR_BG);
+  static TextWidget validLabel(5, y + TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), validValue(100, y + TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget failedLabel(5, y + 2 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), failedValue(100, y + 2 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget successLabel(5, y + 3 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), successValue(120, y + 3 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget hdopLabel(5, y + 4 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), hdopValue(80, y + 4 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget ageLabel(5, y + 5 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), ageValue(80, y + 5 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget uptimeLabel(5, y + 6 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), uptimeValue(100, y + 6 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+
+  drawPageTitle("DIAGNOSTICS");
 
-  int16_t x1, y1;
-  uint16_t w, h;
-  String pageTitle = "DIAGNOSTICS";
-  tft.setTextColor(TFT_COLOR_WARNING, TFT_COLOR_BG);
-  tft.getTextBounds(pageTitle, 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor((TFT_WIDTH - w) / 2, y); // Centered
-  tft.print(pageTitle);
-  y += TFT_LINE_HEIGHT + 5;
+  // GPS Model
+  modelLabel.set("Model:", TFT_COLOR_TEXT);
+  modelValue.set(GPS_MODEL, TFT_COLOR_VALUE);
 
-  tft.setTextSize(2); // Increased font size for data
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
+  char buf[24];
 
-  // GPS Model
-  tft.setCursor(5, y); tft.print("Model:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(100, y); tft.print(String(GPS_MODEL));
-  y += TFT_LINE_HEIGHT;
-
-  // Valid Sentences
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  tft.setCursor(5, y); tft.print("Valid:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(100, y); tft.print(String(validSentences));
-  y += TFT_LINE_HEIGHT;
-
-  // Failed Checksums
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  tft.setCursor(5, y); tft.print("Failed:");
-  tft.setTextColor(failedChecksums > 0 ? TFT_COLOR_ERROR : TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(100, y); tft.print(String(failedChecksums));
-  y += TFT_LINE_HEIGHT;
+  // Valid Sentences / Failed Checksums
+  validLabel.set("Valid:", TFT_COLOR_TEXT);
+  fmtUint(buf, sizeof(buf), state.validSentences);
+  validValue.set(buf, TFT_COLOR_VALUE);
+  failedLabel.set("Failed:", TFT_COLOR_TEXT);
+  fmtUint(buf, sizeof(buf), state.failedChecksums);
+  failedValue.set(buf, state.failedChecksums > 0 ? TFT_COLOR_ERROR : TFT_COLOR_VALUE);
 
   // Success Rate
   float successRate = 0;
-  if (totalSentences > 0) {
-    successRate = ((totalSentences - failedChecksums) * 100.0) / totalSentences;
+  if (state.totalSentences > 0) {
+    successRate = ((state.totalSentences - state.failedChecksums) * 100.0) / state.totalSentences;
   }
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  tft.setCursor(5, y); tft.print("Success:");
-  tft.setTextColor(successRate > 95 ? TFT_COLOR_VALUE : TFT_COLOR_WARNING, TFT_COLOR_BG);
-  tft.setCursor(120, y); tft.print(String(successRate, 1) + "%");
-  y += TFT_LINE_HEIGHT;
+  successLabel.set("Success:", TFT_COLOR_TEXT);
+  fmtFloat(buf, sizeof(buf), successRate, FMT_PERCENT);
+  successValue.set(buf, successRate > 95 ? TFT_COLOR_VALUE : TFT_COLOR_WARNING);
 
   // HDOP
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  String hdop = gps.hdop.isValid() ? String(gps.hdop.hdop(), 2) : "--";
-  tft.setCursor(5, y); tft.print("HDOP:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(80, y); tft.print(hdop);
-  y += TFT_LINE_HEIGHT;
+  hdopLabel.set("HDOP:", TFT_COLOR_TEXT);
+  fmtFloatIf(state.fix.hdopValid, buf, sizeof(buf), state.fix.hdop, FMT_HDOP);
+  hdopValue.set(buf, TFT_COLOR_VALUE);
 
   // Age
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  unsigned long age = gps.location.age();
-  String ageStr = age < 1000 ? String(age) + "ms" : String(age / 1000) + "s";
-  tft.setCursor(5, y); tft.print("Age:");
-  tft.setTextColor(age < GPS_TIMEOUT ? TFT_COLOR_VALUE : TFT_COLOR_ERROR, TFT_COLOR_BG);
-  tft.setCursor(80, y); tft.print(ageStr);
-  y += TFT_LINE_HEIGHT;
+  unsigned long age = snapshotLocationAge(state.fix);
+  ageLabel.set("Age:", TFT_COLOR_TEXT);
+  fmtAge(buf, sizeof(buf), age, FMT_TFT_AGE);
+  ageValue.set(buf, age < GPS_TIMEOUT ? TFT_COLOR_VALUE : TFT_COLOR_ERROR);
 
   // Uptime
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  tft.setCursor(5, y); tft.print("Uptime:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  unsigned long uptime = millis() / 1000;
-  char uptimeStr[32];
-  sprintf(uptimeStr, "%luh%lum%lus", uptime / 3600, (uptime % 3600) / 60, uptime % 60);
-  tft.setCursor(100, y);
-  tft.print(uptimeStr);
+  uptimeLabel.set("Uptime:", TFT_COLOR_TEXT);
+  fmtDuration(buf, sizeof(buf), millis() / 1000, FMT_DURATION_COMPACT);
+  uptimeValue.set(buf, TFT_COLOR_VALUE);
+
+  drawWidgets({&modelLabel, &modelValue, &validLabel, &validValue, &failedLabel, &failedValue,
+               &successLabel, &successValue, &hdopLabel, &hdopValue, &ageLabel, &ageValue,
+               &uptimeLabel, &uptimeValue});
 }
 
 // ============================================================================
 // DRAW PAGE: SATELLITES
 // ============================================================================
-void drawPageSatellites() {
-  int y = TFT_PAGE_START_Y + 5;
-  
-  tft.fillRect(0, TFT_PAGE_START_Y, TFT_WIDTH, TFT_HEIGHT - TFT_PAGE_START_Y, TFT_COLOR_BG);
-  
-  tft.setTextSize(2); // Increased font size for page title
-
-  int16_t x1, y1;
-  uint16_t w, h;
-  String pageTitle = "SATELLITES";
-  tft.setTextColor(TFT_COLOR_WARNING, TFT_COLOR_BG);
-  tft.getTextBounds(pageTitle, 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor((TFT_WIDTH - w) / 2, y); // Centered
-  tft.print(pageTitle);
-  y += TFT_LINE_HEIGHT + 5;
-
-  tft.setTextSize(2); // Increased font size for data
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-
-  // Satellites
-  tft.setCursor(5, y); tft.print("Sats:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  uint32_t satCount = gps.satellites.value();
-  tft.setCursor(80, y); tft.print(String(satCount));
-  y += TFT_LINE_HEIGHT;
-
-  // HDOP
-  tft.setTextColor(TFT_COLOR_TEXT, TFT_COLOR_BG);
-  String hdop = gps.hdop.isValid() ? String(gps.hdop.hdop(), 2) : "--";
-  tft.setCursor(5, y); tft.print("HDOP:");
-  tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG);
-  tft.setCursor(80, y); tft.print(hdop);
-  y += TFT_LINE_HEIGHT;
-
-  // Signal Quality Bar
-  tft.setCursor(5, y);
-  tft.print("Signal Quality:");
-  y += TFT_LINE_HEIGHT;
-
-  int barWidth = TFT_WIDTH - 20; // 10px padding on each side for the bar
-  int barHeight = 20; // Height of the bar
-  int barX = 10; // X position of the bar
-
-  tft.drawRect(barX, y, barWidth, barHeight, TFT_COLOR_TEXT);
-  uint16_t fillColor = satCount >= 4 ? TFT_COLOR_VALUE : TFT_COLOR_WARNING;
-  int fillWidth = (satCount * (barWidth - 2)) / 12; // Max 12 sats for full bar
-  if (fillWidth > barWidth - 2) fillWidth = barWidth - 2;
-  tft.fillRect(barX + 1, y + 1, fillWidth, barHeight - 2, fillColor);
-  y += barHeight + 5; // Move past the bar with some padding
+void drawPageSatellites(const DisplayState &state) {
+  const int y = TFT_CONTENT_Y;
+  const int barY = y + 3 * TFT_LINE_HEIGHT;
+  const int fixY = barY + 25; // Below the bar with some padding
+  static TextWidget satLabel(5, y, 2, TFT_COLOR_BG), satValue(80, y, 2, TFT_COLOR_BG);
+  static TextWidget hdopLabel(5, y + TFT_LINE_HEIGHT, 2, TFT_COLOR_BG), hdopValue(80, y + TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget qualityLabel(5, y + 2 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  // 10px padding on each side for the bar
+  static BarWidget qualityBar(10, barY, TFT_WIDTH - 20, 20, TFT_COLOR_TEXT, TFT_COLOR_BG);
+  static TextWidget fixLabel(5, fixY, 2, TFT_COLOR_BG), fixValue(5, fixY + TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+  static TextWidget ttff(5, fixY + 2 * TFT_LINE_HEIGHT, 2, TFT_COLOR_BG);
+
+  drawPageTitle("SATELLITES");
+
+  char buf[24];
+  uint32_t satCount = state.fix.satellites;
+  satLabel.set("Sats:", TFT_COLOR_TEXT);
+  fmtUint(buf, sizeof(buf), satCount);
+  satValue.set(buf, TFT_COLOR_VALUE);
+
+  hdopLabel.set("HDOP:", TFT_COLOR_TEXT);
+  fmtFloatIf(state.fix.hdopValid, buf, sizeof(buf), state.fix.hdop, FMT_HDOP);
+  hdopValue.set(buf, TFT_COLOR_VALUE);
+
+  // Signal Quality Bar, max 12 sats for full bar
+  qualityLabel.set("Signal Quality:", TFT_COLOR_TEXT);
+  qualityBar.set(satCount, 12, satCount >= 4 ? TFT_COLOR_VALUE : TFT_COLOR_WARNING);
 
   // Fix Time
-  bool hasFix = gps.location.isValid() && gps.location.age() < GPS_TIMEOUT;
-  if (hasFix) {
-    unsigned long fixDuration = (millis() - gpsFixAcquiredTime) / 1000;
-    char fixStr[32];
-    sprintf(fixStr, "%lum %lus", fixDuration / 60, fixDuration % 60);
-    tft.setCursor(5, y); // Label
-    tft.print("Fix Time:");
-    tft.setTextColor(TFT_COLOR_VALUE, TFT_COLOR_BG); // Value color
-    tft.setCursor(5, y + TFT_LINE_HEIGHT); // Value on next line
-    tft.print(fixStr);
+  if (snapshotHasFix(state.fix)) {
+    fmtDuration(buf, sizeof(buf), (millis() - state.fixAcquiredMs) / 1000, FMT_DURATION_MIN_SEC);
+    fixLabel.set("Fix Time:", TFT_COLOR_TEXT);
+    fixValue.set(buf, TFT_COLOR_VALUE); // Value on next line
+  } else {
+    fixLabel.set("Searching for fix...", TFT_COLOR_ERROR);
+    fixValue.set("", TFT_COLOR_VALUE);
+  }
+
+  // TTFF test (long press on button 2)
+  char line[32];
+  if (state.ttffStartMs != 0) {
+    fmtDuration(buf, sizeof(buf), (millis() - state.ttffStartMs) / 1000, FMT_DURATION_MIN_SEC);
+    snprintf(line, sizeof(line), "TTFF test: %s", buf);
+    ttff.set(line, TFT_COLOR_WARNING);
+  } else if (state.ttffMs != 0) {
+    fmtFloat(buf, sizeof(buf), state.ttffMs / 1000.0, FMT_TFT_SECONDS);
+    snprintf(line, sizeof(line), "TTFF: %s", buf);
+    ttff.set(line, TFT_COLOR_VALUE);
   } else {
-    tft.setTextColor(TFT_COLOR_ERROR, TFT_COLOR_BG); // Error color
-    tft.setCursor(5, y);
-    tft.print("Searching for fix...");
+    ttff.set("", TFT_COLOR_VALUE);
   }
+
+  drawWidgets({&satLabel, &satValue, &hdopLabel, &hdopValue, &qualityLabel, &fixLabel, &fixValue, &ttff});
+  qualityBar.draw(gfx);
 }
 
 // ============================================================================
-// NEOPIXEL LED CONTROL
+// DRAW PAGE: SKY PLOT
 // ============================================================================
-void setLedStatus(LedState state, uint32_t color) {
-  // Only update if state or color has changed
-  if (ledState != state || ledColor != color) {
-    ledState = state;
-    ledColor = color;
-    lastBlinkTime = millis(); // Reset blink timer on state change
-    ledOn = true; // Ensure LED is on when state changes
-    updateLed(); // Update immediately to reflect new state
-  }
+// Colour by L1 SNR, filled when used in the fix
+static uint16_t snrColor(uint8_t snr) {
+  if (snr >= 35) return TFT_COLOR_VALUE;
+  if (snr >= 25) return TFT_COLOR_WARNING;
+  if (snr > 0) return TFT_COLOR_ERROR;
+  return TFT_COLOR_SEPARATOR; // In view, not tracked
 }
 
-void updateLed() {
-  if (pixelPtr == nullptr) return; // Safety check
+void drawPageSky(const DisplayState &state) {
+  const int y = TFT_CONTENT_Y;
+  const int rowH = 12;
+  const int rows = (TFT_HEIGHT - y) / rowH;
+  static TextWidget north(66, y, 1, TFT_COLOR_BG, ALIGN_CENTER);
+  static SkyPlotWidget plot(66, y + 74, 60, TFT_COLOR_SEPARATOR, TFT_COLOR_BG);
+  static TextWidget prnLabels[SAT_TABLE_SIZE];
+  static BarWidget snrBars[SAT_TABLE_SIZE];
+  static bool placed = false;
+  if (!placed) {
+    // SNR chart on the right, one row per satellite
+    for (int i = 0; i < rows; i++) {
+      prnLabels[i].place(136, y + i * rowH + 1, 1, TFT_COLOR_BG);
+      snrBars[i].place(158, y + i * rowH, TFT_WIDTH - 162, rowH - 2, TFT_COLOR_SEPARATOR, TFT_COLOR_BG);
+    }
+    placed = true;
+  }
 
-  switch (ledState) {
-    case SOLID:
-      pixelPtr->setPixelColor(0, ledColor);
-      break;
-    case BLINKING:
-      if (millis() - lastBlinkTime > NEOPIXEL_BLINK_INTERVAL) {
-        ledOn = !ledOn;
-        lastBlinkTime = millis();
-      }
-      pixelPtr->setPixelColor(0, ledOn ? ledColor : NEOPIXEL_COLOR_OFF);
-      break;
-    case OFF:
-      pixelPtr->setPixelColor(0, NEOPIXEL_COLOR_OFF);
-      break;
+  drawPageTitle("SKY PLOT");
+  north.set("N", TFT_COLOR_TEXT);
+  north.draw(gfx);
+
+  const SkyView &sky = state.sky;
+  SkyPlotPoint points[SAT_TABLE_SIZE];
+  for (uint8_t i = 0; i < sky.count; i++) {
+    const SatInfo &sat = sky.sats[i];
+    points[i].id = (sat.system << 9) | sat.prn;
+    points[i].elevation = sat.elevation;
+    points[i].azimuth = sat.azimuth;
+    points[i].color = snrColor(sat.snr);
+    points[i].filled = sat.used;
+  }
+  plot.set(points, sky.count);
+  plot.draw(gfx);
+
+  // Tracked satellites first, table order otherwise so rows don't jump around
+  uint8_t order[SAT_TABLE_SIZE];
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < sky.count; i++) if (sky.sats[i].snr > 0) order[n++] = i;
+  for (uint8_t i = 0; i < sky.count; i++) if (sky.sats[i].snr == 0) order[n++] = i;
+
+  for (int row = 0; row < rows; row++) {
+    if (row < n) {
+      const SatInfo &sat = sky.sats[order[row]];
+      char label[8];
+      label[0] = GNSS_LETTERS[sat.system];
+      fmtUint(label + 1, sizeof(label) - 1, sat.prn);
+      prnLabels[row].set(label, sat.used ? TFT_COLOR_TEXT : TFT_COLOR_SEPARATOR);
+      snrBars[row].set(sat.snr, 50, snrColor(sat.snr)); // 50 dB-Hz: full bar
+    } else {
+      prnLabels[row].set("", TFT_COLOR_TEXT);
+      snrBars[row].set(0, 50, TFT_COLOR_SEPARATOR);
+    }
+    prnLabels[row].draw(gfx);
+    snrBars[row].draw(gfx);
+  }
+}
+
+// ============================================================================
+// DRAW PAGE: TRACK MAP
+// ============================================================================
+// Reads the track history directly: the map only fetches points it hasn't
+// drawn yet, so it doesn't travel in DisplayState.
+void drawPageMap() {
+  static TrackMapWidget map(0, TFT_CONTENT_Y, TFT_WIDTH, TFT_HEIGHT - TFT_CONTENT_Y, TFT_COLOR_VALUE,
+                            TFT_COLOR_WARNING, TFT_COLOR_TEXT, TFT_COLOR_BG);
+  static TextWidget waiting(TFT_WIDTH / 2, TFT_CONTENT_Y + 50, 2, TFT_COLOR_BG, ALIGN_CENTER);
+
+  drawPageTitle(trackRecording ? "TRACK MAP" : "TRACK MAP (PAUSED)");
+
+  // Over the empty map, and cleared before the first breadcrumb is drawn
+  if (trackHistory.next() == 0) {
+    map.draw(gfx, trackHistory);
+    waiting.set("Waiting for fix...", TFT_COLOR_WARNING);
+    waiting.draw(gfx);
+  } else {
+    waiting.set("", TFT_COLOR_WARNING);
+    waiting.draw(gfx);
+    map.draw(gfx, trackHistory);
   }
-  pixelPtr->show();
 }
 
 // ============================================================================
-// BUZZER CONTROL
+// DRAW PAGE: PROFILER
 // ============================================================================
-void playTone(int frequency, int duration) {
-  if (!BUZZER_ENABLED) return;
+void drawPageProfiler() {
+  const int y = TFT_CONTENT_Y;
+  static TextWidget tableHeader(5, y, 1, TFT_COLOR_BG);
+  static TextWidget names[STAGE_COUNT];
+  static TextWidget rows[STAGE_COUNT];
+  static bool placed = false;
+  if (!placed) {
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+      names[i].place(5, y + 14 * (i + 1), 1, TFT_COLOR_BG);
+      rows[i].place(65, y + 14 * (i + 1), 1, TFT_COLOR_BG);
+    }
+    placed = true;
+  }
+
+  drawPageTitle("PROFILER");
 
-  ledcWriteTone(BUZZER_LEDC_CHANNEL, frequency);
-  delay(duration); // Keep the tone for the duration
-  ledcWriteTone(BUZZER_LEDC_CHANNEL, 0); // Stop the tone
+  if (!PROFILER_ENABLED) {
+    tableHeader.set("Disabled", TFT_COLOR_ERROR);
+    tableHeader.draw(gfx);
+    return;
+  }
+
+  // Small font: one table row per stage, times in microseconds
+  tableHeader.set("Stage         avg     p99     max (us)", TFT_COLOR_TEXT);
+  tableHeader.draw(gfx);
+
+  char row[48];
+  for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+    StageStats st = profiler.stats((ProfileStage)i);
+    snprintf(row, sizeof(row), "%7lu %7lu %7lu", (unsigned long)st.avgUs,
+             (unsigned long)st.p99Us, (unsigned long)st.maxUs);
+    names[i].set(PROFILE_STAGE_NAMES[i], TFT_COLOR_TEXT);
+    rows[i].set(row, TFT_COLOR_VALUE);
+    names[i].draw(gfx);
+    rows[i].draw(gfx);
+  }
 }
 
 // ============================================================================
 // GPS RESET
 // ============================================================================
+// GPS task only (other tasks trigger gpsResetJob)
 void resetGPS() {
   DEBUG_PRINTLN("Resetting GPS module...");
 
   gpsSerial.end();
   delay(100);
 
-  gpsSerial.begin(GPS_BAUD_RATE, SERIAL_8N1, PIN_GPS_RXD, PIN_GPS_TXD);
+  beginGpsSerial();
   delay(100);
 
   validSentences = 0;
   failedChecksums = 0;
   totalSentences = 0;
   previousFixStatus = false;
+  nmeaLineLen = 0;
+  epochHasGGA = false;
+  epochHasRMC = false;
+  trackHistory.clear();
+  drErrors.reset();
+  publishGpsStatus();
 
   DEBUG_PRINTLN("GPS module reset complete");
 }
 
+// GPS task only (other tasks trigger ttffTestJob). Cold-starts the receiver
+// (u-blox UBX-CFG-RST: clear all navigation data, restart the GNSS only) and
+// times the first fix; modules that don't speak UBX give a warm start TTFF.
+void startTtffTest() {
+  static const uint8_t UBX_CFG_RST_COLD[] = {0xB5, 0x62, 0x06, 0x04, 0x04, 0x00, 0xFF, 0xFF, 0x02, 0x00, 0x0E, 0x61};
+  DEBUG_PRINTLN("TTFF test: cold start");
+  gpsSerial.write(UBX_CFG_RST_COLD, sizeof(UBX_CFG_RST_COLD));
+  gpsSerial.flush();
+  resetGPS();
+  ttffMs = 0;
+  ttffStartMs = max(millis(), 1UL);
+  publishGpsStatus();
+  publishDisplayState();
+}
+
 // ============================================================================
 // GET GPS DATA AS JSON
 // ============================================================================
-String getGPSJson() {
-  JsonDocument doc;
+// Module and board fields: fixed while the firmware runs, formatted once
+struct StaticJsonInfo {
+  char gpsBaud[16];
+  char gpsRate[16];
+  const char *chipModel;
+  uint8_t chipCores;
+  char chipFreq[16];
+  char chipMemory[40];
+};
+
+static StaticJsonInfo formatStaticJsonInfo() {
+  StaticJsonInfo info;
+  snprintf(info.gpsBaud, sizeof(info.gpsBaud), "%d bps", GPS_BAUD_RATE);
+  fmtFloat(info.gpsRate, sizeof(info.gpsRate), 1000.0 / GPS_UPDATE_RATE, FMT_RATE_HZ);
+  esp_chip_info_t chip_info;
+  esp_chip_info(&chip_info);
+  info.chipModel = chip_info.model == CHIP_ESP32S3 ? "ESP32-S3" : "Unknown";
+  info.chipCores = chip_info.cores;
+  snprintf(info.chipFreq, sizeof(info.chipFreq), "%lu MHz", (unsigned long)ESP.getCpuFreqMHz());
+  snprintf(info.chipMemory, sizeof(info.chipMemory), "%luMB Flash / %luMB PSRAM",
+           (unsigned long)(ESP.getFlashChipSize() / (1024 * 1024)), (unsigned long)(ESP.getPsramSize() / (1024 * 1024)));
+  return info;
+}
 
-  doc["fix"] = gps.location.isValid() && gps.location.age() < GPS_TIMEOUT;
-  doc["satellites"] = gps.satellites.value();
-  doc["hdop"] = gps.hdop.isValid() ? String(gps.hdop.hdop(), 2) : "--";
-
-  unsigned long uptime = millis() / 1000;
-  char uptimeStr[32];
-  sprintf(uptimeStr, "%luh %lum %lus", uptime / 3600, (uptime % 3600) / 60, uptime % 60);
-  doc["uptime"] = String(uptimeStr);
-
-  doc["latitude"] = gps.location.isValid() ? String(gps.location.lat(), 6) : "--";
-  doc["longitude"] = gps.location.isValid() ? String(gps.location.lng(), 6) : "--";
-  doc["altitude"] = gps.altitude.isValid() ? String(gps.altitude.meters(), 1) + " m" : "--";
-  doc["speed"] = gps.speed.isValid() ? String(gps.speed.kmph(), 1) + " km/h" : "--";
-  doc["course"] = gps.course.isValid() ? String(gps.course.deg(), 1) + "°" : "--";
-
-  if (gps.date.isValid()) {
-    char dateStr[16];
-    sprintf(dateStr, "%02d/%02d/%04d", gps.date.day(), gps.date.month(), gps.date.year());
-    doc["date"] = String(dateStr);
+// Any task: built from a gpsStatus copy
+String getGPSJson(const GpsStatus &status) {
+  static const StaticJsonInfo info = formatStaticJsonInfo(); // On the first call, from whichever task
+
+  JsonDocument doc;
+  const GpsSnapshot &s = status.fix;
+
+  doc["fix"] = snapshotHasFix(s);
+  doc["satellites"] = s.satellites;
+  // char arrays (not const char *) so ArduinoJson copies them
+  char buf[32];
+  fmtFloatIf(s.hdopValid, buf, sizeof(buf), s.hdop, FMT_HDOP);
+  doc["hdop"] = buf;
+
+  fmtDuration(buf, sizeof(buf), millis() / 1000, FMT_DURATION_SPACED);
+  doc["uptime"] = buf;
+
+  fmtScaledIf(s.locationValid, buf, sizeof(buf), s.latE7, 7, FMT_JSON_COORD);
+  doc["latitude"] = buf;
+  fmtScaledIf(s.locationValid, buf, sizeof(buf), s.lngE7, 7, FMT_JSON_COORD);
+  doc["longitude"] = buf;
+  fmtFloatIf(s.altitudeValid, buf, sizeof(buf), s.altitudeM, FMT_JSON_ALT);
+  doc["altitude"] = buf;
+  fmtFloatIf(s.speedValid, buf, sizeof(buf), s.speedKmph, FMT_JSON_SPEED);
+  doc["speed"] = buf;
+  fmtFloatIf(s.courseValid, buf, sizeof(buf), s.courseDeg, FMT_COURSE);
+  doc["course"] = buf;
+
+  if (s.dateValid) {
+    fmtDate(buf, sizeof(buf), s.day, s.month, s.year);
+    doc["date"] = buf;
   } else {
-    doc["date"] = "--";
+    doc["date"] = FMT_MISSING;
   }
 
-  if (gps.time.isValid()) {
-    char timeStr[16];
-    sprintf(timeStr, "%02d:%02d:%02d", gps.time.hour(), gps.time.minute(), gps.time.second());
-    doc["time"] = String(timeStr);
+  if (s.timeValid) {
+    fmtClock(buf, sizeof(buf), s.hour, s.minute, s.second);
+    doc["time"] = buf;
   } else {
-    doc["time"] = "--";
+    doc["time"] = FMT_MISSING;
   }
 
-  unsigned long age = gps.location.age();
-  String ageStr = age < 1000 ? String(age) + " ms" : String(age / 1000) + " s";
-  doc["age"] = ageStr;
+  fmtAge(buf, sizeof(buf), snapshotLocationAge(s), FMT_JSON_AGE);
+  doc["age"] = buf;
 
-  doc["validSentences"] = validSentences;
-  doc["failedChecksums"] = failedChecksums;
-  doc["totalChars"] = gps.charsProcessed();
+  doc["validSentences"] = status.validSentences;
+  doc["failedChecksums"] = status.failedChecksums;
+  doc["totalChars"] = status.charsProcessed;
 
   float successRate = 0;
-  if (totalSentences > 0) {
-    successRate = ((totalSentences - failedChecksums) * 100.0) / totalSentences;
+  if (status.totalSentences > 0) {
+    successRate = ((status.totalSentences - status.failedChecksums) * 100.0) / status.totalSentences;
   }
-  doc["successRate"] = String(successRate, 1) + "%";
+  fmtFloat(buf, sizeof(buf), successRate, FMT_PERCENT);
+  doc["successRate"] = buf;
 
   // --- GPS Module Information ---
-  doc["gpsModel"] = String(GPS_MODEL);
-  doc["gpsBaud"] = String(GPS_BAUD_RATE) + " bps";
-  doc["gpsRate"] = String(1000.0 / GPS_UPDATE_RATE, 1) + " Hz";
+  doc["gpsModel"] = GPS_MODEL;
+  doc["gpsBaud"] = info.gpsBaud;
+  doc["gpsRate"] = info.gpsRate;
 
   // --- Board Information ---
-  esp_chip_info_t chip_info;
-  esp_chip_info(&chip_info);
-  doc["chipModel"] = chip_info.model == CHIP_ESP32S3 ? "ESP32-S3" : "Unknown";
-  doc["chipCores"] = chip_info.cores;
-  doc["chipFreq"] = String(ESP.getCpuFreqMHz()) + " MHz";
-  doc["chipMemory"] = String(ESP.getFlashChipSize() / (1024 * 1024)) + "MB Flash / " +
-                     String(ESP.getPsramSize() / (1024 * 1024)) + "MB PSRAM";
+  doc["chipModel"] = info.chipModel;
+  doc["chipCores"] = info.chipCores;
+  doc["chipFreq"] = info.chipFreq;
+  doc["chipMemory"] = info.chipMemory;
 
   String output;
   serializeJson(doc, output);
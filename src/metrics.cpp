@@ -0,0 +1,156 @@
+// Firmware metrics and Prometheus text exposition
+
+#include "metrics.h"
+#include "str_append.h"
+#include <ESPAsyncWebServer.h>
+#include <memory>
+
+FirmwareMetrics metrics = {};
+
+const uint32_t LATENCY_BUCKET_BOUNDS_US[LATENCY_BUCKET_COUNT - 1] = {
+  10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 100000, 500000, 1000000
+};
+
+const char *const NMEA_TYPE_NAMES[NMEA_TYPE_COUNT] = {
+  "GGA", "RMC", "GSA", "GSV", "VTG", "GLL", "ZDA", "TXT", "other"
+};
+
+// ============================================================================
+// LATENCY HISTOGRAM
+// ============================================================================
+void LatencyHistogram::record(uint32_t us) {
+  size_t i = 0;
+  while (i < LATENCY_BUCKET_COUNT - 1 && us > LATENCY_BUCKET_BOUNDS_US[i]) i++;
+  _buckets[i]++;
+  _count++;
+  _sumUs += us;
+  if (us < _minUs) _minUs = us;
+  if (us > _maxUs) _maxUs = us;
+}
+
+void LatencyHistogram::reset() {
+  memset(_buckets, 0, sizeof(_buckets));
+  _count = 0;
+  _sumUs = 0;
+  _minUs = UINT32_MAX;
+  _maxUs = 0;
+}
+
+// ============================================================================
+// SENTENCE CLASSIFICATION
+// ============================================================================
+NmeaSentenceType nmeaSentenceType(const char *sentence, size_t len) {
+  if (len < 6) return NMEA_OTHER;
+  const char *type = sentence + 3; // Skip "$" and the talker ID
+  for (uint8_t i = 0; i < NMEA_OTHER; i++) {
+    if (strncmp(type, NMEA_TYPE_NAMES[i], 3) == 0) return (NmeaSentenceType)i;
+  }
+  return NMEA_OTHER;
+}
+
+// ============================================================================
+// PROMETHEUS TEXT WRITER
+// ============================================================================
+void MetricsWriter::header(const char *name, const char *help, const char *type) {
+  appendf(_buf, _cap, &_len, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void MetricsWriter::sample(const char *name, const char *labels, double value) {
+  if (isnan(value)) {
+    appendf(_buf, _cap, &_len, "%s%s%s%s NaN\n", name, labels ? "{" : "", labels ? labels : "", labels ? "}" : "");
+  } else {
+    appendf(_buf, _cap, &_len, "%s%s%s%s %.6g\n", name, labels ? "{" : "", labels ? labels : "", labels ? "}" : "", value);
+  }
+}
+
+void MetricsWriter::sample(const char *name, const char *labels, uint64_t value) {
+  appendf(_buf, _cap, &_len, "%s%s%s%s %llu\n", name, labels ? "{" : "", labels ? labels : "", labels ? "}" : "",
+          (unsigned long long)value);
+}
+
+void MetricsWriter::counter(const char *name, const char *help, uint64_t value) {
+  header(name, help, "counter");
+  sample(name, nullptr, value);
+}
+
+void MetricsWriter::gauge(const char *name, const char *help, double value) {
+  header(name, help, "gauge");
+  sample(name, nullptr, value);
+}
+
+void MetricsWriter::histogram(const char *name, const char *help, const LatencyHistogram &h) {
+  header(name, help, "histogram");
+  histogramSamples(name, nullptr, h);
+}
+
+void MetricsWriter::histogramSamples(const char *name, const char *labels, const LatencyHistogram &h) {
+  const char *sep = labels ? "," : "";
+  if (!labels) labels = "";
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+    cumulative += h.bucket(i);
+    if (i < LATENCY_BUCKET_COUNT - 1) {
+      appendf(_buf, _cap, &_len, "%s_bucket{%s%sle=\"%g\"} %llu\n", name, labels, sep,
+              LATENCY_BUCKET_BOUNDS_US[i] / 1e6, (unsigned long long)cumulative);
+    } else {
+      appendf(_buf, _cap, &_len, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels, sep,
+              (unsigned long long)cumulative);
+    }
+  }
+  const char *open = *labels ? "{" : "";
+  const char *close = *labels ? "}" : "";
+  appendf(_buf, _cap, &_len, "%s_sum%s%s%s %.6f\n%s_count%s%s%s %llu\n", name, open, labels, close,
+          h.sumUs() / 1e6, name, open, labels, close, (unsigned long long)cumulative);
+}
+
+// ============================================================================
+// CHUNKED /metrics RESPONSE
+// ============================================================================
+namespace {
+struct MetricsStream {
+  MetricsFamilyRenderer render;
+  uint8_t nextFamily = 0;
+  bool done = false;
+  size_t len = 0; // Bytes of the current family in buf
+  size_t pos = 0; // Bytes already handed to the response
+  char buf[METRICS_FAMILY_BUFFER];
+};
+} // namespace
+
+void sendMetricsResponse(AsyncWebServerRequest *request, MetricsFamilyRenderer render) {
+  std::shared_ptr<MetricsStream> stream(new MetricsStream());
+  stream->render = render;
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse(
+      "text/plain; version=0.0.4",
+      [stream](uint8_t *out, size_t maxLen, size_t) -> size_t {
+        size_t written = 0;
+        while (written < maxLen) {
+          if (stream->pos == stream->len) {
+            if (stream->done) break;
+            MetricsWriter writer(stream->buf, sizeof(stream->buf));
+            if (!stream->render(writer, stream->nextFamily++)) {
+              stream->done = true;
+              break;
+            }
+            stream->len = writer.length();
+            stream->pos = 0;
+            if (writer.truncated()) {
+              // A cut line or histogram would break the whole scrape
+              metrics.truncatedFamilies++;
+              DEBUG_PRINTF("Metrics: family %u exceeds METRICS_FAMILY_BUFFER, dropped\n", stream->nextFamily - 1);
+              stream->len = 0;
+              appendf(stream->buf, sizeof(stream->buf), &stream->len,
+                      "# family %u dropped: larger than METRICS_FAMILY_BUFFER\n", stream->nextFamily - 1);
+            }
+            continue;
+          }
+          size_t n = min(maxLen - written, stream->len - stream->pos);
+          memcpy(out + written, stream->buf + stream->pos, n);
+          written += n;
+          stream->pos += n;
+        }
+        return written; // 0 ends the chunked response
+      });
+  request->send(response);
+}
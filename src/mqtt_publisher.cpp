@@ -0,0 +1,204 @@
+// MQTT publisher
+// See mqtt_publisher.h for the batching and offline queue policy.
+
+#include "mqtt_publisher.h"
+#include "str_append.h"
+#include "num_format.h"
+#include <WiFi.h>
+
+// ============================================================================
+// SETUP / CONNECTION
+// ============================================================================
+void MqttPublisher::begin() {
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  snprintf(_clientId, sizeof(_clientId), "gps-tester-%02x%02x%02x", mac[3], mac[4], mac[5]);
+  snprintf(_fixTopic, sizeof(_fixTopic), "%s/%s/fix", MQTT_TOPIC_PREFIX, _clientId);
+  snprintf(_statsTopic, sizeof(_statsTopic), "%s/%s/stats", MQTT_TOPIC_PREFIX, _clientId);
+
+  _epochs = xQueueCreate(MQTT_EPOCH_QUEUE_LEN, sizeof(GpsSnapshot));
+  _queue = (uint8_t *)ps_malloc(MQTT_QUEUE_BYTES);
+  if (_queue == nullptr) {
+    DEBUG_PRINTLN("MQTT: PSRAM queue allocation failed, offline queueing disabled");
+  }
+
+  _client.setServer(MQTT_BROKER_HOST, MQTT_BROKER_PORT);
+  _client.setClientId(_clientId);
+  if (strlen(MQTT_USERNAME) > 0) {
+    _client.setCredentials(MQTT_USERNAME, MQTT_PASSWORD);
+  }
+  _client.onConnect([this](bool) {
+    DEBUG_PRINTF("MQTT connected to %s:%d\n", MQTT_BROKER_HOST, MQTT_BROKER_PORT);
+    _connected = true;
+  });
+  _client.onDisconnect([this](AsyncMqttClientDisconnectReason reason) {
+    DEBUG_PRINTF("MQTT disconnected (reason %d)\n", (int)reason);
+    _connected = false;
+  });
+
+  DEBUG_PRINTF("MQTT publisher ready, fix topic: %s\n", _fixTopic);
+}
+
+void MqttPublisher::connect() {
+  _lastAttemptMs = millis();
+  _client.connect();
+}
+
+void MqttPublisher::loop(bool wifiUp) {
+  addQueuedEpochs();
+
+  if (!wifiUp) {
+    if (_client.connected()) _client.disconnect(true);
+  } else if (!_client.connected() && millis() - _lastAttemptMs > MQTT_RECONNECT_MS) {
+    connect();
+  }
+
+  // Do not keep a partial batch forever at low fix rates
+  if (_batchEpochs > 0 && millis() - _batchStartMs > MQTT_BATCH_MAX_DELAY_MS) {
+    closeBatch();
+  }
+
+  // Bulk drain of the offline queue, bounded per call to keep the network task responsive
+  for (int i = 0; i < MQTT_DRAIN_PER_LOOP && _connected && _queuedBatches > 0; i++) {
+    size_t len = peekQueued(_tx, sizeof(_tx));
+    if (len > 0 && !publishBatch(_tx, len)) break; // TCP buffer full, retry next loop
+    popQueued();
+  }
+}
+
+// ============================================================================
+// FIX BATCHING
+// ============================================================================
+void MqttPublisher::queueEpoch(const GpsSnapshot &s) {
+  if (_epochs == nullptr) return;
+  if (xQueueSend(_epochs, &s, 0) != pdTRUE) {
+    _droppedEpochs++;
+  }
+}
+
+void MqttPublisher::addQueuedEpochs() {
+  if (_epochs == nullptr) return;
+  GpsSnapshot s;
+  while (xQueueReceive(_epochs, &s, 0) == pdTRUE) {
+    addEpoch(s);
+  }
+}
+
+void MqttPublisher::addEpoch(const GpsSnapshot &s) {
+  char record[256];
+  size_t len = 0;
+  appendf(record, sizeof(record), &len, "{\"e\":%lu,\"fix\":%d",
+          (unsigned long)s.epoch, snapshotHasFix(s) ? 1 : 0);
+  if (s.dateValid && s.timeValid) {
+    appendf(record, sizeof(record), &len, ",\"ts\":\"%04u-%02u-%02uT%02u:%02u:%02u.%02uZ\"",
+            s.year, s.month, s.day, s.hour, s.minute, s.second, s.centisecond);
+  }
+  if (s.locationValid) {
+    char lat[16], lng[16];
+    fmtScaled(lat, sizeof(lat), s.latE7, 7, FMT_WIRE_COORD);
+    fmtScaled(lng, sizeof(lng), s.lngE7, 7, FMT_WIRE_COORD);
+    appendf(record, sizeof(record), &len, ",\"lat\":%s,\"lon\":%s", lat, lng);
+  }
+  if (s.altitudeValid) appendf(record, sizeof(record), &len, ",\"alt\":%.1f", s.altitudeM);
+  if (s.speedValid) appendf(record, sizeof(record), &len, ",\"spd\":%.1f", s.speedKmph);
+  if (s.courseValid) appendf(record, sizeof(record), &len, ",\"crs\":%.1f", s.courseDeg);
+  if (s.hdopValid) appendf(record, sizeof(record), &len, ",\"hdop\":%.2f", s.hdop);
+  appendf(record, sizeof(record), &len, ",\"sats\":%lu}", (unsigned long)s.satellites);
+
+  // Room for the separator and the closing bracket
+  if (_batchLen + len + 2 > sizeof(_batch)) closeBatch();
+
+  if (_batchEpochs == 0) {
+    _batch[0] = '[';
+    _batchLen = 1;
+    _batchStartMs = millis();
+  } else {
+    _batch[_batchLen++] = ',';
+  }
+  memcpy(_batch + _batchLen, record, len);
+  _batchLen += len;
+  _batchEpochs++;
+
+  if (_batchEpochs >= MQTT_BATCH_EPOCHS) closeBatch();
+}
+
+void MqttPublisher::closeBatch() {
+  if (_batchEpochs == 0) return;
+  _batch[_batchLen++] = ']';
+
+  // Keep ordering: fresh batches go behind anything already queued
+  if (!(_connected && _queuedBatches == 0 && publishBatch(_batch, _batchLen))) {
+    enqueue(_batch, _batchLen);
+  }
+  _batchLen = 0;
+  _batchEpochs = 0;
+}
+
+bool MqttPublisher::publishBatch(const char *payload, size_t len) {
+  // publish() returns 0 when the packet could not be handed to TCP
+  if (_client.publish(_fixTopic, MQTT_QOS, false, payload, len) == 0) {
+    return false;
+  }
+  _published++;
+  return true;
+}
+
+void MqttPublisher::publishStats(const char *json, size_t len) {
+  if (!_connected) return; // Statistics are only meaningful live, never queued
+  _client.publish(_statsTopic, 0, true, json, len);
+}
+
+// ============================================================================
+// OFFLINE QUEUE (PSRAM RING)
+// ============================================================================
+bool MqttPublisher::enqueue(const char *payload, size_t len) {
+  size_t need = len + sizeof(uint16_t);
+  if (_queue == nullptr || need > MQTT_QUEUE_BYTES) {
+    _dropped++;
+    return false;
+  }
+
+  // Oldest data goes first when the queue is full
+  while (_queueUsed + need > MQTT_QUEUE_BYTES) {
+    popQueued();
+    _dropped++;
+  }
+
+  uint16_t len16 = len;
+  ringWrite(&len16, sizeof(len16));
+  ringWrite(payload, len);
+  _queuedBatches++;
+  return true;
+}
+
+size_t MqttPublisher::peekQueued(char *out, size_t cap) {
+  uint16_t len16;
+  ringRead(_queueHead, &len16, sizeof(len16));
+  if (len16 > cap) return 0; // Cannot happen: batches are built in a buffer of the same size
+  ringRead((_queueHead + sizeof(len16)) % MQTT_QUEUE_BYTES, out, len16);
+  return len16;
+}
+
+void MqttPublisher::popQueued() {
+  if (_queuedBatches == 0) return;
+  uint16_t len16;
+  ringRead(_queueHead, &len16, sizeof(len16));
+  size_t size = len16 + sizeof(len16);
+  _queueHead = (_queueHead + size) % MQTT_QUEUE_BYTES;
+  _queueUsed -= size;
+  _queuedBatches--;
+}
+
+void MqttPublisher::ringWrite(const void *src, size_t len) {
+  size_t tail = (_queueHead + _queueUsed) % MQTT_QUEUE_BYTES;
+  size_t first = min(len, (size_t)MQTT_QUEUE_BYTES - tail);
+  memcpy(_queue + tail, src, first);
+  memcpy(_queue, (const uint8_t *)src + first, len - first);
+  _queueUsed += len;
+}
+
+void MqttPublisher::ringRead(size_t pos, void *dst, size_t len) {
+  size_t first = min(len, (size_t)MQTT_QUEUE_BYTES - pos);
+  memcpy(dst, _queue + pos, first);
+  memcpy((uint8_t *)dst + first, _queue, len - first);
+}
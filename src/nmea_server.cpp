@@ -0,0 +1,231 @@
+// NMEA TCP fan-out server
+// See nmea_server.h for the buffer sharing and slow-client policy.
+
+#include "nmea_server.h"
+#include "lock_guard.h"
+
+NmeaTcpServer::NmeaTcpServer(uint16_t port) : _server(port) {
+  memset(_slots, 0, sizeof(_slots));
+  memset(_clients, 0, sizeof(_clients));
+}
+
+// ============================================================================
+// START / STOP
+// ============================================================================
+void NmeaTcpServer::begin() {
+  if (_running) return;
+  if (_lock == nullptr) {
+    _lock = xSemaphoreCreateMutex();
+  }
+
+  _server.onClient([](void *arg, AsyncClient *tcp) {
+    static_cast<NmeaTcpServer *>(arg)->handleConnect(tcp);
+  }, this);
+  _server.setNoDelay(true);
+  _server.begin();
+  _running = true;
+  DEBUG_PRINTF("NMEA TCP server started on port %d\n", NMEA_TCP_PORT);
+}
+
+void NmeaTcpServer::end() {
+  if (!_running) return;
+  _running = false;
+  _server.end();
+
+  // Close outside the lock: close() fires the disconnect callback synchronously
+  AsyncClient *toClose[NMEA_TCP_MAX_CLIENTS];
+  size_t n = 0;
+  {
+    LockGuard guard(_lock);
+    for (Client &c : _clients) {
+      if (c.tcp != nullptr) toClose[n++] = c.tcp;
+    }
+  }
+  for (size_t i = 0; i < n; i++) {
+    toClose[i]->close(true);
+  }
+  DEBUG_PRINTLN("NMEA TCP server stopped");
+}
+
+// ============================================================================
+// BROADCAST
+// ============================================================================
+void NmeaTcpServer::broadcast(const char *sentence, size_t len) {
+  if (!_running || _clientCount == 0) return;
+  if (len > NMEA_MAX_SENTENCE) len = NMEA_MAX_SENTENCE;
+
+  LockGuard guard(_lock);
+  int slot = acquireSlot();
+  if (slot < 0) {
+    // Pool exhausted: every client misses this sentence
+    for (Client &c : _clients) {
+      if (c.tcp != nullptr) c.drops++;
+    }
+    _totalDrops += _clientCount;
+    return;
+  }
+
+  Slot &s = _slots[slot];
+  memcpy(s.data, sentence, len);
+  s.data[len] = '\r';
+  s.data[len + 1] = '\n';
+  s.len = len + 2;
+  s.refs = 1; // Held by the producer until the fan-out is done
+
+  for (Client &c : _clients) {
+    if (c.tcp == nullptr) continue;
+    if (c.latest < 0 && trySend(c, slot)) continue;
+
+    // Lagging client: only the newest sentence is kept
+    if (c.latest >= 0) {
+      releaseSlot(c.latest);
+      c.drops++;
+      _totalDrops++;
+    }
+    c.latest = slot;
+    s.refs++;
+  }
+
+  releaseSlot(slot);
+}
+
+int NmeaTcpServer::acquireSlot() {
+  // Round-robin so a freed slot is not rewritten right away
+  for (size_t i = 0; i < NMEA_TCP_POOL_SLOTS; i++) {
+    uint8_t idx = (_nextSlot + i) % NMEA_TCP_POOL_SLOTS;
+    if (_slots[idx].refs == 0) {
+      _nextSlot = (idx + 1) % NMEA_TCP_POOL_SLOTS;
+      return idx;
+    }
+  }
+  return -1;
+}
+
+void NmeaTcpServer::releaseSlot(int slot) {
+  if (_slots[slot].refs > 0) _slots[slot].refs--;
+}
+
+bool NmeaTcpServer::trySend(Client &client, int slot) {
+  if (client.inflightCount >= NMEA_TCP_CLIENT_INFLIGHT) return false;
+
+  Slot &s = _slots[slot];
+  if (!client.tcp->canSend() || client.tcp->space() < s.len) return false;
+
+  // No ASYNC_WRITE_FLAG_COPY: lwIP keeps a reference to the slot until ACK
+  if (client.tcp->add(s.data, s.len, 0) != s.len) return false;
+  client.tcp->send();
+
+  uint8_t tail = (client.inflightHead + client.inflightCount) % NMEA_TCP_CLIENT_INFLIGHT;
+  client.inflight[tail] = slot;
+  client.inflightCount++;
+  s.refs++;
+
+  client.bytesSent += s.len;
+  client.sentencesSent++;
+  _totalBytesSent += s.len;
+  return true;
+}
+
+NmeaTcpServer::Client *NmeaTcpServer::findClient(AsyncClient *tcp) {
+  for (Client &c : _clients) {
+    if (c.tcp == tcp) return &c;
+  }
+  return nullptr;
+}
+
+// ============================================================================
+// CLIENT CALLBACKS (AsyncTCP task)
+// ============================================================================
+void NmeaTcpServer::handleConnect(AsyncClient *tcp) {
+  tcp->onDisconnect([](void *arg, AsyncClient *c) {
+    static_cast<NmeaTcpServer *>(arg)->handleDisconnect(c);
+  }, this);
+  tcp->onAck([](void *arg, AsyncClient *c, size_t len, uint32_t) {
+    static_cast<NmeaTcpServer *>(arg)->handleAck(c, len);
+  }, this);
+  tcp->setNoDelay(true);
+
+  Client *entry = nullptr;
+  if (_running) {
+    LockGuard guard(_lock);
+    entry = findClient(nullptr);
+    if (entry != nullptr) {
+      memset(entry, 0, sizeof(Client));
+      entry->tcp = tcp;
+      entry->id = _nextClientId++;
+      entry->latest = -1;
+      entry->connectedAt = millis();
+      _clientCount++;
+    }
+  }
+
+  if (entry == nullptr) {
+    DEBUG_PRINTF("NMEA TCP client %s rejected (server full)\n", tcp->remoteIP().toString().c_str());
+    tcp->close(true);
+    return;
+  }
+  DEBUG_PRINTF("NMEA TCP client #%u connected from %s\n", entry->id, tcp->remoteIP().toString().c_str());
+}
+
+void NmeaTcpServer::handleDisconnect(AsyncClient *tcp) {
+  {
+    LockGuard guard(_lock);
+    Client *c = findClient(tcp);
+    if (c != nullptr) {
+      DEBUG_PRINTF("NMEA TCP client #%u disconnected (%u bytes, %u drops)\n",
+                   c->id, c->bytesSent, c->drops);
+      while (c->inflightCount > 0) {
+        releaseSlot(c->inflight[c->inflightHead]);
+        c->inflightHead = (c->inflightHead + 1) % NMEA_TCP_CLIENT_INFLIGHT;
+        c->inflightCount--;
+      }
+      if (c->latest >= 0) releaseSlot(c->latest);
+      c->tcp = nullptr;
+      _clientCount--;
+    }
+  }
+  delete tcp;
+}
+
+void NmeaTcpServer::handleAck(AsyncClient *tcp, size_t len) {
+  LockGuard guard(_lock);
+  Client *c = findClient(tcp);
+  if (c == nullptr) return;
+
+  c->ackCarry += len;
+  while (c->inflightCount > 0) {
+    uint8_t slot = c->inflight[c->inflightHead];
+    if (c->ackCarry < _slots[slot].len) break;
+    c->ackCarry -= _slots[slot].len;
+    releaseSlot(slot);
+    c->inflightHead = (c->inflightHead + 1) % NMEA_TCP_CLIENT_INFLIGHT;
+    c->inflightCount--;
+  }
+
+  // Window reopened: push the most recent sentence of a lagging client
+  if (c->latest >= 0 && trySend(*c, c->latest)) {
+    releaseSlot(c->latest);
+    c->latest = -1;
+  }
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+size_t NmeaTcpServer::getClientStats(ClientStats *out, size_t maxCount) {
+  if (_lock == nullptr) return 0;
+
+  LockGuard guard(_lock);
+  size_t n = 0;
+  for (const Client &c : _clients) {
+    if (c.tcp == nullptr || n >= maxCount) continue;
+    out[n].id = c.id;
+    out[n].ip = c.tcp->remoteIP();
+    out[n].bytesSent = c.bytesSent;
+    out[n].sentencesSent = c.sentencesSent;
+    out[n].drops = c.drops;
+    out[n].connectedMs = millis() - c.connectedAt;
+    n++;
+  }
+  return n;
+}
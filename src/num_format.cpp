@@ -0,0 +1,150 @@
+// Allocation-free number formatting
+
+#include "num_format.h"
+#include <math.h>
+#include <string.h>
+
+static const uint64_t POW10[] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL
+};
+#define FMT_MAX_DECIMALS 9
+
+namespace {
+// Bounded writer over the caller's buffer, always NUL-terminated
+struct Out {
+  char *buf;
+  size_t cap;
+  size_t len = 0;
+
+  Out(char *b, size_t c) : buf(b), cap(c) {
+    if (cap) buf[0] = '\0';
+  }
+  void put(char c) {
+    if (len + 1 >= cap) return;
+    buf[len++] = c;
+    buf[len] = '\0';
+  }
+  void put(const char *s) {
+    while (*s) put(*s++);
+  }
+  // At least minDigits digits, zero padded
+  void digits(uint64_t v, uint8_t minDigits = 1) {
+    char tmp[20];
+    uint8_t n = 0;
+    do {
+      tmp[n++] = '0' + v % 10;
+      v /= 10;
+    } while (v != 0);
+    while (n < minDigits && n < sizeof(tmp)) tmp[n++] = '0';
+    while (n) put(tmp[--n]);
+  }
+};
+} // namespace
+
+size_t fmtUint(char *out, size_t cap, uint32_t value) {
+  Out o(out, cap);
+  o.digits(value);
+  return o.len;
+}
+
+size_t fmtScaled(char *out, size_t cap, int64_t value, uint8_t valueDecimals, const NumFormat &f) {
+  Out o(out, cap);
+  uint8_t decimals = f.decimals > FMT_MAX_DECIMALS ? FMT_MAX_DECIMALS : f.decimals;
+  if (valueDecimals > FMT_MAX_DECIMALS) valueDecimals = FMT_MAX_DECIMALS;
+
+  bool negative = value < 0;
+  uint64_t mag = negative ? -(uint64_t)value : (uint64_t)value;
+  // Round half away from zero to the requested decimals
+  if (valueDecimals > decimals) {
+    uint64_t div = POW10[valueDecimals - decimals];
+    mag = (mag + div / 2) / div;
+  } else {
+    mag *= POW10[decimals - valueDecimals];
+  }
+
+  if (negative && mag != 0) o.put('-'); // No "-0.0"
+  o.digits(mag / POW10[decimals]);
+  if (decimals) {
+    o.put('.');
+    o.digits(mag % POW10[decimals], decimals);
+  }
+
+  if (f.maxDigits && o.len > f.maxDigits) {
+    o.len = f.maxDigits;
+    out[o.len] = '\0';
+  }
+  o.put(f.unit);
+  return o.len;
+}
+
+size_t fmtFloat(char *out, size_t cap, double value, const NumFormat &f) {
+  uint8_t decimals = f.decimals > FMT_MAX_DECIMALS ? FMT_MAX_DECIMALS : f.decimals;
+  double scaled = value * POW10[decimals];
+  if (!isfinite(scaled) || fabs(scaled) >= 9.0e18) {
+    Out o(out, cap);
+    o.put(FMT_MISSING);
+    return o.len;
+  }
+  return fmtScaled(out, cap, llround(scaled), decimals, f);
+}
+
+size_t fmtFloatIf(bool valid, char *out, size_t cap, double value, const NumFormat &f) {
+  if (valid) return fmtFloat(out, cap, value, f);
+  Out o(out, cap);
+  o.put(FMT_MISSING);
+  return o.len;
+}
+
+size_t fmtScaledIf(bool valid, char *out, size_t cap, int64_t value, uint8_t valueDecimals, const NumFormat &f) {
+  if (valid) return fmtScaled(out, cap, value, valueDecimals, f);
+  Out o(out, cap);
+  o.put(FMT_MISSING);
+  return o.len;
+}
+
+size_t fmtDuration(char *out, size_t cap, uint32_t seconds, const DurationFormat &f) {
+  Out o(out, cap);
+  uint32_t minutes = seconds / 60;
+  if (f.hours) {
+    o.digits(minutes / 60);
+    o.put(f.h);
+    minutes %= 60;
+  }
+  o.digits(minutes);
+  o.put(f.m);
+  o.digits(seconds % 60);
+  o.put(f.s);
+  return o.len;
+}
+
+size_t fmtAge(char *out, size_t cap, uint32_t ms, const AgeFormat &f) {
+  Out o(out, cap);
+  if (ms < 1000) {
+    o.digits(ms);
+    o.put(f.ms);
+  } else {
+    o.digits(ms / 1000);
+    o.put(f.s);
+  }
+  return o.len;
+}
+
+size_t fmtClock(char *out, size_t cap, uint8_t hour, uint8_t minute, uint8_t second) {
+  Out o(out, cap);
+  o.digits(hour, 2);
+  o.put(':');
+  o.digits(minute, 2);
+  o.put(':');
+  o.digits(second, 2);
+  return o.len;
+}
+
+size_t fmtDate(char *out, size_t cap, uint8_t day, uint8_t month, uint16_t year) {
+  Out o(out, cap);
+  o.digits(day, 2);
+  o.put('/');
+  o.digits(month, 2);
+  o.put('/');
+  o.digits(year, 4);
+  return o.len;
+}
@@ -0,0 +1,72 @@
+// Per-stage loop profiler
+
+#include "profiler.h"
+
+StageProfiler profiler;
+
+const char *const PROFILE_STAGE_NAMES[STAGE_COUNT] = {
+  "wifi", "button", "gps", "led", "display", "web", "mqtt", "loop"
+};
+
+// Cycles -> microseconds at the current CPU clock
+static inline uint32_t cyclesToUs(uint64_t cycles) {
+  return cycles / getCpuFrequencyMhz();
+}
+
+// Log-linear bucket: octave * 4 + the two bits below the leading one
+uint8_t StageProfiler::bucketIndex(uint32_t cycles) {
+  if (cycles < PROFILE_SUB_BUCKETS) return cycles;
+  uint8_t octave = 31 - __builtin_clz(cycles);
+  uint8_t sub = (cycles >> (octave - 2)) & (PROFILE_SUB_BUCKETS - 1);
+  return octave * PROFILE_SUB_BUCKETS + sub;
+}
+
+uint32_t StageProfiler::bucketUpperBound(uint8_t index) {
+  if (index < PROFILE_SUB_BUCKETS) return index;
+  uint8_t octave = index / PROFILE_SUB_BUCKETS;
+  uint8_t sub = index % PROFILE_SUB_BUCKETS;
+  uint64_t bound = ((uint64_t)(PROFILE_SUB_BUCKETS + sub + 1) << (octave - 2)) - 1;
+  return bound > UINT32_MAX ? UINT32_MAX : bound;
+}
+
+void StageProfiler::record(ProfileStage stage, uint32_t cycles) {
+  Stage &s = _stages[stage];
+  uint32_t bit = 1UL << stage;
+  if (_resetPending.load(std::memory_order_relaxed) & bit) {
+    _resetPending.fetch_and(~bit, std::memory_order_relaxed);
+    memset(&s, 0, sizeof(s));
+  }
+  s.buckets[bucketIndex(cycles)]++;
+  if (s.count == 0 || cycles < s.minCycles) s.minCycles = cycles;
+  if (cycles > s.maxCycles) s.maxCycles = cycles;
+  s.sumCycles += cycles;
+  s.count++;
+}
+
+void StageProfiler::reset() {
+  _resetPending.store((1UL << STAGE_COUNT) - 1, std::memory_order_relaxed);
+}
+
+StageStats StageProfiler::stats(ProfileStage stage) const {
+  const Stage &s = _stages[stage];
+  StageStats out = {};
+  out.count = s.count;
+  if (s.count == 0) return out;
+
+  out.minUs = cyclesToUs(s.minCycles);
+  out.maxUs = cyclesToUs(s.maxCycles);
+  out.avgUs = cyclesToUs(s.sumCycles / s.count);
+
+  // p99 = upper bound of the bucket holding the 99th percentile sample
+  uint32_t target = s.count - s.count / 100;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) {
+    seen += s.buckets[i];
+    if (seen >= target) {
+      uint32_t bound = bucketUpperBound(i);
+      out.p99Us = cyclesToUs(bound < s.maxCycles ? bound : s.maxCycles);
+      break;
+    }
+  }
+  return out;
+}
@@ -0,0 +1,176 @@
+// Satellites in view
+
+#include "sat_table.h"
+
+SatTable satTable;
+
+const char GNSS_LETTERS[GNSS_COUNT] = {'G', 'R', 'E', 'C', 'J', 'S', '?'};
+
+#define NMEA_MAX_FIELDS 24
+
+// GN (mixed) and unknown talkers are GNSS_OTHER, resolved per PRN
+static GnssSystem talkerSystem(const char *talker) {
+  if (talker[0] == 'G') {
+    switch (talker[1]) {
+      case 'P': return GNSS_GPS;
+      case 'L': return GNSS_GLONASS;
+      case 'A': return GNSS_GALILEO;
+      case 'B': return GNSS_BEIDOU;
+      case 'Q': return GNSS_QZSS;
+    }
+  }
+  if (talker[0] == 'B' && talker[1] == 'D') return GNSS_BEIDOU;
+  if (talker[0] == 'Q' && talker[1] == 'Z') return GNSS_QZSS;
+  return GNSS_OTHER;
+}
+
+// NMEA PRN numbering (u-blox extended ranges included)
+static GnssSystem satSystem(GnssSystem talker, uint16_t prn) {
+  if (talker == GNSS_GPS) {
+    if (prn >= 33 && prn <= 64) return GNSS_SBAS;
+    if (prn >= 193 && prn <= 202) return GNSS_QZSS;
+    return GNSS_GPS;
+  }
+  if (talker != GNSS_OTHER) return talker;
+  if (prn >= 1 && prn <= 32) return GNSS_GPS;
+  if (prn <= 64) return GNSS_SBAS;
+  if (prn <= 96) return GNSS_GLONASS;
+  if (prn >= 193 && prn <= 200) return GNSS_QZSS;
+  if (prn >= 201 && prn <= 263) return GNSS_BEIDOU;
+  if (prn >= 301 && prn <= 336) return GNSS_GALILEO;
+  if (prn >= 401 && prn <= 463) return GNSS_BEIDOU;
+  return GNSS_OTHER;
+}
+
+// NMEA 4.10 GSA system ID (last field)
+static GnssSystem gsaSystemId(const char *field) {
+  switch (atoi(field)) {
+    case 1: return GNSS_GPS;
+    case 2: return GNSS_GLONASS;
+    case 3: return GNSS_GALILEO;
+    case 4: return GNSS_BEIDOU;
+    case 5: return GNSS_QZSS;
+    default: return GNSS_OTHER;
+  }
+}
+
+// ============================================================================
+// SENTENCE DISPATCH
+// ============================================================================
+void SatTable::onSentence(const char *sentence, size_t len) {
+  if (len < 7) return;
+  bool isGsv = strncmp(sentence + 3, "GSV,", 4) == 0;
+  bool isGsa = strncmp(sentence + 3, "GSA,", 4) == 0;
+  if (!isGsa) _inGsaBatch = false;
+  if (!isGsv && !isGsa) return;
+
+  // Split a copy into fields, dropping the checksum
+  char line[96];
+  if (len >= sizeof(line)) return;
+  memcpy(line, sentence, len);
+  line[len] = '\0';
+  char *star = strchr(line, '*');
+  if (star) *star = '\0';
+
+  char *fields[NMEA_MAX_FIELDS];
+  uint8_t count = 0;
+  char *p = line;
+  while (count < NMEA_MAX_FIELDS) {
+    fields[count++] = p;
+    p = strchr(p, ',');
+    if (p == nullptr) break;
+    *p++ = '\0';
+  }
+
+  GnssSystem talker = talkerSystem(sentence + 1);
+  if (isGsv) {
+    parseGsv(talker, fields, count);
+  } else {
+    parseGsa(talker, fields, count);
+  }
+}
+
+SatTable::Entry *SatTable::find(GnssSystem system, uint16_t prn) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_entries[i].info.prn == prn && _entries[i].info.system == system) return &_entries[i];
+  }
+  return nullptr;
+}
+
+// ============================================================================
+// GSV: $xxGSV,numMsg,msgNum,inView{,prn,elev,az,snr}[,signalId]
+// ============================================================================
+void SatTable::parseGsv(GnssSystem talker, char **fields, uint8_t count) {
+  if (count < 4) return;
+  // NMEA 4.10: an odd field after the satellite groups is the signal ID
+  if ((count - 4) % 4 == 1 && atoi(fields[count - 1]) > 1) return;
+
+  uint8_t numMsg = atoi(fields[1]);
+  uint8_t msgNum = atoi(fields[2]);
+  if (msgNum == 1) _cycle[talker]++;
+  uint8_t cycle = _cycle[talker];
+
+  for (uint8_t f = 4; f + 3 < count; f += 4) {
+    if (*fields[f] == '\0') continue;
+    uint16_t prn = atoi(fields[f]);
+    GnssSystem system = satSystem(talker, prn);
+    Entry *e = find(system, prn);
+    if (e == nullptr) {
+      if (_count == SAT_TABLE_SIZE) {
+        _dropped++;
+        continue;
+      }
+      e = &_entries[_count++];
+      e->info = {};
+      e->info.prn = prn;
+      e->info.system = system;
+    }
+    e->talker = talker;
+    e->cycle = cycle;
+    e->info.elevation = *fields[f + 1] ? atoi(fields[f + 1]) : SAT_ELEVATION_UNKNOWN;
+    e->info.azimuth = atoi(fields[f + 2]);
+    e->info.snr = atoi(fields[f + 3]); // Empty when not tracked
+  }
+
+  // End of the cycle: drop this talker's satellites it no longer reports
+  if (msgNum == numMsg) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_entries[i].talker == talker && _entries[i].cycle != cycle) continue;
+      _entries[kept++] = _entries[i];
+    }
+    _count = kept;
+  }
+}
+
+// ============================================================================
+// GSA: $xxGSA,mode,fixType,prn x 12,PDOP,HDOP,VDOP[,systemId]
+// ============================================================================
+void SatTable::parseGsa(GnssSystem talker, char **fields, uint8_t count) {
+  // Multi-GNSS receivers send one GSA per constellation back to back
+  if (!_inGsaBatch) {
+    for (uint8_t i = 0; i < _count; i++) _entries[i].info.used = false;
+    _inGsaBatch = true;
+  }
+  if (count < 15) return;
+  if (count >= 19) {
+    GnssSystem id = gsaSystemId(fields[18]);
+    if (id != GNSS_OTHER) talker = id;
+  }
+
+  for (uint8_t f = 3; f < 15; f++) {
+    if (*fields[f] == '\0') continue;
+    uint16_t prn = atoi(fields[f]);
+    Entry *e = find(satSystem(talker, prn), prn);
+    if (e) e->info.used = true;
+  }
+}
+
+void SatTable::view(SkyView *out) const {
+  out->count = _count;
+  out->used = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    out->sats[i] = _entries[i].info;
+    if (_entries[i].info.used) out->used++;
+  }
+}
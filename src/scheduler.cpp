@@ -0,0 +1,152 @@
+// Cooperative job scheduler
+
+#include "scheduler.h"
+
+#define US_PER_MS ((int64_t)1000)
+#define MAX_SLEEP_MS ((int64_t)60000) // Keeps pdMS_TO_TICKS from overflowing
+
+JobId Scheduler::every(const char *name, uint32_t periodMs, JobFn fn) {
+  JobId job = add(name, periodMs, fn);
+  schedule(job, esp_timer_get_time() + periodMs * US_PER_MS);
+  return job;
+}
+
+JobId Scheduler::onTrigger(const char *name, JobFn fn) {
+  return add(name, 0, fn);
+}
+
+JobId Scheduler::add(const char *name, uint32_t periodMs, JobFn fn) {
+  configASSERT(_jobCount < SCHEDULER_MAX_JOBS); // Registration happens at boot: raise SCHEDULER_MAX_JOBS
+  Job &j = _jobs[_jobCount];
+  j.fn = fn;
+  j.deadlineUs = 0;
+  j.heapPos = NOT_QUEUED;
+  j.stats = {};
+  j.stats.name = name;
+  j.stats.periodMs = periodMs;
+  return _jobCount++;
+}
+
+void Scheduler::trigger(JobId job) {
+  _triggered.fetch_or(1UL << job, std::memory_order_release);
+  TaskHandle_t owner = _owner.load(std::memory_order_acquire);
+  if (owner != nullptr) xTaskNotifyGive(owner);
+}
+
+// ============================================================================
+// RUNNING
+// ============================================================================
+void Scheduler::runDue() {
+  if (_owner.load(std::memory_order_relaxed) == nullptr) {
+    _owner.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+  }
+
+  int64_t now = esp_timer_get_time();
+  uint32_t triggered = _triggered.exchange(0, std::memory_order_acquire);
+  for (JobId job = 0; triggered != 0; job++, triggered >>= 1) {
+    if (triggered & 1) schedule(job, now);
+  }
+
+  // Triggers and deadlines that come up while the jobs run wait for the next call
+  int64_t cutoff = now;
+  while (_heapSize > 0 && _jobs[_heap[0]].deadlineUs <= cutoff) {
+    run(_heap[0], now);
+    now = esp_timer_get_time();
+  }
+}
+
+void Scheduler::run(JobId job, int64_t nowUs) {
+  Job &j = _jobs[job];
+  JobStats &s = j.stats;
+  int64_t deadline = j.deadlineUs;
+
+  j.fn();
+  int64_t end = esp_timer_get_time();
+
+  uint32_t runUs = end - nowUs;
+  s.runs++;
+  s.busyUs += runUs;
+  if (runUs > s.maxRunUs) s.maxRunUs = runUs;
+
+  if (s.periodMs == 0) {
+    // Back to waiting for a trigger
+    _heap[0] = _heap[--_heapSize];
+    _jobs[_heap[0]].heapPos = 0;
+    j.heapPos = NOT_QUEUED;
+    if (_heapSize > 0) siftDown(0);
+    return;
+  }
+
+  uint32_t lateUs = nowUs > deadline ? nowUs - deadline : 0;
+  if (lateUs > s.maxLateUs) s.maxLateUs = lateUs;
+  int64_t periodUs = s.periodMs * US_PER_MS;
+  int64_t next = deadline + periodUs;
+  if (next <= end) {
+    s.overruns++;
+    next = end + periodUs;
+  }
+  schedule(job, next);
+}
+
+void Scheduler::waitNext() {
+  int64_t now = esp_timer_get_time();
+  TickType_t ticks = portMAX_DELAY;
+  if (_heapSize > 0) {
+    int64_t untilUs = _jobs[_heap[0]].deadlineUs;
+    int64_t waitMs = untilUs > now ? min((untilUs - now + US_PER_MS - 1) / US_PER_MS, MAX_SLEEP_MS) : 0;
+    ticks = pdMS_TO_TICKS(waitMs);
+  }
+  if (ticks > 0 && _triggered.load(std::memory_order_relaxed) == 0) {
+    ulTaskNotifyTake(pdTRUE, ticks);
+    _idleUs += esp_timer_get_time() - now;
+  }
+  _wakeups++;
+}
+
+// ============================================================================
+// DEADLINE HEAP
+// ============================================================================
+void Scheduler::schedule(JobId job, int64_t deadlineUs) {
+  Job &j = _jobs[job];
+  if (j.heapPos == NOT_QUEUED) {
+    j.heapPos = _heapSize;
+    _heap[_heapSize++] = job;
+    j.deadlineUs = deadlineUs;
+    siftUp(j.heapPos);
+  } else if (deadlineUs < j.deadlineUs) {
+    j.deadlineUs = deadlineUs;
+    siftUp(j.heapPos);
+  } else {
+    j.deadlineUs = deadlineUs;
+    siftDown(j.heapPos);
+  }
+}
+
+void Scheduler::siftUp(uint8_t pos) {
+  while (pos > 0) {
+    uint8_t parent = (pos - 1) / 2;
+    if (_jobs[_heap[parent]].deadlineUs <= _jobs[_heap[pos]].deadlineUs) break;
+    swap(pos, parent);
+    pos = parent;
+  }
+}
+
+void Scheduler::siftDown(uint8_t pos) {
+  for (;;) {
+    uint8_t smallest = pos;
+    uint8_t left = 2 * pos + 1, right = left + 1;
+    if (left < _heapSize && _jobs[_heap[left]].deadlineUs < _jobs[_heap[smallest]].deadlineUs) smallest = left;
+    if (right < _heapSize && _jobs[_heap[right]].deadlineUs < _jobs[_heap[smallest]].deadlineUs) smallest = right;
+    if (smallest == pos) return;
+    swap(pos, smallest);
+    pos = smallest;
+  }
+}
+
+void Scheduler::swap(uint8_t a, uint8_t b) {
+  JobId ja = _heap[a];
+  _heap[a] = _heap[b];
+  _heap[b] = ja;
+  _jobs[_heap[a]].heapPos = a;
+  _jobs[_heap[b]].heapPos = b;
+}
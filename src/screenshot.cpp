@@ -0,0 +1,219 @@
+// TFT screenshots over HTTP
+
+#include "screenshot.h"
+#include "frame_buffer.h"
+#include <ESPAsyncWebServer.h>
+#include <esp_rom_crc.h>
+#include <memory>
+
+#define BMP_HEADER_BYTES (14 + 40 + 12)   // File header, BITMAPINFOHEADER, RGB565 masks
+#define BMP_ROW_BYTES    (TFT_WIDTH * 2)
+#define BMP_FILE_BYTES   (BMP_HEADER_BYTES + BMP_ROW_BYTES * TFT_HEIGHT)
+#define PNG_ROW_BYTES    (1 + TFT_WIDTH * 3)                      // Filter byte + RGB
+#define PNG_BLOCK_BYTES  (5 + PNG_ROW_BYTES)                      // Stored deflate block
+#define PNG_IDAT_BYTES   (2 + PNG_BLOCK_BYTES * TFT_HEIGHT + 4)   // zlib header, rows, Adler-32
+
+static_assert(BMP_ROW_BYTES % 4 == 0, "BMP rows would need padding");
+static_assert(PNG_ROW_BYTES <= 0xFFFF, "A stored deflate block holds at most 64 KB");
+
+namespace {
+struct ScreenshotStream {
+  ScreenshotFormat format;
+  int16_t row = -1;    // -1: header, TFT_HEIGHT: trailer
+  bool done = false;
+  uint32_t crc = 0;    // PNG: IDAT chunk CRC-32 so far
+  uint32_t adler = 1;  // PNG: zlib Adler-32 of the rows so far
+  size_t len = 0;      // Bytes staged in buf
+  size_t pos = 0;      // Bytes already handed to the response
+  uint16_t pixels[TFT_WIDTH];
+  uint8_t buf[PNG_BLOCK_BYTES]; // Largest stage: one PNG row
+};
+
+uint8_t *putLe16(uint8_t *p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  return p + 2;
+}
+
+uint8_t *putLe32(uint8_t *p, uint32_t v) {
+  return putLe16(putLe16(p, v), v >> 16);
+}
+
+uint8_t *putBe32(uint8_t *p, uint32_t v) {
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+  return p + 4;
+}
+
+uint8_t *putBytes(uint8_t *p, const void *src, size_t n) {
+  memcpy(p, src, n);
+  return p + n;
+}
+
+// Standard (zlib) CRC-32, chained: crc32(crc32(0, a), b) == crc32(0, a + b)
+uint32_t crc32(uint32_t crc, const uint8_t *p, size_t n) {
+  return esp_rom_crc32_le(crc, p, n);
+}
+
+// ============================================================================
+// BMP
+// ============================================================================
+size_t bmpHeader(uint8_t *out) {
+  uint8_t *p = out;
+  *p++ = 'B';
+  *p++ = 'M';
+  p = putLe32(p, BMP_FILE_BYTES);
+  p = putLe32(p, 0);
+  p = putLe32(p, BMP_HEADER_BYTES);  // Pixel data offset
+
+  p = putLe32(p, 40);
+  p = putLe32(p, TFT_WIDTH);
+  p = putLe32(p, (uint32_t)-TFT_HEIGHT); // Negative: top-down rows
+  p = putLe16(p, 1);                 // Planes
+  p = putLe16(p, 16);                // Bits per pixel
+  p = putLe32(p, 3);                 // BI_BITFIELDS
+  p = putLe32(p, BMP_ROW_BYTES * TFT_HEIGHT);
+  p = putLe32(p, 2835);              // 72 dpi
+  p = putLe32(p, 2835);
+  p = putLe32(p, 0);
+  p = putLe32(p, 0);
+
+  p = putLe32(p, 0xF800);
+  p = putLe32(p, 0x07E0);
+  p = putLe32(p, 0x001F);
+  return p - out;
+}
+
+size_t bmpRow(ScreenshotStream &s) {
+  uint8_t *p = s.buf;
+  for (int16_t x = 0; x < TFT_WIDTH; x++) {
+    p = putLe16(p, s.pixels[x]);
+  }
+  return p - s.buf;
+}
+
+// ============================================================================
+// PNG
+// ============================================================================
+size_t pngHeader(ScreenshotStream &s) {
+  static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  uint8_t *p = putBytes(s.buf, SIGNATURE, sizeof(SIGNATURE));
+
+  p = putBe32(p, 13);
+  uint8_t *ihdr = p;
+  p = putBytes(p, "IHDR", 4);
+  p = putBe32(p, TFT_WIDTH);
+  p = putBe32(p, TFT_HEIGHT);
+  *p++ = 8;  // Bit depth
+  *p++ = 2;  // RGB
+  *p++ = 0;  // Deflate
+  *p++ = 0;  // Adaptive filtering (every row uses "none")
+  *p++ = 0;  // Not interlaced
+  p = putBe32(p, crc32(0, ihdr, p - ihdr));
+
+  // One IDAT chunk: its CRC goes out after the last row
+  p = putBe32(p, PNG_IDAT_BYTES);
+  uint8_t *idat = p;
+  p = putBytes(p, "IDAT", 4);
+  *p++ = 0x78; // zlib: deflate, 32 KB window
+  *p++ = 0x01; // No preset dictionary, check bits
+  s.crc = crc32(0, idat, p - idat);
+  return p - s.buf;
+}
+
+size_t pngRow(ScreenshotStream &s) {
+  uint8_t *p = s.buf;
+  *p++ = s.row == TFT_HEIGHT - 1 ? 1 : 0; // BFINAL on the last block, BTYPE 00 (stored)
+  p = putLe16(p, PNG_ROW_BYTES);
+  p = putLe16(p, ~PNG_ROW_BYTES);
+
+  uint8_t *row = p;
+  *p++ = 0; // Filter: none
+  for (int16_t x = 0; x < TFT_WIDTH; x++) {
+    uint16_t c = s.pixels[x];
+    uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+    *p++ = (r << 3) | (r >> 2);
+    *p++ = (g << 2) | (g >> 4);
+    *p++ = (b << 3) | (b >> 2);
+  }
+
+  // A row is far below the 5552 bytes Adler-32 sums can take before the modulo
+  uint32_t a = s.adler & 0xFFFF, b = s.adler >> 16;
+  for (const uint8_t *q = row; q < p; q++) {
+    a += *q;
+    b += a;
+  }
+  s.adler = ((b % 65521) << 16) | (a % 65521);
+
+  s.crc = crc32(s.crc, s.buf, p - s.buf);
+  return p - s.buf;
+}
+
+size_t pngTrailer(ScreenshotStream &s) {
+  uint8_t *p = putBe32(s.buf, s.adler);
+  s.crc = crc32(s.crc, s.buf, 4);
+  p = putBe32(p, s.crc);
+
+  p = putBe32(p, 0);
+  uint8_t *iend = p;
+  p = putBytes(p, "IEND", 4);
+  p = putBe32(p, crc32(0, iend, 4));
+  return p - s.buf;
+}
+
+// Stages the next part of the file in s.buf, false once everything was sent
+bool stageNext(ScreenshotStream &s) {
+  bool png = s.format == SCREENSHOT_PNG;
+  if (s.row < 0) {
+    s.len = png ? pngHeader(s) : bmpHeader(s.buf);
+  } else if (s.row < TFT_HEIGHT) {
+    frameBuffer.readShownRow(s.row, s.pixels);
+    s.len = png ? pngRow(s) : bmpRow(s);
+  } else if (s.row == TFT_HEIGHT && png) {
+    s.len = pngTrailer(s);
+  } else {
+    return false;
+  }
+  s.row++;
+  s.pos = 0;
+  return true;
+}
+} // namespace
+
+// ============================================================================
+// CHUNKED RESPONSE
+// ============================================================================
+void sendScreenshotResponse(AsyncWebServerRequest *request, ScreenshotFormat format) {
+  if (!frameBuffer.active()) {
+    request->send(503, "text/plain", "No framebuffer: the display is drawn directly");
+    return;
+  }
+
+  std::shared_ptr<ScreenshotStream> stream(new ScreenshotStream());
+  stream->format = format;
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse(
+      format == SCREENSHOT_PNG ? "image/png" : "image/bmp",
+      [stream](uint8_t *out, size_t maxLen, size_t) -> size_t {
+        size_t written = 0;
+        while (written < maxLen) {
+          if (stream->pos == stream->len) {
+            if (stream->done) break;
+            if (!stageNext(*stream)) {
+              stream->done = true;
+              break;
+            }
+            continue;
+          }
+          size_t n = min(maxLen - written, stream->len - stream->pos);
+          memcpy(out + written, stream->buf + stream->pos, n);
+          written += n;
+          stream->pos += n;
+        }
+        return written; // 0 ends the chunked response
+      });
+  response->addHeader("Cache-Control", "no-store");
+  request->send(response);
+}
@@ -0,0 +1,148 @@
+// Status NeoPixel engine
+
+#include "status_led.h"
+#include "lock_guard.h"
+#include "profiler.h"
+
+// WS2812 bit timings in RMT ticks: 80 MHz APB / 2 = 25 ns
+#define WS2812_T0H 16   // 0.40 us
+#define WS2812_T0L 34   // 0.85 us
+#define WS2812_T1H 32   // 0.80 us
+#define WS2812_T1L 18   // 0.45 us
+
+#define LED_RMT_RETRY_US 100 // Previous frame still on the wire
+
+StatusLed statusLed;
+
+void StatusLed::begin() {
+  _lock = xSemaphoreCreateMutex();
+
+  rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)PIN_NEOPIXEL, NEOPIXEL_RMT_CHANNEL);
+  config.clk_div = 2;
+  if (rmt_config(&config) != ESP_OK || rmt_driver_install(NEOPIXEL_RMT_CHANNEL, 0, 0) != ESP_OK) {
+    DEBUG_PRINTLN("  - NeoPixel RMT FAILED");
+    return;
+  }
+
+  esp_timer_create_args_t args = {};
+  args.callback = onTimer;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "led";
+  if (esp_timer_create(&args, &_timer) != ESP_OK) {
+    DEBUG_PRINTLN("  - NeoPixel timer FAILED");
+    _timer = nullptr;
+    return;
+  }
+  emit(NEOPIXEL_COLOR_OFF);
+}
+
+void StatusLed::set(LedPattern pattern, uint32_t color, uint32_t color2) {
+  if (_lock == nullptr) return;
+  {
+    LockGuard guard(_lock);
+    if (_request.pattern == pattern && _request.color == color && _request.color2 == color2) return;
+    _request = {pattern, color, color2};
+    _changed = true;
+  }
+  wake();
+}
+
+// Fires the timer at once; the retry covers step() re-arming it in between
+void StatusLed::wake() {
+  if (_timer == nullptr) return;
+  for (uint8_t i = 0; i < 2; i++) {
+    esp_timer_stop(_timer);
+    if (esp_timer_start_once(_timer, 0) == ESP_OK) break;
+  }
+}
+
+void StatusLed::onTimer(void *arg) {
+  static_cast<StatusLed *>(arg)->step();
+}
+
+// Shows the color for now and re-arms for the next change
+void StatusLed::step() {
+  PROFILE_STAGE(STAGE_LED);
+  int64_t now = esp_timer_get_time();
+  {
+    LockGuard guard(_lock);
+    if (_changed) {
+      _shownRequest = _request;
+      _startUs = now; // Patterns restart with the color on
+      _changed = false;
+    }
+  }
+
+  const Request &r = _shownRequest;
+  uint32_t elapsedMs = (now - _startUs) / 1000;
+  uint32_t color = NEOPIXEL_COLOR_OFF;
+  int64_t nextUs = -1; // Steady until the next set()
+  switch (r.pattern) {
+    case LED_OFF:
+      break;
+    case LED_SOLID:
+      color = r.color;
+      break;
+    case LED_BLINK:
+    case LED_ALTERNATE: {
+      uint32_t phase = elapsedMs / NEOPIXEL_BLINK_INTERVAL;
+      color = (phase & 1) == 0 ? r.color : (r.pattern == LED_BLINK ? NEOPIXEL_COLOR_OFF : r.color2);
+      nextUs = _startUs + (int64_t)(phase + 1) * NEOPIXEL_BLINK_INTERVAL * 1000;
+      break;
+    }
+    case LED_BREATHE: {
+      // Triangle wave, squared so the fade looks even to the eye
+      uint32_t t = elapsedMs % NEOPIXEL_BREATHE_PERIOD_MS;
+      uint32_t half = NEOPIXEL_BREATHE_PERIOD_MS / 2;
+      uint32_t level = (t < half ? t : NEOPIXEL_BREATHE_PERIOD_MS - t) * 255 / half;
+      level = level * level / 255;
+      uint8_t red = ((r.color >> 16) & 0xFF) * level / 255;
+      uint8_t green = ((r.color >> 8) & 0xFF) * level / 255;
+      uint8_t blue = (r.color & 0xFF) * level / 255;
+      color = ((uint32_t)red << 16) | ((uint32_t)green << 8) | blue;
+      nextUs = now + NEOPIXEL_BREATHE_STEP_MS * 1000;
+      break;
+    }
+  }
+
+  if (!emit(color)) {
+    nextUs = now + LED_RMT_RETRY_US;
+  }
+  if (nextUs >= 0) {
+    esp_timer_stop(_timer);
+    esp_timer_start_once(_timer, nextUs > now ? nextUs - now : 0);
+  }
+}
+
+// Sends the color unless it is already shown. False if the RMT channel is
+// still busy with the previous frame.
+bool StatusLed::emit(uint32_t color) {
+  uint8_t rgb[3] = {(uint8_t)(color >> 16), (uint8_t)(color >> 8), (uint8_t)color};
+  for (uint8_t i = 0; i < 3; i++) {
+    rgb[i] = (rgb[i] * (NEOPIXEL_BRIGHTNESS + 1)) >> 8;
+  }
+  uint32_t scaled = ((uint32_t)rgb[0] << 16) | ((uint32_t)rgb[1] << 8) | rgb[2];
+  if (scaled == _shown) return true;
+  if (rmt_wait_tx_done(NEOPIXEL_RMT_CHANNEL, 0) != ESP_OK) return false;
+
+  // WS2812 takes green, red, blue, most significant bit first
+  const uint8_t grb[3] = {rgb[1], rgb[0], rgb[2]};
+  rmt_item32_t *item = _items;
+  for (uint8_t pixel = 0; pixel < NEOPIXEL_NUM_PIXELS; pixel++) {
+    for (uint8_t byte = 0; byte < 3; byte++) {
+      for (int8_t bit = 7; bit >= 0; bit--, item++) {
+        bool one = (grb[byte] >> bit) & 1;
+        item->level0 = 1;
+        item->duration0 = one ? WS2812_T1H : WS2812_T0H;
+        item->level1 = 0;
+        item->duration1 = one ? WS2812_T1L : WS2812_T0L;
+      }
+    }
+  }
+  // _items stays untouched until the transfer is done (checked above)
+  if (rmt_write_items(NEOPIXEL_RMT_CHANNEL, _items, 24 * NEOPIXEL_NUM_PIXELS, false) != ESP_OK) return false;
+  _shown = scaled;
+  _writes++;
+  return true;
+}
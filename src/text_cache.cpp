@@ -0,0 +1,176 @@
+// Pre-rasterized text cache
+
+#include "text_cache.h"
+#include "frame_buffer.h"
+#include <Adafruit_SPITFT.h>
+
+#define TEXT_SUPERSAMPLE 4 // Samples per axis per output pixel
+
+TextCache textCache;
+
+// FNV-1a over the string and everything else that changes the pixels
+static uint32_t textHash(const char *text, const GFXfont *font, uint16_t scale256, uint16_t fg, uint16_t bg) {
+  uint32_t h = 2166136261u;
+  for (const char *p = text; *p; p++) {
+    h = (h ^ (uint8_t)*p) * 16777619u;
+  }
+  uint32_t extra[] = {(uint32_t)(uintptr_t)font, scale256, ((uint32_t)fg << 16) | bg};
+  for (uint32_t v : extra) {
+    h = (h ^ v) * 16777619u;
+  }
+  return h ? h : 1; // 0 marks a free slot
+}
+
+// alpha in 0..16
+static uint16_t blend565(uint16_t fg, uint16_t bg, uint8_t alpha) {
+  if (alpha == 0) return bg;
+  if (alpha >= 16) return fg;
+  uint16_t r = (((fg >> 11) & 0x1F) * alpha + ((bg >> 11) & 0x1F) * (16 - alpha)) / 16;
+  uint16_t g = (((fg >> 5) & 0x3F) * alpha + ((bg >> 5) & 0x3F) * (16 - alpha)) / 16;
+  uint16_t b = ((fg & 0x1F) * alpha + (bg & 0x1F) * (16 - alpha)) / 16;
+  return (r << 11) | (g << 5) | b;
+}
+
+// ============================================================================
+// LOOKUP
+// ============================================================================
+const CachedText *TextCache::get(const char *text, const GFXfont *font, float scale, uint16_t fg, uint16_t bg) {
+  uint16_t scale256 = (uint16_t)lroundf(scale * 256);
+  if (*text == '\0' || strlen(text) >= TEXT_CACHE_TEXT_MAX || scale256 == 0) return nullptr;
+
+  uint32_t hash = textHash(text, font, scale256, fg, bg);
+  Entry *victim = &_entries[0];
+  for (Entry &e : _entries) {
+    if (e.hash == hash && e.font == font && e.scale256 == scale256 && e.fg == fg && e.bg == bg &&
+        strcmp(e.str, text) == 0) {
+      e.lastUse = ++_useCounter;
+      _hits++;
+      return &e.text;
+    }
+    // Free slots first, then the least recently used
+    if (victim->hash != 0 && (e.hash == 0 || e.lastUse < victim->lastUse)) victim = &e;
+  }
+
+  _misses++;
+  release(*victim);
+  if (!rasterize(*victim, text, font, scale, fg, bg)) return nullptr;
+  victim->hash = hash;
+  victim->font = font;
+  victim->scale256 = scale256;
+  victim->fg = fg;
+  victim->bg = bg;
+  victim->lastUse = ++_useCounter;
+  strlcpy(victim->str, text, sizeof(victim->str));
+  return &victim->text;
+}
+
+void TextCache::release(Entry &e) {
+  if (e.hash == 0) return;
+  free(e.text.pixels);
+  _bytes -= (size_t)e.text.w * e.text.h * sizeof(uint16_t);
+  e = Entry();
+}
+
+// ============================================================================
+// RASTERIZATION
+// ============================================================================
+bool TextCache::rasterize(Entry &e, const char *text, const GFXfont *font, float scale, uint16_t fg, uint16_t bg) {
+  // Native-size coverage mask, drawn by the GFX text code itself
+  int16_t x1, y1;
+  uint16_t w, h;
+  GFXcanvas1 probe(1, 1);
+  probe.setFont(font);
+  probe.setTextWrap(false);
+  probe.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
+  if (w == 0 || h == 0) return false;
+
+  GFXcanvas1 mask(w, h);
+  if (mask.getBuffer() == nullptr) return false;
+  mask.setFont(font);
+  mask.setTextWrap(false);
+  mask.setTextColor(1);
+  mask.setCursor(-x1, -y1);
+  mask.print(text);
+
+  int16_t outW = (int16_t)ceilf(w * scale);
+  int16_t outH = (int16_t)ceilf(h * scale);
+  size_t bytes = (size_t)outW * outH * sizeof(uint16_t);
+  if (bytes > TEXT_CACHE_BYTES) return false;
+
+  // Make room: evict least recently used entries
+  while (_bytes + bytes > TEXT_CACHE_BYTES) {
+    Entry *lru = nullptr;
+    for (Entry &other : _entries) {
+      if (other.hash != 0 && (lru == nullptr || other.lastUse < lru->lastUse)) lru = &other;
+    }
+    if (lru == nullptr) break;
+    release(*lru);
+  }
+
+  uint16_t *pixels = (uint16_t *)ps_malloc(bytes);
+  if (pixels == nullptr) return false;
+
+  // Box filter: each output pixel averages a 4x4 grid of mask samples
+  float step = 1.0f / (scale * TEXT_SUPERSAMPLE);
+  for (int16_t oy = 0; oy < outH; oy++) {
+    int16_t sy[TEXT_SUPERSAMPLE];
+    for (uint8_t j = 0; j < TEXT_SUPERSAMPLE; j++) {
+      sy[j] = (int16_t)((oy * TEXT_SUPERSAMPLE + j + 0.5f) * step);
+    }
+    for (int16_t ox = 0; ox < outW; ox++) {
+      uint8_t covered = 0;
+      for (uint8_t i = 0; i < TEXT_SUPERSAMPLE; i++) {
+        int16_t sx = (int16_t)((ox * TEXT_SUPERSAMPLE + i + 0.5f) * step);
+        if (sx >= (int16_t)w) continue;
+        for (uint8_t j = 0; j < TEXT_SUPERSAMPLE; j++) {
+          if (sy[j] < (int16_t)h && mask.getPixel(sx, sy[j])) covered++;
+        }
+      }
+      pixels[oy * outW + ox] = blend565(fg, bg, covered);
+    }
+  }
+
+  e.text.pixels = pixels;
+  e.text.w = outW;
+  e.text.h = outH;
+  e.text.dx = (int16_t)floorf(x1 * scale);
+  e.text.dy = (int16_t)floorf(y1 * scale);
+  _bytes += bytes;
+  return true;
+}
+
+// ============================================================================
+// DRAWING
+// ============================================================================
+void TextCache::draw(Adafruit_GFX &gfx, const CachedText &text, int16_t x, int16_t y) {
+  x += text.dx;
+  y += text.dy;
+  // Both targets have a block copy; the Adafruit_GFX one is per pixel
+  if (&gfx == &frameBuffer) {
+    frameBuffer.drawRGBBitmap(x, y, text.pixels, text.w, text.h);
+  } else if (_tft != nullptr && &gfx == _tft) {
+    _tft->drawRGBBitmap(x, y, text.pixels, text.w, text.h);
+  } else {
+    gfx.drawRGBBitmap(x, y, text.pixels, text.w, text.h);
+  }
+}
+
+void TextCache::drawCentered(Adafruit_GFX &gfx, const char *text, const GFXfont *font, float scale,
+                             uint16_t fg, uint16_t bg, int16_t y) {
+  const CachedText *cached = get(text, font, scale, fg, bg);
+  if (cached != nullptr) {
+    draw(gfx, *cached, (gfx.width() - cached->w) / 2 - cached->dx, y);
+    return;
+  }
+
+  if (*text == '\0') return;
+  int16_t x1, y1;
+  uint16_t w, h;
+  gfx.setFont(font);
+  gfx.setTextSize(max(1L, lroundf(scale)));
+  gfx.setTextColor(fg, bg);
+  gfx.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
+  gfx.setCursor((gfx.width() - w) / 2 - x1, y);
+  gfx.print(text);
+  gfx.setFont();
+}
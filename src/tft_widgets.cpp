@@ -0,0 +1,234 @@
+// Retained-mode TFT widgets
+
+#include "tft_widgets.h"
+
+WidgetStats widgetStats = {};
+
+// Widgets drawn in an older generation are treated as not on screen
+static uint32_t widgetGeneration = 1;
+
+void invalidateWidgets() {
+  widgetGeneration++;
+}
+
+uint32_t currentWidgetGeneration() {
+  return widgetGeneration;
+}
+
+static void fillCounted(Adafruit_GFX &gfx, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (w <= 0 || h <= 0) return;
+  gfx.fillRect(x, y, w, h, color);
+  widgetStats.pixels += (uint32_t)w * h;
+}
+
+// ============================================================================
+// TEXT
+// ============================================================================
+void TextWidget::set(const char *text, uint16_t color) {
+  if (color == _color && strncmp(text, _text, WIDGET_TEXT_MAX - 1) == 0) return;
+  strncpy(_text, text, WIDGET_TEXT_MAX - 1);
+  _text[WIDGET_TEXT_MAX - 1] = '\0';
+  _color = color;
+  _dirty = true;
+}
+
+bool TextWidget::draw(Adafruit_GFX &gfx) {
+  bool onScreen = _generation == widgetGeneration;
+  if (onScreen && !_dirty) return false;
+  if (!onScreen) _drawnW = 0; // The area was cleared by whoever invalidated
+
+  uint16_t w = strlen(_text) * 6 * _size;
+  uint16_t h = 8 * _size;
+  int16_t x = _x;
+  if (_align == ALIGN_CENTER) x = _x - w / 2;
+  else if (_align == ALIGN_RIGHT) x = _x - w;
+
+  if (w > 0) {
+    gfx.setTextSize(_size);
+    gfx.setTextColor(_color, _bg);
+    gfx.setCursor(x, _y);
+    gfx.print(_text);
+    widgetStats.pixels += (uint32_t)w * h;
+  }
+
+  // Clear what the old text covered left and right of the new one
+  if (_drawnW > 0) {
+    int16_t oldEnd = _drawnX + _drawnW;
+    int16_t newEnd = x + w;
+    if (w == 0) {
+      fillCounted(gfx, _drawnX, _y, _drawnW, h, _bg);
+    } else {
+      fillCounted(gfx, _drawnX, _y, min(oldEnd, x) - _drawnX, h, _bg);
+      int16_t rightStart = max(newEnd, _drawnX);
+      fillCounted(gfx, rightStart, _y, oldEnd - rightStart, h, _bg);
+    }
+  }
+
+  _drawnX = x;
+  _drawnW = w;
+  _generation = widgetGeneration;
+  _dirty = false;
+  widgetStats.redraws++;
+  return true;
+}
+
+// ============================================================================
+// BAR
+// ============================================================================
+void BarWidget::set(uint32_t value, uint32_t max, uint16_t color) {
+  uint32_t inner = _w - 2;
+  uint32_t fill = max == 0 ? 0 : (uint64_t)value * inner / max;
+  _fill = fill > inner ? inner : fill;
+  _color = color;
+}
+
+bool BarWidget::draw(Adafruit_GFX &gfx) {
+  bool onScreen = _generation == widgetGeneration;
+  if (onScreen && _fill == _drawnFill && _color == _drawnColor) return false;
+
+  int16_t innerX = _x + 1;
+  int16_t innerY = _y + 1;
+  int16_t innerH = _h - 2;
+
+  if (!onScreen) {
+    gfx.drawRect(_x, _y, _w, _h, _frameColor);
+    widgetStats.pixels += 2 * (_w + _h);
+    fillCounted(gfx, innerX, innerY, _w - 2, innerH, _bg);
+    _drawnFill = 0;
+    _drawnColor = _color;
+  }
+
+  if (_color != _drawnColor) {
+    fillCounted(gfx, innerX, innerY, _fill, innerH, _color);
+    fillCounted(gfx, innerX + _fill, innerY, _drawnFill - _fill, innerH, _bg);
+  } else if (_fill > _drawnFill) {
+    fillCounted(gfx, innerX + _drawnFill, innerY, _fill - _drawnFill, innerH, _color);
+  } else {
+    fillCounted(gfx, innerX + _fill, innerY, _drawnFill - _fill, innerH, _bg);
+  }
+
+  _drawnFill = _fill;
+  _drawnColor = _color;
+  _generation = widgetGeneration;
+  widgetStats.redraws++;
+  return true;
+}
+
+// ============================================================================
+// SKY PLOT
+// ============================================================================
+void SkyPlotWidget::set(const SkyPlotPoint *points, uint8_t count) {
+  Dot want[SKY_PLOT_MAX_POINTS];
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < count && n < SKY_PLOT_MAX_POINTS; i++) {
+    const SkyPlotPoint &p = points[i];
+    if (p.elevation < 0 || p.elevation > 90) continue;
+    float r = _r * (90 - p.elevation) / 90.0f;
+    float az = p.azimuth * (float)(PI / 180.0);
+    want[n].id = p.id;
+    want[n].x = _cx + (int16_t)lroundf(r * sinf(az));
+    want[n].y = _cy - (int16_t)lroundf(r * cosf(az));
+    want[n].color = p.color;
+    want[n].filled = p.filled;
+    n++;
+  }
+  bool same = n == _wantCount;
+  for (uint8_t i = 0; i < n && same; i++) same = want[i] == _want[i];
+  if (same) return;
+  for (uint8_t i = 0; i < n; i++) _want[i] = want[i];
+  _wantCount = n;
+  _dirty = true;
+}
+
+// Rings one pixel wide at r, 2r/3 and r/3, and the N-S / E-W axes
+bool SkyPlotWidget::onGrid(int16_t x, int16_t y) const {
+  int32_t dx = x - _cx, dy = y - _cy;
+  int32_t d2x4 = 4 * (dx * dx + dy * dy);
+  if (d2x4 > (2 * _r + 1) * (2 * _r + 1)) return false;
+  if (dx == 0 || dy == 0) return true;
+  for (uint8_t i = 1; i <= 3; i++) {
+    int32_t ring = _r * i / 3;
+    if (d2x4 >= (2 * ring - 1) * (2 * ring - 1) && d2x4 < (2 * ring + 1) * (2 * ring + 1)) return true;
+  }
+  return false;
+}
+
+void SkyPlotWidget::drawGrid(Adafruit_GFX &gfx, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+  for (int16_t y = y0; y <= y1; y++) {
+    for (int16_t x = x0; x <= x1; x++) {
+      if (onGrid(x, y)) {
+        gfx.drawPixel(x, y, _gridColor);
+        widgetStats.pixels++;
+      }
+    }
+  }
+}
+
+void SkyPlotWidget::drawDot(Adafruit_GFX &gfx, const Dot &dot) {
+  if (dot.filled) {
+    gfx.fillCircle(dot.x, dot.y, SKY_DOT_RADIUS, dot.color);
+  } else {
+    gfx.drawCircle(dot.x, dot.y, SKY_DOT_RADIUS, dot.color);
+  }
+  widgetStats.pixels += (2 * SKY_DOT_RADIUS + 1) * (2 * SKY_DOT_RADIUS + 1);
+}
+
+void SkyPlotWidget::eraseDot(Adafruit_GFX &gfx, const Dot &dot) {
+  int16_t x0 = dot.x - SKY_DOT_RADIUS, y0 = dot.y - SKY_DOT_RADIUS;
+  int16_t size = 2 * SKY_DOT_RADIUS + 1;
+  fillCounted(gfx, x0, y0, size, size, _bg);
+  drawGrid(gfx, x0, y0, x0 + size - 1, y0 + size - 1);
+}
+
+static bool dotsOverlap(int16_t ax, int16_t ay, int16_t bx, int16_t by) {
+  return abs(ax - bx) <= 2 * SKY_DOT_RADIUS && abs(ay - by) <= 2 * SKY_DOT_RADIUS;
+}
+
+bool SkyPlotWidget::draw(Adafruit_GFX &gfx) {
+  bool onScreen = _generation == widgetGeneration;
+  if (onScreen && !_dirty) return false;
+
+  if (!onScreen) {
+    // Dots on the horizon stick out of the circle by their radius
+    int16_t half = _r + SKY_DOT_RADIUS;
+    fillCounted(gfx, _cx - half, _cy - half, 2 * half + 1, 2 * half + 1, _bg);
+    drawGrid(gfx, _cx - _r, _cy - _r, _cx + _r, _cy + _r);
+    _drawnCount = 0;
+  }
+
+  // Erase what moved, changed or went away
+  Dot erased[SKY_PLOT_MAX_POINTS];
+  uint8_t erasedCount = 0;
+  bool unchanged[SKY_PLOT_MAX_POINTS] = {};
+  for (uint8_t i = 0; i < _drawnCount; i++) {
+    const Dot &old = _drawn[i];
+    bool kept = false;
+    for (uint8_t j = 0; j < _wantCount; j++) {
+      if (_want[j].id == old.id) {
+        kept = _want[j] == old;
+        unchanged[j] = kept;
+        break;
+      }
+    }
+    if (!kept) {
+      eraseDot(gfx, old);
+      erased[erasedCount++] = old;
+    }
+  }
+
+  // Draw the new and changed ones, plus any an erase cut into
+  for (uint8_t j = 0; j < _wantCount; j++) {
+    bool redraw = !unchanged[j];
+    for (uint8_t k = 0; k < erasedCount && !redraw; k++) {
+      redraw = dotsOverlap(_want[j].x, _want[j].y, erased[k].x, erased[k].y);
+    }
+    if (redraw) drawDot(gfx, _want[j]);
+  }
+
+  for (uint8_t j = 0; j < _wantCount; j++) _drawn[j] = _want[j];
+  _drawnCount = _wantCount;
+  _dirty = false;
+  _generation = widgetGeneration;
+  widgetStats.redraws++;
+  return true;
+}
@@ -0,0 +1,142 @@
+// Chrome-trace event recorder
+
+#include "trace.h"
+#include "profiler.h"
+#include "str_append.h"
+#include <ESPAsyncWebServer.h>
+#include <memory>
+
+static_assert((TRACE_BUFFER_EVENTS & (TRACE_BUFFER_EVENTS - 1)) == 0, "TRACE_BUFFER_EVENTS must be a power of two");
+
+TraceRecorder tracer;
+
+thread_local uint8_t traceTaskId = TRACE_TASK_UNKNOWN;
+
+static const char *const TRACE_EVENT_NAMES[TRACE_ID_END - TRACE_STAGE_IDS] = {
+  "epoch", "ws_broadcast", "ws_event", "fix_change", "wifi_event"
+};
+
+static const char *traceEventName(uint8_t id) {
+  if (id < STAGE_COUNT) return PROFILE_STAGE_NAMES[id];
+  if (id >= TRACE_STAGE_IDS && id < TRACE_ID_END) return TRACE_EVENT_NAMES[id - TRACE_STAGE_IDS];
+  return "unknown";
+}
+
+// Once per task, from its first event
+uint8_t TraceRecorder::registerTask() {
+  uint8_t id = _taskCount.load(std::memory_order_relaxed);
+  do {
+    if (id >= TRACE_MAX_TASKS) {
+      id = 0;
+      break;
+    }
+  } while (!_taskCount.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+  if (id != 0) {
+    strlcpy(_taskNames[id], pcTaskGetName(nullptr), sizeof(_taskNames[id]));
+  }
+  traceTaskId = id;
+  return id;
+}
+
+bool TraceRecorder::begin() {
+  _events = (TraceEvent *)ps_malloc(TRACE_BUFFER_EVENTS * sizeof(TraceEvent));
+  if (_events == nullptr) {
+    DEBUG_PRINTLN("Trace: PSRAM buffer allocation failed, tracing disabled");
+    return false;
+  }
+  memset(_events, 0, TRACE_BUFFER_EVENTS * sizeof(TraceEvent));
+  strlcpy(_taskNames[0], "other_tasks", sizeof(_taskNames[0]));
+  setEnabled(TRACE_AT_BOOT);
+  DEBUG_PRINTF("Trace buffer: %d events in PSRAM\n", TRACE_BUFFER_EVENTS);
+  return true;
+}
+
+// ============================================================================
+// CHUNKED /trace.json RESPONSE
+// ============================================================================
+namespace {
+struct TraceStream {
+  uint8_t nextTask = 0; // Next thread_name record
+  uint8_t taskCount;
+  uint32_t next;       // Next ring index to export
+  uint32_t end;        // One past the last recorded event
+  uint32_t lastRawTs;
+  int64_t ts;          // Unwrapped timestamp relative to the first event
+  std::atomic<uint8_t> *exports; // TraceRecorder::_exports, released on destruction
+  bool first = true;
+  bool footerDone = false;
+  size_t len = 0;
+  size_t pos = 0;
+  char line[128];
+
+  // Also runs when the client goes away mid-export
+  ~TraceStream() { exports->fetch_sub(1, std::memory_order_relaxed); }
+};
+} // namespace
+
+void TraceRecorder::sendJson(AsyncWebServerRequest *request) {
+  if (_events == nullptr) {
+    request->send(503, "text/plain", "Trace buffer not allocated");
+    return;
+  }
+
+  // Freeze the ring while it is exported, until the last overlapping export ends
+  _exports.fetch_add(1, std::memory_order_relaxed);
+  std::shared_ptr<TraceStream> stream(new TraceStream());
+  stream->exports = &_exports;
+
+  uint32_t head = _head.load(std::memory_order_relaxed);
+  stream->end = head;
+  stream->next = head > TRACE_BUFFER_EVENTS ? head - TRACE_BUFFER_EVENTS : 0;
+  stream->lastRawTs = _events[stream->next & (TRACE_BUFFER_EVENTS - 1)].tsUs;
+  stream->ts = 0;
+  stream->taskCount = min(_taskCount.load(std::memory_order_relaxed), (uint8_t)TRACE_MAX_TASKS);
+
+  size_t len = 0;
+  appendf(stream->line, sizeof(stream->line), &len, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  stream->len = len;
+
+  TraceRecorder *self = this;
+  AsyncWebServerResponse *response = request->beginChunkedResponse(
+      "application/json",
+      [stream, self](uint8_t *out, size_t maxLen, size_t) -> size_t {
+        size_t written = 0;
+        while (written < maxLen) {
+          if (stream->pos == stream->len) {
+            stream->len = 0;
+            stream->pos = 0;
+            if (stream->nextTask < stream->taskCount) {
+              // Track labels
+              uint8_t task = stream->nextTask++;
+              appendf(stream->line, sizeof(stream->line), &stream->len,
+                      "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                      stream->first ? "" : ",\n", task, self->_taskNames[task]);
+              stream->first = false;
+            } else if (stream->next < stream->end) {
+              const TraceEvent &e = self->_events[stream->next++ & (TRACE_BUFFER_EVENTS - 1)];
+              // Signed delta: events from the two cores can be slightly out of order
+              stream->ts += (int32_t)(e.tsUs - stream->lastRawTs);
+              stream->lastRawTs = e.tsUs;
+              appendf(stream->line, sizeof(stream->line), &stream->len,
+                      "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":1,\"tid\":%u,\"args\":{\"core\":%u}%s}",
+                      stream->first ? "" : ",\n", traceEventName(e.id), e.phase,
+                      (long long)stream->ts, e.task, e.core, e.phase == 'i' ? ",\"s\":\"g\"" : "");
+              stream->first = false;
+            } else if (!stream->footerDone) {
+              appendf(stream->line, sizeof(stream->line), &stream->len, "\n]}\n");
+              stream->footerDone = true;
+            } else {
+              break;
+            }
+            continue;
+          }
+          size_t n = min(maxLen - written, stream->len - stream->pos);
+          memcpy(out + written, stream->line + stream->pos, n);
+          written += n;
+          stream->pos += n;
+        }
+        return written;
+      });
+  response->addHeader("Content-Disposition", "inline; filename=\"trace.json\"");
+  request->send(response);
+}
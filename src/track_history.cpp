@@ -0,0 +1,40 @@
+// In-memory breadcrumb track
+
+#include "track_history.h"
+#include "coord_e7.h"
+#include "lock_guard.h"
+
+TrackHistory trackHistory;
+
+void TrackHistory::begin() {
+  if (_lock == nullptr) {
+    _lock = xSemaphoreCreateMutex();
+  }
+}
+
+bool TrackHistory::add(int32_t latE7, int32_t lngE7) {
+  LockGuard guard(_lock);
+  if (_next > 0) {
+    const TrackPoint &last = _points[(_next - 1) % TRACK_HISTORY_SIZE];
+    if (coordE7DistanceCm(last.latE7, last.lngE7, latE7, lngE7) < TRACK_MIN_SPACING_CM) return false;
+  }
+  _points[_next % TRACK_HISTORY_SIZE] = {latE7, lngE7};
+  _next++;
+  return true;
+}
+
+void TrackHistory::clear() {
+  LockGuard guard(_lock);
+  _next = 0;
+}
+
+size_t TrackHistory::read(uint32_t *from, TrackPoint *out, size_t max) {
+  LockGuard guard(_lock);
+  uint32_t oldest = _next > TRACK_HISTORY_SIZE ? _next - TRACK_HISTORY_SIZE : 0;
+  if (*from < oldest || *from > _next) *from = oldest; // Overwritten, or history cleared
+  size_t n = 0;
+  while (n < max && *from < _next) {
+    out[n++] = _points[(*from)++ % TRACK_HISTORY_SIZE];
+  }
+  return n;
+}
@@ -0,0 +1,188 @@
+// Breadcrumb track map
+
+#include "track_map.h"
+#include "coord_e7.h"
+#include "num_format.h"
+
+#define TRACK_MAP_CHUNK     32  // Points copied per history lock
+#define TRACK_MAP_BAR_MAX   60  // Longest scale bar in pixels
+#define TRACK_MAP_FILL_PCT  60  // Share of the view the track spans after a rescale
+
+TrackMapWidget::TrackMapWidget(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t trailColor,
+                               uint16_t headColor, uint16_t textColor, uint16_t bg)
+  : _x(x), _y(y), _w(w), _mapH(h - TRACK_MAP_SCALE_BAR_H), _trailColor(trailColor), _headColor(headColor),
+    _textColor(textColor), _bg(bg),
+    _scaleLabel(x + TRACK_MAP_BAR_MAX + 10, y + h - TRACK_MAP_SCALE_BAR_H + 4, 1, bg) {}
+
+// Smallest 1-2-5 step >= value
+static uint32_t niceAtLeast(uint32_t value) {
+  uint32_t decade = 1;
+  for (;;) {
+    if (value <= decade) return decade;
+    if (value <= 2 * decade) return 2 * decade;
+    if (value <= 5 * decade) return 5 * decade;
+    if (decade > UINT32_MAX / 10) return UINT32_MAX;
+    decade *= 10;
+  }
+}
+
+// Largest 1-2-5 step <= value
+static uint32_t niceAtMost(uint32_t value) {
+  uint32_t nice = 1;
+  for (uint32_t decade = 1; decade <= value; decade *= 10) {
+    if (decade <= value) nice = decade;
+    if (2 * decade <= value) nice = 2 * decade;
+    if (5 * decade <= value) nice = 5 * decade;
+    if (decade > UINT32_MAX / 10) break;
+  }
+  return nice;
+}
+
+// ============================================================================
+// PROJECTION
+// ============================================================================
+// False if the point is outside the view (margin included); sx/sy are still set
+bool TrackMapWidget::project(const TrackPoint &p, int16_t *sx, int16_t *sy) const {
+  int32_t east, north;
+  coordE7OffsetCmScaled(_refLat, _refLng, p.latE7, p.lngE7, _lngScaleQ16, &east, &north);
+  int32_t px = _x + _w / 2 + east / (int32_t)_cmPerPx;
+  int32_t py = _y + _mapH / 2 - north / (int32_t)_cmPerPx;
+  *sx = constrain(px, INT16_MIN, INT16_MAX);
+  *sy = constrain(py, INT16_MIN, INT16_MAX);
+  return px >= _x + TRACK_MAP_MARGIN && px < _x + _w - TRACK_MAP_MARGIN &&
+         py >= _y + TRACK_MAP_MARGIN && py < _y + _mapH - TRACK_MAP_MARGIN;
+}
+
+// Centres the view on the track's bounding box, at the closest scale it fits
+void TrackMapWidget::fit(TrackHistory &history) {
+  TrackPoint buf[TRACK_MAP_CHUNK];
+  uint32_t from = 0;
+  size_t n;
+  bool any = false;
+  int32_t minLat = 0, maxLat = 0, minLng = 0, maxLng = 0;
+  while ((n = history.read(&from, buf, TRACK_MAP_CHUNK)) > 0) {
+    for (size_t i = 0; i < n; i++) {
+      if (!any) {
+        minLat = maxLat = buf[i].latE7;
+        minLng = maxLng = buf[i].lngE7;
+        any = true;
+      }
+      minLat = min(minLat, buf[i].latE7);
+      maxLat = max(maxLat, buf[i].latE7);
+      minLng = min(minLng, buf[i].lngE7);
+      maxLng = max(maxLng, buf[i].lngE7);
+    }
+  }
+  if (!any) return;
+
+  _refLat = (int32_t)(((int64_t)minLat + maxLat) / 2);
+  _refLng = (int32_t)(((int64_t)minLng + maxLng) / 2);
+  _lngScaleQ16 = coordE7LngScaleQ16(_refLat);
+
+  int32_t east, north;
+  coordE7OffsetCmScaled(_refLat, _refLng, maxLat, maxLng, _lngScaleQ16, &east, &north);
+  // Only part of the view is filled, so a moving head doesn't rescale every few points
+  uint32_t halfW = (_w / 2 - TRACK_MAP_MARGIN - 1) * TRACK_MAP_FILL_PCT / 100;
+  uint32_t halfH = (_mapH / 2 - TRACK_MAP_MARGIN - 1) * TRACK_MAP_FILL_PCT / 100;
+  uint32_t need = max((abs(east) + halfW - 1) / halfW, (abs(north) + halfH - 1) / halfH);
+  _cmPerPx = niceAtLeast(max(need, (uint32_t)TRACK_MAP_MIN_CM_PER_PX));
+}
+
+// ============================================================================
+// DRAWING
+// ============================================================================
+// Segment from the previous head, which becomes a plain breadcrumb
+void TrackMapWidget::appendPoint(Adafruit_GFX &gfx, int16_t sx, int16_t sy) {
+  if (_hasHead) {
+    gfx.drawLine(_headX, _headY, sx, sy, _trailColor);
+    gfx.fillRect(_headX - 1, _headY - 1, 3, 3, _trailColor);
+    widgetStats.pixels += max(abs(sx - _headX), abs(sy - _headY)) + 1 + 9;
+  }
+  gfx.fillRect(sx - 1, sy - 1, 3, 3, _headColor);
+  widgetStats.pixels += 9;
+  _headX = sx;
+  _headY = sy;
+  _hasHead = true;
+}
+
+void TrackMapWidget::redrawAll(Adafruit_GFX &gfx, TrackHistory &history) {
+  gfx.fillRect(_x, _y, _w, _mapH, _bg);
+  widgetStats.pixels += (uint32_t)_w * _mapH;
+  _hasHead = false;
+
+  TrackPoint buf[TRACK_MAP_CHUNK];
+  uint32_t from = 0;
+  size_t n;
+  while ((n = history.read(&from, buf, TRACK_MAP_CHUNK)) > 0) {
+    for (size_t i = 0; i < n; i++) {
+      int16_t sx, sy;
+      project(buf[i], &sx, &sy); // Added after fit(): clipped, the next frame rescales
+      appendPoint(gfx, sx, sy);
+    }
+  }
+  _nextPoint = from;
+  drawScaleBar(gfx);
+}
+
+void TrackMapWidget::drawScaleBar(Adafruit_GFX &gfx) {
+  int16_t y0 = _y + _mapH;
+  gfx.fillRect(_x, y0, TRACK_MAP_BAR_MAX + 8, TRACK_MAP_SCALE_BAR_H, _bg);
+
+  uint32_t cm = niceAtMost(TRACK_MAP_BAR_MAX * _cmPerPx);
+  int16_t len = cm / _cmPerPx;
+  int16_t x = _x + 4;
+  int16_t y = y0 + TRACK_MAP_SCALE_BAR_H / 2;
+  gfx.drawFastHLine(x, y, len, _textColor);
+  gfx.drawFastVLine(x, y - 3, 4, _textColor);
+  gfx.drawFastVLine(x + len - 1, y - 3, 4, _textColor);
+  widgetStats.pixels += (TRACK_MAP_BAR_MAX + 8) * TRACK_MAP_SCALE_BAR_H;
+
+  char label[16];
+  if (cm >= 100000) {
+    size_t n = fmtUint(label, sizeof(label), cm / 100000);
+    strlcpy(label + n, " km", sizeof(label) - n);
+  } else if (cm >= 100) {
+    size_t n = fmtUint(label, sizeof(label), cm / 100);
+    strlcpy(label + n, " m", sizeof(label) - n);
+  } else {
+    size_t n = fmtUint(label, sizeof(label), cm);
+    strlcpy(label + n, " cm", sizeof(label) - n);
+  }
+  _scaleLabel.set(label, _textColor);
+  _scaleLabel.draw(gfx);
+}
+
+bool TrackMapWidget::draw(Adafruit_GFX &gfx, TrackHistory &history) {
+  bool onScreen = _generation == currentWidgetGeneration();
+  uint32_t next = history.next();
+  if (onScreen && next == _nextPoint) return false;
+  _generation = currentWidgetGeneration();
+
+  // Page entry, history cleared, or points lost to the ring before being drawn
+  if (!onScreen || next < _nextPoint || next - _nextPoint > TRACK_HISTORY_SIZE) {
+    fit(history);
+    redrawAll(gfx, history);
+    widgetStats.redraws++;
+    return true;
+  }
+
+  TrackPoint buf[TRACK_MAP_CHUNK];
+  uint32_t from = _nextPoint;
+  size_t n;
+  while ((n = history.read(&from, buf, TRACK_MAP_CHUNK)) > 0) {
+    for (size_t i = 0; i < n; i++) {
+      int16_t sx, sy;
+      if (!project(buf[i], &sx, &sy)) {
+        fit(history);
+        redrawAll(gfx, history);
+        _rescales++;
+        widgetStats.redraws++;
+        return true;
+      }
+      appendPoint(gfx, sx, sy);
+    }
+    _nextPoint = from;
+  }
+  widgetStats.redraws++;
+  return true;
+}
@@ -0,0 +1,66 @@
+// UDP multicast/broadcast fix stream
+// See udp_fix.h for the packet format.
+
+#include "udp_fix.h"
+
+void UdpFixSender::begin() {
+  _group = IPAddress(UDP_FIX_MULTICAST_ADDR);
+  _running = true;
+  DEBUG_PRINTF("UDP fix stream on %s:%d (%s)\n", _group.toString().c_str(), UDP_FIX_PORT,
+               UDP_FIX_USE_BROADCAST ? "broadcast" : "multicast");
+}
+
+void UdpFixSender::send(const GpsSnapshot &s, int64_t epochUs, int64_t ppsUs) {
+  if (!_running) return;
+
+  UdpFixPacket pkt;
+  memset(&pkt, 0, sizeof(pkt));
+  pkt.magic = UDP_FIX_MAGIC;
+  pkt.version = UDP_FIX_VERSION;
+  pkt.length = sizeof(pkt);
+  pkt.sequence = _sequence++;
+  pkt.epoch = s.epoch;
+  pkt.epochUs = epochUs;
+  pkt.ppsUs = ppsUs;
+
+  if (snapshotHasFix(s)) {
+    pkt.flags |= UDP_FIX_FLAG_FIX;
+    pkt.latE7 = s.latE7;
+    pkt.lonE7 = s.lngE7;
+  }
+  if (s.altitudeValid) {
+    pkt.flags |= UDP_FIX_FLAG_ALTITUDE;
+    pkt.altitudeCm = lround(s.altitudeM * 100.0);
+  }
+  if (s.speedValid) {
+    pkt.flags |= UDP_FIX_FLAG_SPEED;
+    pkt.speedCms = (uint16_t)lround(s.speedKmph * (100000.0 / 3600.0));
+  }
+  if (s.courseValid) {
+    pkt.flags |= UDP_FIX_FLAG_COURSE;
+    pkt.courseCdeg = (uint16_t)lround(s.courseDeg * 100.0);
+  }
+  if (s.hdopValid) {
+    pkt.flags |= UDP_FIX_FLAG_HDOP;
+    pkt.hdopX100 = (uint16_t)lround(s.hdop * 100.0);
+  }
+  if (s.dateValid && s.timeValid) {
+    pkt.flags |= UDP_FIX_FLAG_TIME;
+    pkt.utcDate = (uint32_t)s.year * 10000 + s.month * 100 + s.day;
+    pkt.utcTimeMs = ((s.hour * 60UL + s.minute) * 60UL + s.second) * 1000UL + s.centisecond * 10UL;
+  }
+  if (ppsUs != 0) pkt.flags |= UDP_FIX_FLAG_PPS;
+  pkt.satellites = s.satellites > 255 ? 255 : s.satellites;
+
+  size_t written;
+  if (UDP_FIX_USE_BROADCAST) {
+    written = _udp.broadcastTo((uint8_t *)&pkt, sizeof(pkt), UDP_FIX_PORT);
+  } else {
+    written = _udp.writeTo((uint8_t *)&pkt, sizeof(pkt), _group, UDP_FIX_PORT);
+  }
+  if (written == sizeof(pkt)) {
+    _sent++;
+  } else {
+    _errors++;
+  }
+}
@@ -0,0 +1,209 @@
+// WiFi connection manager
+
+#include "wifi_manager.h"
+
+WifiManager wifiManager;
+
+void WifiManager::addNetwork(const char *ssid, const char *password) {
+  if (_networkCount >= WIFI_MAX_NETWORKS || ssid == nullptr || ssid[0] == '\0') return;
+  _networks[_networkCount++] = {ssid, password};
+}
+
+void WifiManager::begin() {
+  _events = xQueueCreate(WIFI_EVENT_QUEUE_LEN, sizeof(Event));
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(false); // Reconnection is done here, with backoff
+
+  // Arduino event task: hand the event over and return
+  WiFi.onEvent([this](arduino_event_id_t id, arduino_event_info_t info) {
+    Event event = {id, 0};
+    switch (id) {
+      case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        event.reason = info.wifi_sta_disconnected.reason;
+        break;
+      case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+      case ARDUINO_EVENT_WIFI_SCAN_DONE:
+        break;
+      default:
+        return;
+    }
+    xQueueSend(_events, &event, 0);
+    if (_onEvent != nullptr) _onEvent();
+  });
+
+  DEBUG_PRINTF("WiFi manager: %u network(s) configured\n", _networkCount);
+  startScan();
+}
+
+WifiLinkChange WifiManager::update() {
+  WifiLinkChange change = WIFI_LINK_UNCHANGED;
+  Event event;
+  while (xQueueReceive(_events, &event, 0) == pdTRUE) {
+    handleEvent(event, &change);
+  }
+
+  unsigned long now = millis();
+  switch (_state) {
+    case WIFI_STATE_SCANNING:
+      // SCAN_DONE never came (scan failed to start, or the event was dropped)
+      if (now - _stateMs > WIFI_CONNECT_TIMEOUT) {
+        WiFi.scanDelete();
+        fail(&change);
+      }
+      break;
+    case WIFI_STATE_CONNECTING:
+      if (now - _stateMs > WIFI_CONNECT_TIMEOUT) {
+        WiFi.disconnect();
+        fail(&change);
+      }
+      break;
+    case WIFI_STATE_CONNECTED:
+      if (!_roamScan && _networkCount > 0 && now - _lastRoamCheckMs > WIFI_ROAM_CHECK_INTERVAL) {
+        _lastRoamCheckMs = now;
+        if (WiFi.RSSI() < WIFI_ROAM_RSSI) {
+          _roamScan = WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING;
+        }
+      }
+      break;
+    case WIFI_STATE_BACKOFF:
+      if (now - _stateMs >= _backoffMs) startScan();
+      break;
+  }
+  return change;
+}
+
+// Link changes are reported once per update(): a drop outranks the failed
+// reconnect that may follow it, so the caller always stops its servers
+static void setChange(WifiLinkChange *change, WifiLinkChange value) {
+  if (value == WIFI_LINK_FAILED && *change == WIFI_LINK_DOWN) return;
+  *change = value;
+}
+
+void WifiManager::handleEvent(const Event &event, WifiLinkChange *change) {
+  unsigned long now = millis();
+  switch (event.id) {
+    case ARDUINO_EVENT_WIFI_SCAN_DONE:
+      onScanDone(change);
+      break;
+
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      if (_state != WIFI_STATE_CONNECTING) break;
+      _state = WIFI_STATE_CONNECTED;
+      _stateMs = now;
+      _lastRoamCheckMs = now;
+      _failStreak = 0;
+      _connects++;
+      _lastConnectMs = now - _attemptStartMs;
+      _connectMsSum += _lastConnectMs;
+      if (_linkDownMs != 0) {
+        _lastOutageMs = now - _linkDownMs;
+        _maxOutageMs = max(_maxOutageMs, _lastOutageMs);
+        _outageMsSum += _lastOutageMs;
+        _outages++;
+        _linkDownMs = 0;
+      }
+      DEBUG_PRINTF("WiFi: connected to %s in %lu ms\n", _networks[_bestNetwork].ssid,
+                   (unsigned long)_lastConnectMs);
+      setChange(change, WIFI_LINK_UP);
+      break;
+
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+    case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+      if (_state == WIFI_STATE_CONNECTED) {
+        DEBUG_PRINTF("WiFi: link lost (reason %u), rescanning\n", event.reason);
+        linkDown(change);
+        startScan(); // First retry at once, backoff after that
+      } else if (_state == WIFI_STATE_CONNECTING && event.id == ARDUINO_EVENT_WIFI_STA_DISCONNECTED &&
+                 event.reason != WIFI_REASON_ASSOC_LEAVE) {
+        // ASSOC_LEAVE is our own disconnect before roaming
+        DEBUG_PRINTF("WiFi: connection to %s failed (reason %u)\n", _networks[_bestNetwork].ssid, event.reason);
+        fail(change);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void WifiManager::onScanDone(WifiLinkChange *change) {
+  int16_t count = WiFi.scanComplete();
+  int32_t bestRssi = 0;
+
+  // Decided by the state, not _roamScan: a roam scan still running when the
+  // link drops finishes as the SCANNING state's scan
+  if (_state == WIFI_STATE_CONNECTED) {
+    _roamScan = false;
+    int32_t rssi = WiFi.RSSI();
+    if (count > 0 && pickBest(count, &bestRssi) &&
+        bestRssi >= rssi + WIFI_ROAM_MARGIN_DB && memcmp(_bestBssid, WiFi.BSSID(), 6) != 0) {
+      DEBUG_PRINTF("WiFi: roaming to %s (%ld dBm, now %ld dBm)\n", _networks[_bestNetwork].ssid,
+                   (long)bestRssi, (long)rssi);
+      _roams++;
+      linkDown(change);
+      WiFi.disconnect();
+      _attemptStartMs = millis();
+      connectBest();
+    }
+  } else if (_state == WIFI_STATE_SCANNING) {
+    if (count > 0 && pickBest(count, &bestRssi)) {
+      connectBest();
+    } else {
+      DEBUG_PRINTLN("WiFi: no configured network in range");
+      fail(change);
+    }
+  }
+  WiFi.scanDelete();
+}
+
+void WifiManager::startScan() {
+  _state = WIFI_STATE_SCANNING;
+  _roamScan = false;
+  _stateMs = millis();
+  _attemptStartMs = _stateMs;
+  WiFi.scanNetworks(true); // Async: SCAN_DONE arrives through the event queue
+}
+
+// Strongest scan result with a configured SSID
+bool WifiManager::pickBest(int16_t count, int32_t *bestRssi) {
+  bool found = false;
+  for (int16_t i = 0; i < count; i++) {
+    String ssid = WiFi.SSID(i);
+    int32_t rssi = WiFi.RSSI(i);
+    for (uint8_t n = 0; n < _networkCount; n++) {
+      if (strcmp(ssid.c_str(), _networks[n].ssid) != 0) continue;
+      if (!found || rssi > *bestRssi) {
+        found = true;
+        *bestRssi = rssi;
+        _bestNetwork = n;
+        memcpy(_bestBssid, WiFi.BSSID(i), sizeof(_bestBssid));
+        _bestChannel = WiFi.channel(i);
+      }
+    }
+  }
+  return found;
+}
+
+void WifiManager::connectBest() {
+  _state = WIFI_STATE_CONNECTING;
+  _stateMs = millis();
+  const Network &n = _networks[_bestNetwork];
+  WiFi.begin(n.ssid, n.password, _bestChannel, _bestBssid);
+}
+
+void WifiManager::fail(WifiLinkChange *change) {
+  _failedAttempts++;
+  _failStreak = min(_failStreak + 1, 16);
+  _backoffMs = min((uint32_t)WIFI_RETRY_DELAY << min(_failStreak - 1, 5), (uint32_t)WIFI_RETRY_MAX_DELAY);
+  _state = WIFI_STATE_BACKOFF;
+  _stateMs = millis();
+  if (_failStreak == 1) setChange(change, WIFI_LINK_FAILED);
+}
+
+void WifiManager::linkDown(WifiLinkChange *change) {
+  _linkDownMs = max(millis(), 1UL); // 0 means "no outage running"
+  _roamScan = false;
+  setChange(change, WIFI_LINK_DOWN);
+}
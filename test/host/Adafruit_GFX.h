@@ -0,0 +1,100 @@
+// Host mock of Adafruit_GFX
+// Draws into an RGB565 framebuffer and counts every pixel written, which is
+// what the SPI bus would carry on the TFT. Text uses the 6x8 cell of the
+// built-in font with an opaque background; the glyphs are a fixed pattern
+// per character, not the real font, so screens can be compared but not read.
+
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+#include <vector>
+
+class Adafruit_GFX {
+public:
+  Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h), _fb((size_t)w * h, 0) {}
+
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+  // Pixels written since construction or the last resetCount()
+  uint32_t pixelsPushed() const { return _pushed; }
+  void resetCount() { _pushed = 0; }
+  uint16_t pixel(int16_t x, int16_t y) const { return _fb[(size_t)y * _width + x]; }
+  bool sameScreen(const Adafruit_GFX &other) const { return _fb == other._fb; }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    _fb[(size_t)y * _width + x] = color;
+    _pushed++;
+  }
+
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t j = y; j < y + h; j++) {
+      for (int16_t i = x; i < x + w; i++) drawPixel(i, j, color);
+    }
+  }
+
+  void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+    fillRect(x, y + h - 1, w, 1, color);
+    fillRect(x, y + 1, 1, h - 2, color);
+    fillRect(x + w - 1, y + 1, 1, h - 2, color);
+  }
+
+  void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    for (int16_t dy = -r; dy <= r; dy++) {
+      for (int16_t dx = -r; dx <= r; dx++) {
+        if (dx * dx + dy * dy <= r * r + r) drawPixel(x0 + dx, y0 + dy, color);
+      }
+    }
+  }
+
+  void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    for (int16_t dy = -r; dy <= r; dy++) {
+      for (int16_t dx = -r; dx <= r; dx++) {
+        int16_t d2 = dx * dx + dy * dy;
+        if (d2 <= r * r + r && d2 > (r - 1) * (r - 1) + (r - 1)) drawPixel(x0 + dx, y0 + dy, color);
+      }
+    }
+  }
+
+  void setTextSize(uint8_t size) { _textSize = size; }
+  void setTextColor(uint16_t color) { _textColor = color; _textBg = color; }
+  void setTextColor(uint16_t color, uint16_t bg) { _textColor = color; _textBg = bg; }
+  void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+
+  size_t print(const char *text) {
+    size_t n = 0;
+    for (; *text; text++, n++) {
+      drawChar(_cursorX, _cursorY, *text);
+      _cursorX += 6 * _textSize;
+    }
+    return n;
+  }
+
+private:
+  // 5x7 glyph pattern + spacing column and row, all 6x8 written when opaque
+  void drawChar(int16_t x, int16_t y, char c) {
+    for (int16_t row = 0; row < 8; row++) {
+      for (int16_t col = 0; col < 6; col++) {
+        bool on = col < 5 && row < 7 && ((uint8_t)c * 7 + row * 5 + col * 3) % 4 == 0;
+        if (!on && _textBg == _textColor) continue; // Transparent background
+        fillRect(x + col * _textSize, y + row * _textSize, _textSize, _textSize, on ? _textColor : _textBg);
+      }
+    }
+  }
+
+  int16_t _width, _height;
+  std::vector<uint16_t> _fb;
+  uint32_t _pushed = 0;
+
+  uint8_t _textSize = 1;
+  uint16_t _textColor = 0xFFFF;
+  uint16_t _textBg = 0xFFFF;
+  int16_t _cursorX = 0, _cursorY = 0;
+};
+
+#endif // HOST_ADAFRUIT_GFX_H
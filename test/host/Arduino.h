@@ -0,0 +1,107 @@
+// Host stand-in for the Arduino core, FreeRTOS and esp_timer
+// Only what the modules built by [env:native] use. Time does not run on its
+// own: tests set it with hostSetTimeUs()/hostAdvanceUs(), so millis(),
+// micros() and esp_timer_get_time() are deterministic.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <assert.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using std::min;
+using std::max;
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define IRAM_ATTR
+
+// ============================================================================
+// TIME
+// ============================================================================
+inline std::atomic<int64_t> &hostClockUs() {
+  static std::atomic<int64_t> us{0};
+  return us;
+}
+
+inline void hostSetTimeUs(int64_t us) { hostClockUs().store(us); }
+inline void hostAdvanceUs(int64_t us) { hostClockUs().fetch_add(us); }
+
+inline int64_t esp_timer_get_time() { return hostClockUs().load(); }
+inline unsigned long micros() { return (unsigned long)esp_timer_get_time(); }
+inline unsigned long millis() { return (unsigned long)(esp_timer_get_time() / 1000); }
+
+// ============================================================================
+// FREERTOS
+// ============================================================================
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void *TaskHandle_t;
+typedef std::mutex *SemaphoreHandle_t;
+
+#define pdTRUE        1
+#define pdFALSE       0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configASSERT(x) assert(x)
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::mutex(); }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t lock, TickType_t) {
+  lock->lock();
+  return pdTRUE;
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t lock) {
+  lock->unlock();
+  return pdTRUE;
+}
+
+inline void vTaskDelay(TickType_t) { std::this_thread::yield(); }
+
+// ============================================================================
+// STRING / SERIAL
+// ============================================================================
+class String {
+public:
+  String(const char *s = "") : _s(s) {}
+  // Like the core: dtostrf() into a stack buffer, then copied to the heap
+  String(double value, unsigned char decimals) {
+    char buf[33];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+    _s = buf;
+  }
+  const char *c_str() const { return _s.c_str(); }
+  size_t length() const { return _s.size(); }
+
+private:
+  std::string _s;
+};
+
+struct HostSerial {
+  size_t printf(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n > 0 ? n : 0;
+  }
+  size_t print(const char *s) { return ::printf("%s", s); }
+  size_t println(const char *s = "") { return ::printf("%s\n", s); }
+};
+
+inline HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,37 @@
+// Host stand-in for ESPAsyncWebServer
+// Just the chunked response used by metrics.cpp: send() drains the filler
+// into body, as the library would into the TCP window.
+
+#ifndef HOST_ESP_ASYNC_WEB_SERVER_H
+#define HOST_ESP_ASYNC_WEB_SERVER_H
+
+#include <Arduino.h>
+#include <functional>
+
+typedef std::function<size_t(uint8_t *, size_t, size_t)> AwsResponseFiller;
+
+class AsyncWebServerResponse {
+public:
+  explicit AsyncWebServerResponse(AwsResponseFiller filler) : filler(filler) {}
+  AwsResponseFiller filler;
+};
+
+class AsyncWebServerRequest {
+public:
+  AsyncWebServerResponse *beginChunkedResponse(const char *, AwsResponseFiller filler) {
+    return new AsyncWebServerResponse(filler);
+  }
+
+  void send(AsyncWebServerResponse *response) {
+    uint8_t chunk[256];
+    size_t n;
+    while ((n = response->filler(chunk, sizeof(chunk), body.size())) > 0) {
+      body.append((const char *)chunk, n);
+    }
+    delete response;
+  }
+
+  std::string body;
+};
+
+#endif // HOST_ESP_ASYNC_WEB_SERVER_H
@@ -0,0 +1,284 @@
+// Fixed-point coordinates: round trips, edge cases and a benchmark
+// Every conversion the firmware makes with 1e-7 degree coordinates must come
+// back bit-exact: NMEA minutes to E7, E7 to degrees and back, E7 to the wire
+// text and back, and through the breadcrumb history. The offset/move math is
+// checked across the antimeridian and at the poles, and the integer path of
+// one epoch is timed against the double one it replaced.
+
+#include <unity.h>
+#include <chrono>
+#include <random>
+#include "coord_e7.h"
+#include "num_format.h"
+#include "track_history.h"
+
+static std::mt19937 rng;
+
+void setUp() {
+  rng.seed(40);
+}
+
+void tearDown() {}
+
+// Random coordinate in [-limitDeg, limitDeg] degrees
+static int32_t randomE7(int32_t limitDeg) {
+  std::uniform_int_distribution<int32_t> d(-limitDeg * COORD_E7_SCALE, limitDeg * COORD_E7_SCALE);
+  return d(rng);
+}
+
+// ============================================================================
+// ROUND TRIPS
+// ============================================================================
+// TinyGPSPlus parseDegrees(): ddmm.mmmmm -> whole degrees + billionths, from
+// the minutes in 1e-7 minute units. The E7 value must be the minutes / 60
+// rounded once, as if the NMEA text had been converted exactly.
+void test_nmea_minutes_round_once() {
+  std::uniform_int_distribution<uint32_t> tenMillionths(0, 60UL * 10000000UL - 1);
+  for (int i = 0; i < 200000; i++) {
+    uint32_t t = i < 120 ? i : tenMillionths(rng); // Every remainder mod 60, then at random
+    uint16_t deg = i % 180;
+    uint32_t billionths = (5 * (uint64_t)t + 1) / 3;
+    int64_t exact = (int64_t)deg * COORD_E7_SCALE + (t + 30) / 60;
+    TEST_ASSERT_EQUAL_INT64(exact, coordE7FromRaw(deg, billionths, false));
+    TEST_ASSERT_EQUAL_INT64(-exact, coordE7FromRaw(deg, billionths, true));
+  }
+  // 4843.66666,N / 00220.78734,E
+  TEST_ASSERT_EQUAL_INT32(487277777, coordE7FromRaw(48, (5 * 436666600ULL + 1) / 3, false));
+  TEST_ASSERT_EQUAL_INT32(23464557, coordE7FromRaw(2, (5 * 207873400ULL + 1) / 3, false));
+}
+
+// The doubles handed to consumers convert back to the same integer
+void test_degrees_round_trip() {
+  const int32_t edges[] = {0, 1, -1, 900000000, -900000000, 1800000000, -1800000000, 899999999, -1799999999};
+  for (int32_t e7 : edges) {
+    TEST_ASSERT_EQUAL_INT32(e7, coordE7FromDegrees(coordE7ToDegrees(e7)));
+  }
+  for (int i = 0; i < 1000000; i++) {
+    int32_t e7 = randomE7(180);
+    TEST_ASSERT_EQUAL_INT32(e7, coordE7FromDegrees(coordE7ToDegrees(e7)));
+  }
+}
+
+// Parse the wire text back as gpsd/MQTT clients do (strtod), and exactly
+static int32_t parseE7(const char *text) {
+  bool negative = *text == '-';
+  if (negative) text++;
+  int64_t v = 0;
+  int decimals = -1;
+  for (; *text; text++) {
+    if (*text == '.') {
+      decimals = 0;
+      continue;
+    }
+    v = v * 10 + (*text - '0');
+    if (decimals >= 0) decimals++;
+  }
+  for (; decimals < 7; decimals++) v *= 10;
+  return (int32_t)(negative ? -v : v);
+}
+
+void test_wire_text_round_trip() {
+  static const int32_t edges[] = {0, -1, 1800000000, -1800000000};
+  char buf[24];
+  for (int i = 0; i < 1000000; i++) {
+    int32_t e7 = i < 4 ? edges[i] : randomE7(180);
+    fmtScaled(buf, sizeof(buf), e7, 7, FMT_WIRE_COORD);
+    TEST_ASSERT_EQUAL_INT32(e7, parseE7(buf));
+    TEST_ASSERT_EQUAL_INT32(e7, coordE7FromDegrees(strtod(buf, nullptr)));
+  }
+}
+
+// ============================================================================
+// OFFSET / MOVE
+// ============================================================================
+// Move then measure back: within the Q16/Q24 truncation, a few cm
+void test_move_then_offset() {
+  std::uniform_int_distribution<int32_t> cm(-500000, 500000); // +-5 km
+  for (int i = 0; i < 100000; i++) {
+    int32_t lat = randomE7(80), lng = randomE7(180);
+    int32_t east = cm(rng), north = cm(rng);
+    int32_t lat1, lng1, east1, north1;
+    coordE7Move(lat, lng, east, north, &lat1, &lng1);
+    coordE7OffsetCmScaled(lat, lng, lat1, lng1, coordE7LngScaleQ16(lat), &east1, &north1);
+    TEST_ASSERT_INT32_WITHIN(2, north, north1);
+    TEST_ASSERT_INT32_WITHIN(3, east, east1);
+  }
+}
+
+void test_antimeridian() {
+  int32_t east, north;
+  // 179.9999 E to 179.9999 W is 0.0002 degree east, not 359.9998 west
+  coordE7OffsetCm(0, 1799999000, 0, -1799999000, &east, &north);
+  TEST_ASSERT_INT32_WITHIN(1, 2224, east);
+  TEST_ASSERT_EQUAL_INT32(0, north);
+  coordE7OffsetCm(0, -1799999000, 0, 1799999000, &east, &north);
+  TEST_ASSERT_INT32_WITHIN(1, -2224, east);
+  TEST_ASSERT_UINT32_WITHIN(1, 2224, coordE7DistanceCm(0, 1799999000, 0, -1799999000));
+
+  // Moving across wraps the longitude back into [-180, 180]
+  int32_t lat, lng;
+  coordE7Move(0, 1799999000, 5000, 0, &lat, &lng);
+  TEST_ASSERT_EQUAL_INT32(0, lat);
+  TEST_ASSERT_TRUE(lng < -1799990000 && lng >= -1800000000);
+  coordE7Move(0, -1799999000, -5000, 0, &lat, &lng);
+  TEST_ASSERT_TRUE(lng > 1799990000 && lng <= 1800000000);
+
+  // And back to the start
+  int32_t lat2, lng2;
+  coordE7Move(0, 1799999000, 5000, 0, &lat, &lng);
+  coordE7Move(lat, lng, -5000, 0, &lat2, &lng2);
+  TEST_ASSERT_INT32_WITHIN(1, 1799999000, lng2);
+}
+
+void test_poles() {
+  int32_t lat, lng;
+  // Past the pole clamps to it
+  coordE7Move(899999000, 100000000, 0, 100000, &lat, &lng);
+  TEST_ASSERT_EQUAL_INT32(900000000, lat);
+  coordE7Move(-899999000, 100000000, 0, -100000, &lat, &lng);
+  TEST_ASSERT_EQUAL_INT32(-900000000, lat);
+
+  // At the pole east/west has no length: no division by zero, longitude
+  // stays in range
+  TEST_ASSERT_EQUAL_INT32(0, coordE7LngScaleQ16(900000000));
+  const int32_t eastCm[] = {100000, -100000, 500000, -500000};
+  for (int32_t east : eastCm) {
+    coordE7Move(900000000, 1799999000, east, 0, &lat, &lng);
+    TEST_ASSERT_EQUAL_INT32(900000000, lat);
+    TEST_ASSERT_TRUE(lng >= -1800000000 && lng <= 1800000000);
+    coordE7Move(-899999999, -1799999000, east, 0, &lat, &lng);
+    TEST_ASSERT_TRUE(lng >= -1800000000 && lng <= 1800000000);
+  }
+
+  // Every longitude is the same point
+  TEST_ASSERT_EQUAL_UINT32(0, coordE7DistanceCm(900000000, 0, 900000000, 1700000000));
+  TEST_ASSERT_EQUAL_UINT32(0, coordE7DistanceCm(-900000000, -450000000, -900000000, 450000000));
+}
+
+// ============================================================================
+// DISTANCE
+// ============================================================================
+// TinyGPSPlus::distanceBetween(), the double haversine the integer math replaced
+static double haversineM(double lat1, double lng1, double lat2, double lng2) {
+  double delta = (lng1 - lng2) * M_PI / 180.0;
+  double sdlong = sin(delta), cdlong = cos(delta);
+  lat1 = lat1 * M_PI / 180.0;
+  lat2 = lat2 * M_PI / 180.0;
+  double slat1 = sin(lat1), clat1 = cos(lat1), slat2 = sin(lat2), clat2 = cos(lat2);
+  delta = (clat1 * slat2) - (slat1 * clat2 * cdlong);
+  delta = sqrt(delta * delta + (clat2 * sdlong) * (clat2 * sdlong));
+  double denom = (slat1 * slat2) + (clat1 * clat2 * cdlong);
+  return atan2(delta, denom) * 6372795;
+}
+
+void test_distance_matches_haversine() {
+  std::uniform_int_distribution<int32_t> near(-300000, 300000); // ~3 km
+  for (int i = 0; i < 100000; i++) {
+    int32_t lat0 = randomE7(80), lng0 = randomE7(180);
+    int32_t lat1 = lat0 + near(rng), lng1 = lng0 + near(rng);
+    if (lng1 > 1800000000) lng1 -= 3600000000LL;
+    if (lng1 < -1800000000) lng1 += 3600000000LL;
+    double ref = haversineM(coordE7ToDegrees(lat0), coordE7ToDegrees(lng0), coordE7ToDegrees(lat1),
+                            coordE7ToDegrees(lng1)) * 100.0;
+    double cm = coordE7DistanceCm(lat0, lng0, lat1, lng1);
+    // Mean vs TinyGPSPlus radius (0.05%) + equirectangular and Q16 error
+    TEST_ASSERT_DOUBLE_WITHIN(ref * 0.002 + 2, ref, cm);
+  }
+}
+
+// ============================================================================
+// TRACK HISTORY
+// ============================================================================
+static TrackHistory history;
+
+void test_history_round_trip() {
+  history.begin();
+  history.clear();
+  static TrackPoint written[TRACK_HISTORY_SIZE + 500];
+  int32_t lat = 487277777, lng = 1799000000;
+  size_t n = 0;
+  for (size_t i = 0; i < TRACK_HISTORY_SIZE + 500; i++) {
+    coordE7Move(lat, lng, 4000 + (int32_t)(rng() % 3000), (int32_t)(rng() % 2000) - 1000, &lat, &lng);
+    if (history.add(lat, lng)) written[n++] = {lat, lng};
+  }
+  TEST_ASSERT_EQUAL_UINT32(n, history.next());
+  TEST_ASSERT_TRUE(n > TRACK_HISTORY_SIZE); // Wrapped, and crossed the antimeridian on the way
+
+  // From 0: moved up to the oldest point still held, every bit intact
+  static TrackPoint out[TRACK_HISTORY_SIZE];
+  uint32_t from = 0;
+  size_t got = history.read(&from, out, TRACK_HISTORY_SIZE);
+  TEST_ASSERT_EQUAL_UINT32(TRACK_HISTORY_SIZE, got);
+  TEST_ASSERT_EQUAL_UINT32(n, from);
+  TEST_ASSERT_EQUAL_MEMORY(written + n - TRACK_HISTORY_SIZE, out, sizeof(out));
+
+  // Incremental read sees only the new point
+  TEST_ASSERT_TRUE(history.add(lat + 100000, lng));
+  got = history.read(&from, out, TRACK_HISTORY_SIZE);
+  TEST_ASSERT_EQUAL_UINT32(1, got);
+  TEST_ASSERT_EQUAL_INT32(lat + 100000, out[0].latE7);
+  TEST_ASSERT_EQUAL_INT32(lng, out[0].lngE7);
+}
+
+void test_history_drops_jitter() {
+  history.begin();
+  history.clear();
+  TEST_ASSERT_TRUE(history.add(487277777, 23464557));
+  // 1e-7 degree is ~1 cm: fix jitter below TRACK_MIN_SPACING_CM is not kept
+  TEST_ASSERT_FALSE(history.add(487277777 + TRACK_MIN_SPACING_CM / 2, 23464557));
+  TEST_ASSERT_TRUE(history.add(487277777 + TRACK_MIN_SPACING_CM * 2, 23464557));
+  TEST_ASSERT_EQUAL_UINT32(2, history.next());
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+#define BENCH_EPOCHS 200000
+
+static volatile uint32_t benchSink;
+
+// What one epoch does with the position: distance from the previous fix (track
+// spacing, DR error) and both coordinates as wire text. Host time, reported
+// only; the ESP32-S3 gap is wider since its doubles are software.
+void test_benchmark_epoch() {
+  int32_t lat[2] = {487277777, 487278777}, lng[2] = {23464557, 23465557};
+  char a[24], b[24];
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCH_EPOCHS; i++) {
+    double la = (lat[1] + i) / 1e7, lo = (lng[1] + i) / 1e7;
+    double d = haversineM(lat[0] / 1e7, lng[0] / 1e7, la, lo);
+    snprintf(a, sizeof(a), "%.7f", la);
+    snprintf(b, sizeof(b), "%.7f", lo);
+    benchSink = (uint32_t)d + a[3] + b[3];
+  }
+  auto mid = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCH_EPOCHS; i++) {
+    uint32_t d = coordE7DistanceCm(lat[0], lng[0], lat[1] + i, lng[1] + i);
+    fmtScaled(a, sizeof(a), lat[1] + i, 7, FMT_WIRE_COORD);
+    fmtScaled(b, sizeof(b), lng[1] + i, 7, FMT_WIRE_COORD);
+    benchSink = d + a[3] + b[3];
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double doubleNs = std::chrono::duration<double, std::nano>(mid - start).count() / BENCH_EPOCHS;
+  double fixedNs = std::chrono::duration<double, std::nano>(end - mid).count() / BENCH_EPOCHS;
+  char msg[120];
+  snprintf(msg, sizeof(msg), "per epoch: double %.1f ns, fixed point %.1f ns (host)", doubleNs, fixedNs);
+  TEST_MESSAGE(msg);
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_nmea_minutes_round_once);
+  RUN_TEST(test_degrees_round_trip);
+  RUN_TEST(test_wire_text_round_trip);
+  RUN_TEST(test_move_then_offset);
+  RUN_TEST(test_antimeridian);
+  RUN_TEST(test_poles);
+  RUN_TEST(test_distance_matches_haversine);
+  RUN_TEST(test_history_round_trip);
+  RUN_TEST(test_history_drops_jitter);
+  RUN_TEST(test_benchmark_epoch);
+  return UNITY_END();
+}
@@ -0,0 +1,231 @@
+// Replayed drive for test_dead_reckoning: 217 s of 1 Hz GPRMC
+// Generated with: python3 tools/nmea_track_gen.py --seed 43 --c-array
+// (synthetic: city turns, a roundabout, a 6 s tunnel without fix and a fast
+// curve, with a wandering receiver offset). A recorded log's RMC sentences
+// can replace it.
+
+#ifndef DRIVE_TRACK_H
+#define DRIVE_TRACK_H
+
+static const char *const DRIVE_RMC[] = {
+  "$GPRMC,083001.00,A,4843.66649,N,00220.78731,E,0.000,,191026,,,A*7D",
+  "$GPRMC,083002.00,A,4843.66633,N,00220.78734,E,0.000,,191026,,,A*76",
+  "$GPRMC,083003.00,A,4843.66653,N,00220.78723,E,0.106,33.64,191026,,,A*5C",
+  "$GPRMC,083004.00,A,4843.66702,N,00220.78729,E,0.000,,191026,,,A*7F",
+  "$GPRMC,083005.00,A,4843.66700,N,00220.78699,E,0.000,,191026,,,A*76",
+  "$GPRMC,083006.00,A,4843.66681,N,00220.78706,E,0.093,,191026,,,A*70",
+  "$GPRMC,083007.00,A,4843.66700,N,00220.78674,E,0.114,41.70,191026,,,A*5F",
+  "$GPRMC,083008.00,A,4843.66670,N,00220.78632,E,0.180,29.30,191026,,,A*53",
+  "$GPRMC,083009.00,A,4843.66657,N,00220.78649,E,0.044,,191026,,,A*74",
+  "$GPRMC,083010.00,A,4843.66634,N,00220.78731,E,0.082,,191026,,,A*7D",
+  "$GPRMC,083011.00,A,4843.66676,N,00220.78762,E,3.288,33.49,191026,,,A*54",
+  "$GPRMC,083012.00,A,4843.66823,N,00220.78842,E,6.384,35.63,191026,,,A*52",
+  "$GPRMC,083013.00,A,4843.67015,N,00220.79071,E,9.672,34.75,191026,,,A*53",
+  "$GPRMC,083014.00,A,4843.67290,N,00220.79343,E,12.894,35.80,191026,,,A*6E",
+  "$GPRMC,083015.00,A,4843.67624,N,00220.79678,E,16.150,34.34,191026,,,A*62",
+  "$GPRMC,083016.00,A,4843.68055,N,00220.80183,E,19.477,34.52,191026,,,A*64",
+  "$GPRMC,083017.00,A,4843.68562,N,00220.80651,E,22.790,35.62,191026,,,A*6C",
+  "$GPRMC,083018.00,A,4843.69123,N,00220.81208,E,25.869,33.95,191026,,,A*6A",
+  "$GPRMC,083019.00,A,4843.69764,N,00220.81925,E,27.024,34.95,191026,,,A*6E",
+  "$GPRMC,083020.00,A,4843.70379,N,00220.82577,E,27.074,34.85,191026,,,A*68",
+  "$GPRMC,083021.00,A,4843.70975,N,00220.83277,E,26.921,34.44,191026,,,A*6C",
+  "$GPRMC,083022.00,A,4843.71613,N,00220.83962,E,27.009,34.79,191026,,,A*62",
+  "$GPRMC,083023.00,A,4843.72194,N,00220.84574,E,27.151,34.97,191026,,,A*68",
+  "$GPRMC,083024.00,A,4843.72802,N,00220.85206,E,27.059,35.45,191026,,,A*6D",
+  "$GPRMC,083025.00,A,4843.73394,N,00220.85823,E,26.910,34.38,191026,,,A*6A",
+  "$GPRMC,083026.00,A,4843.74020,N,00220.86478,E,27.036,36.13,191026,,,A*64",
+  "$GPRMC,083027.00,A,4843.74623,N,00220.87165,E,27.081,34.52,191026,,,A*63",
+  "$GPRMC,083028.00,A,4843.75246,N,00220.87816,E,26.953,33.15,191026,,,A*64",
+  "$GPRMC,083029.00,A,4843.75858,N,00220.88476,E,27.029,35.55,191026,,,A*62",
+  "$GPRMC,083030.00,A,4843.76470,N,00220.89096,E,26.923,34.42,191026,,,A*61",
+  "$GPRMC,083031.00,A,4843.77054,N,00220.89788,E,26.944,34.10,191026,,,A*6D",
+  "$GPRMC,083032.00,A,4843.77659,N,00220.90422,E,27.033,34.96,191026,,,A*68",
+  "$GPRMC,083033.00,A,4843.78295,N,00220.91049,E,26.928,36.03,191026,,,A*66",
+  "$GPRMC,083034.00,A,4843.78913,N,00220.91706,E,26.922,37.02,191026,,,A*62",
+  "$GPRMC,083035.00,A,4843.79512,N,00220.92297,E,27.011,35.79,191026,,,A*67",
+  "$GPRMC,083036.00,A,4843.80093,N,00220.92958,E,27.022,35.37,191026,,,A*6C",
+  "$GPRMC,083037.00,A,4843.80694,N,00220.93642,E,27.019,34.14,191026,,,A*61",
+  "$GPRMC,083038.00,A,4843.81288,N,00220.94317,E,26.905,36.27,191026,,,A*63",
+  "$GPRMC,083039.00,A,4843.81905,N,00220.94953,E,27.110,34.63,191026,,,A*69",
+  "$GPRMC,083040.00,A,4843.82505,N,00220.95632,E,27.081,35.39,191026,,,A*66",
+  "$GPRMC,083041.00,A,4843.83112,N,00220.96264,E,26.985,34.24,191026,,,A*61",
+  "$GPRMC,083042.00,A,4843.83711,N,00220.96939,E,27.001,34.96,191026,,,A*69",
+  "$GPRMC,083043.00,A,4843.84320,N,00220.97585,E,26.977,35.60,191026,,,A*62",
+  "$GPRMC,083044.00,A,4843.84943,N,00220.98287,E,27.034,36.90,191026,,,A*63",
+  "$GPRMC,083045.00,A,4843.85553,N,00220.98909,E,26.817,34.80,191026,,,A*68",
+  "$GPRMC,083046.00,A,4843.86193,N,00220.99544,E,26.864,34.56,191026,,,A*6B",
+  "$GPRMC,083047.00,A,4843.86864,N,00221.00193,E,26.904,35.22,191026,,,A*61",
+  "$GPRMC,083048.00,A,4843.87402,N,00221.00906,E,23.699,46.17,191026,,,A*6B",
+  "$GPRMC,083049.00,A,4843.87789,N,00221.01642,E,20.572,57.41,191026,,,A*62",
+  "$GPRMC,083050.00,A,4843.88010,N,00221.02315,E,17.373,69.40,191026,,,A*69",
+  "$GPRMC,083051.00,A,4843.88120,N,00221.02929,E,14.063,78.62,191026,,,A*6E",
+  "$GPRMC,083052.00,A,4843.88141,N,00221.03527,E,13.551,91.16,191026,,,A*6E",
+  "$GPRMC,083053.00,A,4843.88128,N,00221.04034,E,13.502,102.20,191026,,,A*58",
+  "$GPRMC,083054.00,A,4843.87949,N,00221.04516,E,13.523,114.37,191026,,,A*58",
+  "$GPRMC,083055.00,A,4843.87749,N,00221.04967,E,13.594,125.56,191026,,,A*54",
+  "$GPRMC,083056.00,A,4843.87504,N,00221.05485,E,16.786,124.77,191026,,,A*5A",
+  "$GPRMC,083057.00,A,4843.87192,N,00221.06109,E,20.046,123.43,191026,,,A*5C",
+  "$GPRMC,083058.00,A,4843.86859,N,00221.06866,E,23.375,126.17,191026,,,A*58",
+  "$GPRMC,083059.00,A,4843.86505,N,00221.07745,E,26.416,126.69,191026,,,A*5C",
+  "$GPRMC,083100.00,A,4843.86082,N,00221.08672,E,26.919,124.16,191026,,,A*59",
+  "$GPRMC,083101.00,A,4843.85629,N,00221.09586,E,27.007,123.47,191026,,,A*51",
+  "$GPRMC,083102.00,A,4843.85178,N,00221.10537,E,26.998,123.49,191026,,,A*53",
+  "$GPRMC,083103.00,A,4843.84750,N,00221.11448,E,26.957,125.70,191026,,,A*58",
+  "$GPRMC,083104.00,A,4843.84327,N,00221.12370,E,27.020,125.69,191026,,,A*54",
+  "$GPRMC,083105.00,A,4843.83910,N,00221.13322,E,27.126,123.39,191026,,,A*5E",
+  "$GPRMC,083106.00,A,4843.83485,N,00221.14254,E,27.056,123.40,191026,,,A*53",
+  "$GPRMC,083107.00,A,4843.83090,N,00221.15199,E,27.200,125.58,191026,,,A*5F",
+  "$GPRMC,083108.00,A,4843.82662,N,00221.16159,E,27.002,125.61,191026,,,A*5F",
+  "$GPRMC,083109.00,A,4843.82215,N,00221.17118,E,27.112,123.95,191026,,,A*53",
+  "$GPRMC,083110.00,A,4843.81808,N,00221.18016,E,27.045,124.31,191026,,,A*54",
+  "$GPRMC,083111.00,A,4843.81349,N,00221.18937,E,27.046,126.04,191026,,,A*56",
+  "$GPRMC,083112.00,A,4843.80926,N,00221.19861,E,27.024,125.94,191026,,,A*5A",
+  "$GPRMC,083113.00,A,4843.80489,N,00221.20800,E,26.907,124.73,191026,,,A*5F",
+  "$GPRMC,083114.00,A,4843.80060,N,00221.21714,E,26.970,124.86,191026,,,A*5A",
+  "$GPRMC,083115.00,A,4843.79622,N,00221.22618,E,26.953,125.59,191026,,,A*51",
+  "$GPRMC,083116.00,A,4843.79340,N,00221.23619,E,23.908,110.12,191026,,,A*51",
+  "$GPRMC,083117.00,A,4843.79235,N,00221.24497,E,20.597,96.69,191026,,,A*6A",
+  "$GPRMC,083118.00,A,4843.79280,N,00221.25285,E,17.412,81.70,191026,,,A*69",
+  "$GPRMC,083119.00,A,4843.79394,N,00221.25894,E,14.155,65.41,191026,,,A*6B",
+  "$GPRMC,083120.00,A,4843.79584,N,00221.26422,E,13.497,50.98,191026,,,A*6A",
+  "$GPRMC,083121.00,A,4843.79856,N,00221.26798,E,13.486,36.22,191026,,,A*6A",
+  "$GPRMC,083122.00,A,4843.80168,N,00221.27166,E,16.728,34.79,191026,,,A*63",
+  "$GPRMC,083123.00,A,4843.80588,N,00221.27648,E,20.020,34.05,191026,,,A*62",
+  "$GPRMC,083124.00,A,4843.81102,N,00221.28156,E,23.055,35.76,191026,,,A*61",
+  "$GPRMC,083125.00,A,4843.81648,N,00221.28748,E,24.238,34.42,191026,,,A*68",
+  "$GPRMC,083126.00,A,4843.82213,N,00221.29343,E,24.301,33.40,191026,,,A*62",
+  "$GPRMC,083127.00,A,4843.82762,N,00221.29952,E,24.242,35.32,191026,,,A*6F",
+  "$GPRMC,083128.00,A,4843.83316,N,00221.30483,E,24.370,33.66,191026,,,A*68",
+  "$GPRMC,083129.00,A,4843.83879,N,00221.31087,E,24.268,34.82,191026,,,A*6F",
+  "$GPRMC,083130.00,A,4843.84412,N,00221.31654,E,24.193,36.25,191026,,,A*61",
+  "$GPRMC,083131.00,A,4843.84974,N,00221.32237,E,24.329,33.71,191026,,,A*68",
+  "$GPRMC,083132.00,A,4843.85524,N,00221.32769,E,24.234,34.67,191026,,,A*60",
+  "$GPRMC,083133.00,A,4843.86047,N,00221.33311,E,24.217,34.19,191026,,,A*60",
+  "$GPRMC,083134.00,A,4843.86636,N,00221.33873,E,24.242,33.42,191026,,,A*61",
+  "$GPRMC,083135.00,A,4843.87172,N,00221.34499,E,24.378,32.99,191026,,,A*66",
+  "$GPRMC,083136.00,A,4843.87756,N,00221.35113,E,24.219,36.42,191026,,,A*67",
+  "$GPRMC,083137.00,A,4843.88239,N,00221.35762,E,21.163,52.17,191026,,,A*6C",
+  "$GPRMC,083138.00,A,4843.88522,N,00221.36450,E,17.762,63.19,191026,,,A*61",
+  "$GPRMC,083139.00,A,4843.88630,N,00221.37134,E,14.557,81.97,191026,,,A*6B",
+  "$GPRMC,083140.00,A,4843.88644,N,00221.37683,E,13.506,95.49,191026,,,A*68",
+  "$GPRMC,083141.00,A,4843.88581,N,00221.38250,E,13.470,110.53,191026,,,A*51",
+  "$GPRMC,083142.00,A,4843.88395,N,00221.38757,E,13.325,124.48,191026,,,A*59",
+  "$GPRMC,083143.00,A,4843.88114,N,00221.39173,E,13.458,140.13,191026,,,A*53",
+  "$GPRMC,083144.00,A,4843.87816,N,00221.39494,E,13.541,153.76,191026,,,A*54",
+  "$GPRMC,083145.00,A,4843.87475,N,00221.39696,E,13.521,169.23,191026,,,A*53",
+  "$GPRMC,083146.00,A,4843.87087,N,00221.39766,E,13.527,184.57,191026,,,A*51",
+  "$GPRMC,083147.00,A,4843.86705,N,00221.39613,E,13.583,198.64,191026,,,A*5C",
+  "$GPRMC,083148.00,A,4843.86388,N,00221.39349,E,13.436,216.14,191026,,,A*55",
+  "$GPRMC,083149.00,A,4843.86116,N,00221.38976,E,13.538,230.09,191026,,,A*51",
+  "$GPRMC,083150.00,A,4843.85905,N,00221.38448,E,13.440,244.93,191026,,,A*5E",
+  "$GPRMC,083151.00,A,4843.85771,N,00221.37923,E,13.406,259.08,191026,,,A*51",
+  "$GPRMC,083152.00,A,4843.85747,N,00221.37396,E,13.575,274.73,191026,,,A*55",
+  "$GPRMC,083153.00,A,4843.85852,N,00221.36785,E,13.470,290.32,191026,,,A*53",
+  "$GPRMC,083154.00,A,4843.86058,N,00221.36278,E,13.437,304.98,191026,,,A*5D",
+  "$GPRMC,083155.00,A,4843.86282,N,00221.35782,E,16.775,306.00,191026,,,A*59",
+  "$GPRMC,083156.00,A,4843.86578,N,00221.35130,E,20.010,305.09,191026,,,A*5C",
+  "$GPRMC,083157.00,A,4843.86913,N,00221.34377,E,23.224,304.59,191026,,,A*5E",
+  "$GPRMC,083158.00,A,4843.87325,N,00221.33521,E,26.429,305.99,191026,,,A*5E",
+  "$GPRMC,083159.00,A,4843.87713,N,00221.32549,E,29.636,303.45,191026,,,A*55",
+  "$GPRMC,083200.00,A,4843.88211,N,00221.31448,E,32.973,305.04,191026,,,A*56",
+  "$GPRMC,083201.00,A,4843.88784,N,00221.30316,E,36.176,305.62,191026,,,A*5A",
+  "$GPRMC,083202.00,A,4843.89391,N,00221.29000,E,37.716,305.65,191026,,,A*52",
+  "$GPRMC,083203.00,A,4843.89969,N,00221.27744,E,37.793,303.94,191026,,,A*52",
+  "$GPRMC,083204.00,A,4843.90560,N,00221.26490,E,37.882,304.88,191026,,,A*56",
+  "$GPRMC,083205.00,A,4843.91177,N,00221.25175,E,37.658,304.76,191026,,,A*51",
+  "$GPRMC,083206.00,A,4843.91802,N,00221.23851,E,37.786,305.31,191026,,,A*50",
+  "$GPRMC,083207.00,A,4843.92455,N,00221.22495,E,37.994,305.10,191026,,,A*57",
+  "$GPRMC,083208.00,A,4843.93060,N,00221.21167,E,37.806,306.64,191026,,,A*5A",
+  "$GPRMC,083209.00,A,4843.93659,N,00221.19856,E,37.835,306.29,191026,,,A*5E",
+  "$GPRMC,083210.00,V,,,,,,,191026,,,N*78",
+  "$GPRMC,083211.00,V,,,,,,,191026,,,N*79",
+  "$GPRMC,083212.00,V,,,,,,,191026,,,N*7A",
+  "$GPRMC,083213.00,V,,,,,,,191026,,,N*7B",
+  "$GPRMC,083214.00,V,,,,,,,191026,,,N*7C",
+  "$GPRMC,083215.00,V,,,,,,,191026,,,N*7D",
+  "$GPRMC,083216.00,A,4843.97890,N,00221.10641,E,37.815,304.59,191026,,,A*59",
+  "$GPRMC,083217.00,A,4843.98468,N,00221.09414,E,37.890,305.01,191026,,,A*57",
+  "$GPRMC,083218.00,A,4843.99057,N,00221.08090,E,37.878,304.54,191026,,,A*5F",
+  "$GPRMC,083219.00,A,4843.99627,N,00221.06813,E,37.684,305.41,191026,,,A*5A",
+  "$GPRMC,083220.00,A,4844.00251,N,00221.05503,E,37.754,305.31,191026,,,A*56",
+  "$GPRMC,083221.00,A,4844.00857,N,00221.04219,E,37.869,303.74,191026,,,A*50",
+  "$GPRMC,083222.00,A,4844.01464,N,00221.02920,E,37.721,304.37,191026,,,A*5A",
+  "$GPRMC,083223.00,A,4844.02025,N,00221.01592,E,37.802,304.02,191026,,,A*57",
+  "$GPRMC,083224.00,A,4844.02563,N,00221.00338,E,37.925,302.89,191026,,,A*51",
+  "$GPRMC,083225.00,A,4844.03138,N,00220.99101,E,37.599,304.86,191026,,,A*50",
+  "$GPRMC,083226.00,A,4844.03761,N,00220.97786,E,37.879,304.78,191026,,,A*5C",
+  "$GPRMC,083227.00,A,4844.04370,N,00220.96452,E,37.738,303.91,191026,,,A*5F",
+  "$GPRMC,083228.00,A,4844.04939,N,00220.95132,E,37.813,306.21,191026,,,A*5F",
+  "$GPRMC,083229.00,A,4844.05535,N,00220.93854,E,37.888,305.93,191026,,,A*58",
+  "$GPRMC,083230.00,A,4844.06175,N,00220.92542,E,37.852,304.25,191026,,,A*53",
+  "$GPRMC,083231.00,A,4844.06802,N,00220.91201,E,41.230,307.96,191026,,,A*5C",
+  "$GPRMC,083232.00,A,4844.07537,N,00220.89763,E,44.423,309.52,191026,,,A*5A",
+  "$GPRMC,083233.00,A,4844.08329,N,00220.88295,E,47.488,310.82,191026,,,A*57",
+  "$GPRMC,083234.00,A,4844.09258,N,00220.86764,E,48.499,311.76,191026,,,A*56",
+  "$GPRMC,083235.00,A,4844.10157,N,00220.85309,E,48.567,314.86,191026,,,A*55",
+  "$GPRMC,083236.00,A,4844.11135,N,00220.83886,E,48.535,317.54,191026,,,A*52",
+  "$GPRMC,083237.00,A,4844.12142,N,00220.82511,E,48.614,319.01,191026,,,A*5C",
+  "$GPRMC,083238.00,A,4844.13207,N,00220.81162,E,48.612,319.84,191026,,,A*58",
+  "$GPRMC,083239.00,A,4844.14253,N,00220.79893,E,48.371,323.40,191026,,,A*5E",
+  "$GPRMC,083240.00,A,4844.15368,N,00220.78707,E,48.588,326.37,191026,,,A*5E",
+  "$GPRMC,083241.00,A,4844.16498,N,00220.77594,E,48.633,325.44,191026,,,A*57",
+  "$GPRMC,083242.00,A,4844.17613,N,00220.76494,E,48.439,326.57,191026,,,A*5D",
+  "$GPRMC,083243.00,A,4844.18789,N,00220.75466,E,48.488,329.70,191026,,,A*5F",
+  "$GPRMC,083244.00,A,4844.19957,N,00220.74466,E,48.644,333.28,191026,,,A*51",
+  "$GPRMC,083245.00,A,4844.21146,N,00220.73563,E,48.608,335.25,191026,,,A*53",
+  "$GPRMC,083246.00,A,4844.22381,N,00220.72806,E,48.510,335.84,191026,,,A*54",
+  "$GPRMC,083247.00,A,4844.23627,N,00220.72002,E,48.450,339.85,191026,,,A*59",
+  "$GPRMC,083248.00,A,4844.24919,N,00220.71321,E,48.397,341.13,191026,,,A*5E",
+  "$GPRMC,083249.00,A,4844.26236,N,00220.70689,E,48.388,342.55,191026,,,A*52",
+  "$GPRMC,083250.00,A,4844.27576,N,00220.70082,E,48.513,344.26,191026,,,A*53",
+  "$GPRMC,083251.00,A,4844.28887,N,00220.69569,E,48.730,347.03,191026,,,A*51",
+  "$GPRMC,083252.00,A,4844.30251,N,00220.69148,E,48.603,348.64,191026,,,A*52",
+  "$GPRMC,083253.00,A,4844.31524,N,00220.68826,E,48.681,351.55,191026,,,A*57",
+  "$GPRMC,083254.00,A,4844.32852,N,00220.68558,E,48.513,353.01,191026,,,A*50",
+  "$GPRMC,083255.00,A,4844.34215,N,00220.68344,E,48.722,357.00,191026,,,A*50",
+  "$GPRMC,083256.00,A,4844.35550,N,00220.68190,E,48.799,357.86,191026,,,A*51",
+  "$GPRMC,083257.00,A,4844.36908,N,00220.68124,E,48.646,359.17,191026,,,A*58",
+  "$GPRMC,083258.00,A,4844.38242,N,00220.68111,E,48.431,359.78,191026,,,A*51",
+  "$GPRMC,083259.00,A,4844.39591,N,00220.68249,E,48.640,4.21,191026,,,A*55",
+  "$GPRMC,083300.00,A,4844.40971,N,00220.68435,E,48.645,5.34,191026,,,A*59",
+  "$GPRMC,083301.00,A,4844.42309,N,00220.68573,E,48.696,3.74,191026,,,A*50",
+  "$GPRMC,083302.00,A,4844.43660,N,00220.68761,E,48.417,4.96,191026,,,A*59",
+  "$GPRMC,083303.00,A,4844.45015,N,00220.68912,E,48.564,5.58,191026,,,A*56",
+  "$GPRMC,083304.00,A,4844.46352,N,00220.69105,E,48.618,5.22,191026,,,A*58",
+  "$GPRMC,083305.00,A,4844.47662,N,00220.69201,E,48.493,5.98,191026,,,A*59",
+  "$GPRMC,083306.00,A,4844.49011,N,00220.69356,E,48.598,5.08,191026,,,A*56",
+  "$GPRMC,083307.00,A,4844.50357,N,00220.69508,E,48.690,5.53,191026,,,A*56",
+  "$GPRMC,083308.00,A,4844.51688,N,00220.69668,E,48.654,5.22,191026,,,A*54",
+  "$GPRMC,083309.00,A,4844.53037,N,00220.69836,E,48.474,4.68,191026,,,A*5F",
+  "$GPRMC,083310.00,A,4844.54356,N,00220.70033,E,48.555,5.29,191026,,,A*57",
+  "$GPRMC,083311.00,A,4844.55703,N,00220.70198,E,48.425,5.87,191026,,,A*51",
+  "$GPRMC,083312.00,A,4844.57073,N,00220.70368,E,48.619,4.95,191026,,,A*52",
+  "$GPRMC,083313.00,A,4844.58415,N,00220.70560,E,48.616,3.68,191026,,,A*5C",
+  "$GPRMC,083314.00,A,4844.59745,N,00220.70740,E,48.663,4.70,191026,,,A*50",
+  "$GPRMC,083315.00,A,4844.61091,N,00220.70963,E,48.589,4.76,191026,,,A*5A",
+  "$GPRMC,083316.00,A,4844.62407,N,00220.71130,E,45.400,4.62,191026,,,A*56",
+  "$GPRMC,083317.00,A,4844.63603,N,00220.71300,E,42.175,4.44,191026,,,A*55",
+  "$GPRMC,083318.00,A,4844.64704,N,00220.71495,E,38.831,4.20,191026,,,A*56",
+  "$GPRMC,083319.00,A,4844.65751,N,00220.71674,E,35.631,5.04,191026,,,A*5F",
+  "$GPRMC,083320.00,A,4844.66655,N,00220.71806,E,32.297,5.20,191026,,,A*51",
+  "$GPRMC,083321.00,A,4844.67490,N,00220.71902,E,29.021,3.88,191026,,,A*5E",
+  "$GPRMC,083322.00,A,4844.68276,N,00220.71975,E,25.720,4.22,191026,,,A*51",
+  "$GPRMC,083323.00,A,4844.68982,N,00220.72046,E,22.636,5.54,191026,,,A*5B",
+  "$GPRMC,083324.00,A,4844.69581,N,00220.72142,E,19.442,5.13,191026,,,A*5D",
+  "$GPRMC,083325.00,A,4844.70074,N,00220.72209,E,16.171,5.62,191026,,,A*5B",
+  "$GPRMC,083326.00,A,4844.70489,N,00220.72255,E,12.874,6.71,191026,,,A*5E",
+  "$GPRMC,083327.00,A,4844.70795,N,00220.72233,E,9.760,3.59,191026,,,A*6E",
+  "$GPRMC,083328.00,A,4844.71025,N,00220.72274,E,6.354,3.99,191026,,,A*6F",
+  "$GPRMC,083329.00,A,4844.71141,N,00220.72237,E,3.327,7.52,191026,,,A*68",
+  "$GPRMC,083330.00,A,4844.71165,N,00220.72293,E,0.090,,191026,,,A*7A",
+  "$GPRMC,083331.00,A,4844.71179,N,00220.72258,E,0.062,,191026,,,A*7C",
+  "$GPRMC,083332.00,A,4844.71200,N,00220.72247,E,0.000,,191026,,,A*78",
+  "$GPRMC,083333.00,A,4844.71215,N,00220.72227,E,0.133,1.87,191026,,,A*6A",
+  "$GPRMC,083334.00,A,4844.71201,N,00220.72283,E,0.000,,191026,,,A*77",
+  "$GPRMC,083335.00,A,4844.71190,N,00220.72244,E,0.072,,191026,,,A*73",
+  "$GPRMC,083336.00,A,4844.71171,N,00220.72197,E,0.118,4.94,191026,,,A*68",
+  "$GPRMC,083337.00,A,4844.71155,N,00220.72210,E,0.055,,191026,,,A*7C",
+};
+#define DRIVE_RMC_COUNT (sizeof(DRIVE_RMC) / sizeof(DRIVE_RMC[0]))
+
+#endif // DRIVE_TRACK_H
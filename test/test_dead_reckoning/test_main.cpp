@@ -0,0 +1,180 @@
+// Dead reckoning: NMEA track replay against holding the last fix
+// A 1 Hz drive (drive_track.h) is parsed the way TinyGPSPlus does and
+// published as GpsSnapshots at the times loop() would. DrErrorTracker must
+// find the prediction closer to each next fix than the previous position,
+// the display frames in between must move at the fix's speed and stop at
+// DR_MAX_HORIZON_MS, and nothing is predicted across the tunnel.
+
+#include <unity.h>
+#include "dead_reckoning.h"
+#include "drive_track.h"
+
+#define RMC_DELAY_MS  60 // Epoch second to RMC parsed (u-blox 6 at 9600 baud)
+#define PUBLISH_MS    40 // RMC parsed to the epoch published on GGA
+
+void setUp() {
+  drErrors.reset();
+  hostSetTimeUs(0);
+}
+
+void tearDown() {}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+static const char *field(const char *s, int n) {
+  while (n-- > 0) {
+    s = strchr(s, ',');
+    if (s == nullptr) return "";
+    s++;
+  }
+  return s;
+}
+
+static bool empty(const char *f) {
+  return *f == ',' || *f == '*' || *f == '\0';
+}
+
+// ddmm.mmmmm as TinyGPSPlus parseDegrees(): minutes in 1e-7 minute units
+static int32_t parseE7(const char *f, const char *hemisphere) {
+  const char *dot = strchr(f, '.');
+  uint32_t whole = strtoul(f, nullptr, 10);
+  uint32_t tenMillionths = (whole % 100) * 10000000UL;
+  uint32_t scale = 1000000UL;
+  for (const char *p = dot + 1; *p >= '0' && *p <= '9'; p++, scale /= 10) tenMillionths += (*p - '0') * scale;
+  return coordE7FromRaw(whole / 100, (5 * (uint64_t)tenMillionths + 1) / 3, *hemisphere == 'S' || *hemisphere == 'W');
+}
+
+static bool checksumOk(const char *s) {
+  uint8_t c = 0;
+  for (s++; *s && *s != '*'; s++) c ^= (uint8_t)*s;
+  return *s == '*' && strtoul(s + 1, nullptr, 16) == c;
+}
+
+// The snapshot loop() publishes for sentence i, with the clock set to then
+static GpsSnapshot publish(size_t i) {
+  const char *rmc = DRIVE_RMC[i];
+  TEST_ASSERT_TRUE(checksumOk(rmc));
+
+  GpsSnapshot s = {};
+  s.epoch = i + 1;
+  s.publishedMs = i * 1000 + RMC_DELAY_MS + PUBLISH_MS;
+  hostSetTimeUs((int64_t)s.publishedMs * 1000);
+  s.locationValid = *field(rmc, 2) == 'A';
+  s.locationAgeMs = s.locationValid ? PUBLISH_MS : ULONG_MAX;
+  if (s.locationValid) {
+    s.latE7 = parseE7(field(rmc, 3), field(rmc, 4));
+    s.lngE7 = parseE7(field(rmc, 5), field(rmc, 6));
+    s.speedValid = !empty(field(rmc, 7));
+    s.speedKmph = atof(field(rmc, 7)) * 1.852;
+    s.courseValid = !empty(field(rmc, 8));
+    s.courseDeg = atof(field(rmc, 8));
+  }
+  return s;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+void test_replay_beats_hold_last_fix() {
+  for (size_t i = 0; i < DRIVE_RMC_COUNT; i++) drErrors.onSnapshot(publish(i));
+
+  char msg[120];
+  snprintf(msg, sizeof(msg), "%lu fixes: DR avg %lu cm (max %lu), hold-last-fix avg %lu cm",
+           (unsigned long)drErrors.count(), (unsigned long)drErrors.avgErrorCm(),
+           (unsigned long)drErrors.maxErrorCm(), (unsigned long)drErrors.avgHoldErrorCm());
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_TRUE(drErrors.count() > DRIVE_RMC_COUNT / 2);
+  TEST_ASSERT_LESS_THAN_UINT32(drErrors.avgHoldErrorCm() / 4, drErrors.avgErrorCm());
+  // Worst case in the turns: well under a car length
+  TEST_ASSERT_LESS_THAN_UINT32(400, drErrors.maxErrorCm());
+}
+
+// Only consecutive fixes moving faster than DR_MIN_SPEED_KMPH with a course
+// are scored: not while parked, not across the tunnel
+void test_scored_fixes_follow_the_gates() {
+  uint32_t expected = 0;
+  GpsSnapshot prev = {};
+  for (size_t i = 0; i < DRIVE_RMC_COUNT; i++) {
+    GpsSnapshot s = publish(i);
+    if (s.locationValid && prev.locationValid && prev.speedValid && prev.courseValid &&
+        prev.speedKmph >= DR_MIN_SPEED_KMPH) {
+      expected++;
+    }
+    drErrors.onSnapshot(s);
+    prev = s;
+  }
+  TEST_ASSERT_EQUAL_UINT32(expected, drErrors.count());
+  TEST_ASSERT_TRUE(expected > 0 && expected < DRIVE_RMC_COUNT - 20);
+}
+
+// Display frames at DR_DISPLAY_RATE_HZ between fixes: flagged, one frame's
+// worth of travel apart, and each new fix snaps the display to it
+void test_display_frames_between_fixes() {
+  const uint32_t frameMs = 1000 / DR_DISPLAY_RATE_HZ;
+  uint32_t frames = 0;
+  uint64_t snapCm = 0, holdCm = 0;
+  GpsSnapshot prev = publish(0);
+  for (size_t i = 1; i < DRIVE_RMC_COUNT; i++) {
+    DrPrediction last = {};
+    bool moving = drPredictNow(prev, &last);
+    for (uint32_t t = frameMs; t < 1000; t += frameMs) {
+      hostSetTimeUs((int64_t)(prev.publishedMs + t) * 1000);
+      DrPrediction p;
+      TEST_ASSERT_EQUAL(moving, drPredictNow(prev, &p));
+      if (!moving) {
+        TEST_ASSERT_FALSE(p.predicted);
+        TEST_ASSERT_EQUAL_INT32(prev.latE7, p.latE7);
+        continue;
+      }
+      TEST_ASSERT_TRUE(p.predicted);
+      TEST_ASSERT_EQUAL_UINT32(PUBLISH_MS + t, p.horizonMs);
+      uint32_t step = coordE7DistanceCm(last.latE7, last.lngE7, p.latE7, p.lngE7);
+      // Both frame ends are truncated to 1e-7 degree: a few cm either way
+      TEST_ASSERT_INT32_WITHIN(5, (int32_t)(prev.speedKmph * frameMs / 36), (int32_t)step);
+      last = p;
+      frames++;
+    }
+
+    GpsSnapshot s = publish(i);
+    if (moving && s.locationValid) {
+      // Jump on screen when the fix arrives, against the 1 Hz jump
+      DrPrediction now;
+      drPredictNow(s, &now);
+      snapCm += coordE7DistanceCm(last.latE7, last.lngE7, now.latE7, now.lngE7);
+      holdCm += coordE7DistanceCm(prev.latE7, prev.lngE7, now.latE7, now.lngE7);
+    }
+    prev = s;
+  }
+  TEST_ASSERT_TRUE(frames > DRIVE_RMC_COUNT);
+  TEST_ASSERT_LESS_THAN_UINT64(holdCm / 4, snapCm);
+}
+
+// A fix that stops coming is extrapolated DR_MAX_HORIZON_MS at most
+void test_horizon_is_capped() {
+  GpsSnapshot s = {};
+  for (size_t i = 0; i < DRIVE_RMC_COUNT && !(s.speedKmph > 60); i++) s = publish(i);
+  TEST_ASSERT_TRUE(s.speedKmph > 60);
+
+  DrPrediction atCap, later;
+  hostSetTimeUs((int64_t)(s.publishedMs + DR_MAX_HORIZON_MS - PUBLISH_MS) * 1000);
+  TEST_ASSERT_TRUE(drPredictNow(s, &atCap));
+  TEST_ASSERT_EQUAL_UINT32(DR_MAX_HORIZON_MS, atCap.horizonMs);
+  hostSetTimeUs((int64_t)(s.publishedMs + 4000) * 1000);
+  TEST_ASSERT_TRUE(drPredictNow(s, &later));
+  TEST_ASSERT_EQUAL_UINT32(DR_MAX_HORIZON_MS, later.horizonMs);
+  TEST_ASSERT_EQUAL_INT32(atCap.latE7, later.latE7);
+  TEST_ASSERT_EQUAL_INT32(atCap.lngE7, later.lngE7);
+
+  uint32_t dist = coordE7DistanceCm(s.latE7, s.lngE7, later.latE7, later.lngE7);
+  TEST_ASSERT_INT32_WITHIN(3, (int32_t)(s.speedKmph * DR_MAX_HORIZON_MS / 36), (int32_t)dist);
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_replay_beats_hold_last_fix);
+  RUN_TEST(test_scored_fixes_follow_the_gates);
+  RUN_TEST(test_display_frames_between_fixes);
+  RUN_TEST(test_horizon_is_capped);
+  return UNITY_END();
+}
@@ -0,0 +1,252 @@
+// Fix latency tracker: NMEA replay against the latency budgets
+// A GT-U7 log is replayed at GPS_BAUD_RATE through a model of the GPS task:
+// it wakes every GPS_RX_WAKE_BYTES bytes and at each pause in the data, drains
+// the UART, validates sentences and closes epochs on GGA + RMC like
+// trackEpoch(). The network and display tasks answer after fixed delays.
+// The budgets are what the tester promises; the UART-side hops depend on the
+// baud rate, GPS_RX_WAKE_BYTES and LATENCY_BURST_GAP_MS, so a change to any
+// of them that makes fixes show up later fails here.
+
+#include <unity.h>
+#include "fix_latency.h"
+
+// ============================================================================
+// REPLAY MODEL
+// ============================================================================
+#define BYTE_US             (10000000LL / GPS_BAUD_RATE) // 8N1
+#define RX_TIMEOUT_US       (2 * BYTE_US)   // UART RX timeout: 2 character times
+#define TASK_WAKE_US        100LL           // Notification to running GPS task
+#define RECEIVER_DELAY_US   40000LL         // PPS edge to first NMEA byte (u-blox 6)
+#define WS_QUEUE_DELAY_US   3000LL          // Publication to WebSocket frame queued (ws_broadcast is triggered)
+#define TFT_FLUSH_DELAY_US  45000LL         // Publication to TFT frame flushed
+
+// Budgets per hop (us)
+#define BUDGET_PPS_UART_US      100000
+#define BUDGET_UART_VALID_US    250000
+#define BUDGET_VALID_PUBLISH_US 1000
+#define BUDGET_PUBLISH_WS_US    20000
+#define BUDGET_PUBLISH_TFT_US   60000
+#define BUDGET_UART_WS_US       300000
+#define BUDGET_UART_TFT_US      300000
+
+// One burst per epoch of GT-U7 output (u-blox 6, default sentence set)
+static const char *const NMEA_LOG[] = {
+  "$GPRMC,083010.00,A,4843.66658,N,00220.98734,E,0.021,,191026,,,A*75\r\n"
+  "$GPVTG,,T,,M,0.021,N,0.039,K,A*2A\r\n"
+  "$GPGGA,083010.00,4843.66658,N,00220.98734,E,1,08,1.01,64.3,M,46.2,M,,*6E\r\n"
+  "$GPGSA,A,3,05,13,15,18,20,23,24,29,,,,,1.87,1.01,1.57*0B\r\n"
+  "$GPGSV,3,1,11,05,61,226,42,13,31,160,38,15,50,063,45,18,24,286,36*76\r\n"
+  "$GPGSV,3,2,11,20,14,120,31,23,08,321,,24,57,101,44,29,46,296,40*73\r\n"
+  "$GPGSV,3,3,11,10,03,040,,26,02,202,,36,29,146,35*42\r\n"
+  "$GPGLL,4843.66658,N,00220.98734,E,083010.00,A,A*62\r\n",
+
+  "$GPRMC,083011.00,A,4843.66658,N,00220.98734,E,0.021,,191026,,,A*74\r\n"
+  "$GPVTG,,T,,M,0.021,N,0.039,K,A*2A\r\n"
+  "$GPGGA,083011.00,4843.66658,N,00220.98734,E,1,08,1.01,64.3,M,46.2,M,,*6F\r\n"
+  "$GPGSA,A,3,05,13,15,18,20,23,24,29,,,,,1.87,1.01,1.57*0B\r\n"
+  "$GPGSV,3,1,11,05,61,226,42,13,31,160,38,15,50,063,45,18,24,286,36*76\r\n"
+  "$GPGSV,3,2,11,20,14,120,31,23,08,321,,24,57,101,44,29,46,296,40*73\r\n"
+  "$GPGSV,3,3,11,10,03,040,,26,02,202,,36,29,146,35*42\r\n"
+  "$GPGLL,4843.66658,N,00220.98734,E,083011.00,A,A*63\r\n",
+
+  "$GPRMC,083012.00,A,4843.66658,N,00220.98734,E,0.021,,191026,,,A*77\r\n"
+  "$GPVTG,,T,,M,0.021,N,0.039,K,A*2A\r\n"
+  "$GPGGA,083012.00,4843.66658,N,00220.98734,E,1,08,1.01,64.3,M,46.2,M,,*6C\r\n"
+  "$GPGSA,A,3,05,13,15,18,20,23,24,29,,,,,1.87,1.01,1.57*0B\r\n"
+  "$GPGSV,3,1,11,05,61,226,42,13,31,160,38,15,50,063,45,18,24,286,36*76\r\n"
+  "$GPGSV,3,2,11,20,14,120,31,23,08,321,,24,57,101,44,29,46,296,40*73\r\n"
+  "$GPGSV,3,3,11,10,03,040,,26,02,202,,36,29,146,35*42\r\n"
+  "$GPGLL,4843.66658,N,00220.98734,E,083012.00,A,A*60\r\n",
+
+  "$GPRMC,083013.00,A,4843.66658,N,00220.98734,E,0.021,,191026,,,A*76\r\n"
+  "$GPVTG,,T,,M,0.021,N,0.039,K,A*2A\r\n"
+  "$GPGGA,083013.00,4843.66658,N,00220.98734,E,1,08,1.01,64.3,M,46.2,M,,*6D\r\n"
+  "$GPGSA,A,3,05,13,15,18,20,23,24,29,,,,,1.87,1.01,1.57*0B\r\n"
+  "$GPGSV,3,1,11,05,61,226,42,13,31,160,38,15,50,063,45,18,24,286,36*76\r\n"
+  "$GPGSV,3,2,11,20,14,120,31,23,08,321,,24,57,101,44,29,46,296,40*73\r\n"
+  "$GPGSV,3,3,11,10,03,040,,26,02,202,,36,29,146,35*42\r\n"
+  "$GPGLL,4843.66658,N,00220.98734,E,083013.00,A,A*61\r\n",
+
+  "$GPRMC,083014.00,A,4843.66658,N,00220.98734,E,0.021,,191026,,,A*71\r\n"
+  "$GPVTG,,T,,M,0.021,N,0.039,K,A*2A\r\n"
+  "$GPGGA,083014.00,4843.66658,N,00220.98734,E,1,08,1.01,64.3,M,46.2,M,,*6A\r\n"
+  "$GPGSA,A,3,05,13,15,18,20,23,24,29,,,,,1.87,1.01,1.57*0B\r\n"
+  "$GPGSV,3,1,11,05,61,226,42,13,31,160,38,15,50,063,45,18,24,286,36*76\r\n"
+  "$GPGSV,3,2,11,20,14,120,31,23,08,321,,24,57,101,44,29,46,296,40*73\r\n"
+  "$GPGSV,3,3,11,10,03,040,,26,02,202,,36,29,146,35*42\r\n"
+  "$GPGLL,4843.66658,N,00220.98734,E,083014.00,A,A*66\r\n",
+};
+#define EPOCH_COUNT (sizeof(NMEA_LOG) / sizeof(NMEA_LOG[0]))
+
+// The parts of updateGPS()/trackEpoch() the tracker sees
+struct GpsTaskModel {
+  char line[NMEA_MAX_SENTENCE];
+  size_t lineLen = 0;
+  bool hasGga = false;
+  bool hasRmc = false;
+  uint32_t epoch = 0;
+  uint32_t published = 0; // Epoch published by the last drain (0 = none)
+
+  // NMEA checksum of a "$...*hh" line
+  static bool valid(const char *s, size_t len) {
+    if (len < 4 || s[0] != '$' || s[len - 3] != '*') return false;
+    uint8_t sum = 0;
+    for (size_t i = 1; i < len - 3; i++) sum ^= (uint8_t)s[i];
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02X", sum);
+    return s[len - 2] == hex[0] && s[len - 1] == hex[1];
+  }
+
+  void onSentence(int64_t nowUs, int64_t ppsUs) {
+    fixLatency.onSentenceValid(nowUs);
+    bool gga = strncmp(line + 3, "GGA", 3) == 0;
+    bool rmc = strncmp(line + 3, "RMC", 3) == 0;
+    hasGga |= gga;
+    hasRmc |= rmc;
+    if (hasGga && hasRmc) {
+      fixLatency.onPublished(++epoch, nowUs, ppsUs);
+      published = epoch;
+      hasGga = hasRmc = false;
+    }
+  }
+
+  void drain(const char *bytes, size_t count, int64_t nowUs, int64_t ppsUs) {
+    if (count > 0) fixLatency.onUartData(nowUs);
+    for (size_t i = 0; i < count; i++) {
+      char c = bytes[i];
+      if (c == '$') lineLen = 0;
+      if (c == '\n') {
+        if (valid(line, lineLen)) onSentence(nowUs, ppsUs);
+        lineLen = 0;
+      } else if (c != '\r' && lineLen < sizeof(line)) {
+        line[lineLen++] = c;
+      }
+    }
+  }
+};
+
+static GpsTaskModel gpsTask;
+
+// Sends one burst starting at startUs. The GPS task drains the UART when the
+// RX FIFO threshold or the RX timeout wakes it. Each epoch published during
+// the burst gets its WebSocket and TFT stamps unless skipTft.
+static void replayBurst(const char *burst, int64_t startUs, int64_t ppsUs, bool skipTft = false) {
+  size_t len = strlen(burst);
+  size_t drained = 0;
+  for (size_t i = 1; i <= len; i++) {
+    bool fifoFull = i - drained >= GPS_RX_WAKE_BYTES;
+    bool pause = i == len;
+    if (!fifoFull && !pause) continue;
+
+    int64_t lastByteUs = startUs + (int64_t)i * BYTE_US;
+    int64_t wakeUs = lastByteUs + (pause ? RX_TIMEOUT_US : 0) + TASK_WAKE_US;
+    // Bytes that kept coming while the task woke up are drained too
+    size_t available = min(len, i + (size_t)((wakeUs - lastByteUs) / BYTE_US));
+    hostSetTimeUs(wakeUs);
+    gpsTask.published = 0;
+    gpsTask.drain(burst + drained, available - drained, wakeUs, ppsUs);
+    drained = available;
+    i = available;
+
+    if (gpsTask.published != 0) {
+      fixLatency.onWsQueued(gpsTask.published, wakeUs + WS_QUEUE_DELAY_US);
+      if (!skipTft) fixLatency.onTftFlushed(gpsTask.published, wakeUs + TFT_FLUSH_DELAY_US);
+    }
+  }
+}
+
+void setUp() {
+  fixLatency = FixLatencyTracker();
+  gpsTask = GpsTaskModel();
+  hostSetTimeUs(0);
+}
+
+void tearDown() {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+static void assertHop(LatencyHop hop, uint32_t count, uint32_t budgetUs) {
+  const LatencyHistogram &h = fixLatency.hop(hop);
+  char msg[64];
+  snprintf(msg, sizeof(msg), "%s: max %lu us", LATENCY_HOP_NAMES[hop], (unsigned long)h.maxUs());
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(count, h.count(), msg);
+  TEST_ASSERT_TRUE_MESSAGE(h.maxUs() <= budgetUs, msg);
+}
+
+void test_replay_within_budgets() {
+  for (size_t k = 0; k < EPOCH_COUNT; k++) {
+    int64_t ppsUs = 1000000LL * (k + 1);
+    replayBurst(NMEA_LOG[k], ppsUs + RECEIVER_DELAY_US, ppsUs);
+  }
+
+  assertHop(HOP_PPS_UART, EPOCH_COUNT, BUDGET_PPS_UART_US);
+  assertHop(HOP_UART_VALID, EPOCH_COUNT, BUDGET_UART_VALID_US);
+  assertHop(HOP_VALID_PUBLISH, EPOCH_COUNT, BUDGET_VALID_PUBLISH_US);
+  assertHop(HOP_PUBLISH_WS, EPOCH_COUNT, BUDGET_PUBLISH_WS_US);
+  assertHop(HOP_PUBLISH_TFT, EPOCH_COUNT, BUDGET_PUBLISH_TFT_US);
+  assertHop(HOP_UART_WS, EPOCH_COUNT, BUDGET_UART_WS_US);
+  assertHop(HOP_UART_TFT, EPOCH_COUNT, BUDGET_UART_TFT_US);
+}
+
+void test_epoch_stamps() {
+  int64_t ppsUs = 1000000;
+  int64_t startUs = ppsUs + RECEIVER_DELAY_US;
+  replayBurst(NMEA_LOG[0], startUs, ppsUs);
+
+  // The burst starts at the first drain, GPS_RX_WAKE_BYTES into the data
+  const EpochTiming &e = fixLatency.lastEpoch();
+  TEST_ASSERT_EQUAL_UINT32(1, e.epoch);
+  TEST_ASSERT_EQUAL_INT64(ppsUs, e.ppsUs);
+  TEST_ASSERT_EQUAL_INT64(startUs + GPS_RX_WAKE_BYTES * BYTE_US + TASK_WAKE_US, e.firstByteUs);
+  TEST_ASSERT_EQUAL_INT64(e.validatedUs, e.publishedUs);
+  TEST_ASSERT_EQUAL_INT64(e.publishedUs + WS_QUEUE_DELAY_US, e.wsQueuedUs);
+  TEST_ASSERT_EQUAL_INT64(e.publishedUs + TFT_FLUSH_DELAY_US, e.tftFlushedUs);
+}
+
+// Data closer together than LATENCY_BURST_GAP_MS belongs to the same burst
+void test_burst_gap() {
+  fixLatency.onUartData(1000000);
+  fixLatency.onUartData(1000000 + (LATENCY_BURST_GAP_MS - 1) * 1000LL);
+  fixLatency.onSentenceValid(1100000);
+  fixLatency.onPublished(1, 1100000, 0);
+
+  fixLatency.onUartData(1100000 + LATENCY_BURST_GAP_MS * 1000LL);
+  fixLatency.onPublished(2, 1200000, 0);
+  // Epoch 1 was retired by epoch 2, with the first burst start
+  TEST_ASSERT_EQUAL_UINT32(1, fixLatency.lastEpoch().epoch);
+  TEST_ASSERT_EQUAL_INT64(1000000, fixLatency.lastEpoch().firstByteUs);
+  TEST_ASSERT_EQUAL_UINT32(100000, fixLatency.hop(HOP_UART_VALID).maxUs());
+}
+
+// A PPS edge a second or more before the burst belongs to another epoch
+void test_stale_pps_ignored() {
+  int64_t ppsUs = 1000000;
+  replayBurst(NMEA_LOG[0], ppsUs + 1000000 + RECEIVER_DELAY_US, ppsUs);
+  TEST_ASSERT_EQUAL_UINT32(0, fixLatency.hop(HOP_PPS_UART).count());
+  TEST_ASSERT_EQUAL_INT64(0, fixLatency.lastEpoch().ppsUs);
+  TEST_ASSERT_EQUAL_UINT32(1, fixLatency.hop(HOP_UART_VALID).count());
+}
+
+// An epoch the display never showed is retired without the TFT hops, and a
+// late flush stamp for it is ignored
+void test_superseded_epoch() {
+  replayBurst(NMEA_LOG[0], 1000000 + RECEIVER_DELAY_US, 1000000, true);
+  replayBurst(NMEA_LOG[1], 2000000 + RECEIVER_DELAY_US, 2000000);
+  fixLatency.onTftFlushed(1, 2500000);
+
+  TEST_ASSERT_EQUAL_UINT32(2, fixLatency.hop(HOP_PUBLISH_WS).count());
+  TEST_ASSERT_EQUAL_UINT32(1, fixLatency.hop(HOP_PUBLISH_TFT).count());
+  TEST_ASSERT_EQUAL_UINT32(1, fixLatency.hop(HOP_UART_TFT).count());
+  TEST_ASSERT_EQUAL_UINT32(2, fixLatency.lastEpoch().epoch);
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_replay_within_budgets);
+  RUN_TEST(test_epoch_stamps);
+  RUN_TEST(test_burst_gap);
+  RUN_TEST(test_stale_pps_ignored);
+  RUN_TEST(test_superseded_epoch);
+  return UNITY_END();
+}
@@ -0,0 +1,256 @@
+// Number formatting: rounding, truncation and a host benchmark
+// fmtScaled() rounds once, half away from zero, then the tables may cut the
+// digits (TFT coordinates) without rounding again. Output is checked against
+// known strings and against snprintf("%.6f") over a sweep of coordinates;
+// the benchmark times the same coordinate through fmtScaled, snprintf and
+// String(x, 6), the three ways the pages and JSON used to format it.
+
+#include <unity.h>
+#include <Arduino.h>
+#include <chrono>
+#include <random>
+#include "num_format.h"
+
+void setUp() {}
+void tearDown() {}
+
+#define ASSERT_FMT(expected, len, buf)                 \
+  do {                                                 \
+    TEST_ASSERT_EQUAL_STRING(expected, buf);           \
+    TEST_ASSERT_EQUAL_UINT32(strlen(expected), len);   \
+  } while (0)
+
+// ============================================================================
+// ROUNDING
+// ============================================================================
+void test_scaled_rounds_half_away_from_zero() {
+  char buf[32];
+  size_t n;
+  // 1e-7 degrees to 6 decimals
+  n = fmtScaled(buf, sizeof(buf), 487277775, 7, FMT_JSON_COORD);
+  ASSERT_FMT("48.727778", n, buf);
+  n = fmtScaled(buf, sizeof(buf), 487277774, 7, FMT_JSON_COORD);
+  ASSERT_FMT("48.727777", n, buf);
+  n = fmtScaled(buf, sizeof(buf), -23479785, 7, FMT_JSON_COORD);
+  ASSERT_FMT("-2.347979", n, buf);
+  n = fmtScaled(buf, sizeof(buf), -23479784, 7, FMT_JSON_COORD);
+  ASSERT_FMT("-2.347978", n, buf);
+  // Carry through every digit
+  n = fmtScaled(buf, sizeof(buf), 99999995, 7, FMT_JSON_COORD);
+  ASSERT_FMT("10.000000", n, buf);
+  n = fmtScaled(buf, sizeof(buf), 1795, 3, FMT_TFT_SPEED);
+  ASSERT_FMT("1.8km/h", n, buf);
+}
+
+void test_scaled_has_no_negative_zero() {
+  char buf[32];
+  size_t n = fmtScaled(buf, sizeof(buf), -4, 7, FMT_JSON_COORD);
+  ASSERT_FMT("0.000000", n, buf);
+  n = fmtScaled(buf, sizeof(buf), -5, 7, FMT_JSON_COORD);
+  ASSERT_FMT("-0.000001", n, buf);
+  n = fmtScaled(buf, sizeof(buf), -49, 3, FMT_TFT_ALT);
+  ASSERT_FMT("0.0m", n, buf);
+}
+
+void test_scaled_adds_decimals() {
+  char buf[32];
+  size_t n = fmtScaled(buf, sizeof(buf), 5, 0, FMT_HDOP);
+  ASSERT_FMT("5.00", n, buf);
+  n = fmtScaled(buf, sizeof(buf), -123, 1, FMT_WIRE_COORD);
+  ASSERT_FMT("-12.3000000", n, buf);
+}
+
+void test_scaled_full_int64_range() {
+  char buf[32];
+  size_t n = fmtScaled(buf, sizeof(buf), INT64_MIN, 7, FMT_WIRE_COORD);
+  ASSERT_FMT("-922337203685.4775808", n, buf);
+  n = fmtScaled(buf, sizeof(buf), INT64_MAX, 7, FMT_WIRE_COORD);
+  ASSERT_FMT("922337203685.4775807", n, buf);
+}
+
+// ============================================================================
+// TRUNCATION
+// ============================================================================
+void test_tft_coord_is_cut_not_rounded() {
+  char buf[32];
+  // 48.727778 -> 7 characters, the 8 is dropped, not rounded into the 7
+  size_t n = fmtScaled(buf, sizeof(buf), 487277775, 7, FMT_TFT_COORD);
+  ASSERT_FMT("48.7277", n, buf);
+  n = fmtScaled(buf, sizeof(buf), -1234567890, 7, FMT_TFT_COORD);
+  ASSERT_FMT("-123.45", n, buf);
+  n = fmtScaled(buf, sizeof(buf), 23479789, 7, FMT_TFT_COORD);
+  ASSERT_FMT("2.34797", n, buf);
+}
+
+void test_unit_survives_digit_truncation() {
+  static constexpr NumFormat CUT = {3, "m", 4};
+  char buf[32];
+  size_t n = fmtScaled(buf, sizeof(buf), 123456, 3, CUT);
+  ASSERT_FMT("123.m", n, buf);
+}
+
+void test_small_buffer_is_never_overrun() {
+  char buf[16];
+  memset(buf, 'x', sizeof(buf));
+  size_t n = fmtScaled(buf, 5, 1234567, 4, FMT_TFT_ALT);
+  ASSERT_FMT("123.", n, buf);
+  TEST_ASSERT_EQUAL_INT('x', buf[5]);
+
+  memset(buf, 'x', sizeof(buf));
+  n = fmtScaled(buf, 6, 844, 1, FMT_COURSE);
+  ASSERT_FMT("84.4\xC2", n, buf); // Cut inside the unit, still terminated
+  TEST_ASSERT_EQUAL_INT('x', buf[6]);
+
+  n = fmtScaled(buf, 1, 844, 1, FMT_COURSE);
+  ASSERT_FMT("", n, buf);
+
+  buf[0] = 'x';
+  n = fmtUint(buf, 0, 42);
+  TEST_ASSERT_EQUAL_UINT32(0, n);
+  TEST_ASSERT_EQUAL_INT('x', buf[0]);
+}
+
+// ============================================================================
+// FLOAT / VALIDITY
+// ============================================================================
+void test_float_formats() {
+  char buf[32];
+  size_t n = fmtFloat(buf, sizeof(buf), 64.34, FMT_JSON_ALT);
+  ASSERT_FMT("64.3 m", n, buf);
+  n = fmtFloat(buf, sizeof(buf), 84.36, FMT_COURSE);
+  ASSERT_FMT("84.4\xC2\xB0", n, buf);
+  n = fmtFloat(buf, sizeof(buf), 0.9, FMT_HDOP);
+  ASSERT_FMT("0.90", n, buf);
+  n = fmtFloat(buf, sizeof(buf), -0.01, FMT_TFT_SPEED);
+  ASSERT_FMT("0.0km/h", n, buf);
+  n = fmtFloat(buf, sizeof(buf), NAN, FMT_TFT_ALT);
+  ASSERT_FMT(FMT_MISSING, n, buf);
+  n = fmtFloat(buf, sizeof(buf), INFINITY, FMT_TFT_ALT);
+  ASSERT_FMT(FMT_MISSING, n, buf);
+  n = fmtFloat(buf, sizeof(buf), 1e300, FMT_TFT_ALT);
+  ASSERT_FMT(FMT_MISSING, n, buf);
+  n = fmtFloatIf(false, buf, sizeof(buf), 12.0, FMT_TFT_ALT);
+  ASSERT_FMT(FMT_MISSING, n, buf);
+  n = fmtScaledIf(false, buf, sizeof(buf), 12, 0, FMT_TFT_ALT);
+  ASSERT_FMT(FMT_MISSING, n, buf);
+  n = fmtScaledIf(true, buf, sizeof(buf), 12, 0, FMT_TFT_ALT);
+  ASSERT_FMT("12.0m", n, buf);
+}
+
+// Same digits as printf away from exact ties (where printf rounds the binary
+// value and fmtFloat rounds half away from zero)
+void test_float_matches_snprintf_on_coordinates() {
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int32_t> micro(-180000000, 180000000);
+  char ours[32], ref[32];
+  for (int i = 0; i < 100000; i++) {
+    double x = (micro(rng) + (i & 1 ? 0.3 : 0.7)) / 1e6;
+    fmtFloat(ours, sizeof(ours), x, FMT_JSON_COORD);
+    snprintf(ref, sizeof(ref), "%.6f", x);
+    if (strcmp(ref, "-0.000000") == 0) strcpy(ref, "0.000000");
+    TEST_ASSERT_EQUAL_STRING(ref, ours);
+  }
+}
+
+// ============================================================================
+// INTEGERS / TIME
+// ============================================================================
+void test_uint_clock_date() {
+  char buf[32];
+  size_t n = fmtUint(buf, sizeof(buf), 0);
+  ASSERT_FMT("0", n, buf);
+  n = fmtUint(buf, sizeof(buf), UINT32_MAX);
+  ASSERT_FMT("4294967295", n, buf);
+  n = fmtClock(buf, sizeof(buf), 8, 5, 9);
+  ASSERT_FMT("08:05:09", n, buf);
+  n = fmtDate(buf, sizeof(buf), 1, 2, 2024);
+  ASSERT_FMT("01/02/2024", n, buf);
+  n = fmtDate(buf, sizeof(buf), 31, 12, 0);
+  ASSERT_FMT("31/12/0000", n, buf);
+}
+
+void test_duration_and_age() {
+  char buf[32];
+  size_t n = fmtDuration(buf, sizeof(buf), 3723, FMT_DURATION_COMPACT);
+  ASSERT_FMT("1h2m3s", n, buf);
+  n = fmtDuration(buf, sizeof(buf), 3723, FMT_DURATION_SPACED);
+  ASSERT_FMT("1h 2m 3s", n, buf);
+  n = fmtDuration(buf, sizeof(buf), 3723, FMT_DURATION_MIN_SEC);
+  ASSERT_FMT("62m 3s", n, buf);
+  n = fmtDuration(buf, sizeof(buf), 0, FMT_DURATION_COMPACT);
+  ASSERT_FMT("0h0m0s", n, buf);
+  // %luh%lum%lus as the uptime used to be printed
+  char ref[32];
+  uint32_t up = 4000000000u;
+  snprintf(ref, sizeof(ref), "%luh%lum%lus", (unsigned long)(up / 3600), (unsigned long)(up / 60 % 60),
+           (unsigned long)(up % 60));
+  fmtDuration(buf, sizeof(buf), up, FMT_DURATION_COMPACT);
+  TEST_ASSERT_EQUAL_STRING(ref, buf);
+
+  n = fmtAge(buf, sizeof(buf), 999, FMT_TFT_AGE);
+  ASSERT_FMT("999ms", n, buf);
+  n = fmtAge(buf, sizeof(buf), 1999, FMT_TFT_AGE);
+  ASSERT_FMT("1s", n, buf);
+  n = fmtAge(buf, sizeof(buf), 0, FMT_JSON_AGE);
+  ASSERT_FMT("0 ms", n, buf);
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+#define BENCH_ITERATIONS 200000
+
+static volatile size_t benchSink;
+
+template <typename F>
+static double nsPerCall(F f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCH_ITERATIONS; i++) f(i);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / BENCH_ITERATIONS;
+}
+
+// A latitude as the JSON prints it: fixed point vs printf vs Arduino String.
+// Timings are for the host only; they are reported, not asserted.
+void test_benchmark_coordinate() {
+  const int32_t baseE7 = 487277777;
+  char buf[32];
+
+  double fixedNs = nsPerCall([&](int i) {
+    benchSink = fmtScaled(buf, sizeof(buf), baseE7 + i, 7, FMT_JSON_COORD);
+  });
+  double printfNs = nsPerCall([&](int i) {
+    benchSink = snprintf(buf, sizeof(buf), "%.6f", (baseE7 + i) / 1e7);
+  });
+  double stringNs = nsPerCall([&](int i) {
+    String s((baseE7 + i) / 1e7, 6);
+    benchSink = s.length();
+  });
+
+  // Same text from all three
+  fmtScaled(buf, sizeof(buf), baseE7 + 12345, 7, FMT_JSON_COORD);
+  String s((baseE7 + 12345) / 1e7, 6);
+  TEST_ASSERT_EQUAL_STRING(s.c_str(), buf);
+
+  char msg[120];
+  snprintf(msg, sizeof(msg), "fmtScaled %.1f ns, snprintf %.1f ns, String(x, 6) %.1f ns per coordinate",
+           fixedNs, printfNs, stringNs);
+  TEST_MESSAGE(msg);
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_scaled_rounds_half_away_from_zero);
+  RUN_TEST(test_scaled_has_no_negative_zero);
+  RUN_TEST(test_scaled_adds_decimals);
+  RUN_TEST(test_scaled_full_int64_range);
+  RUN_TEST(test_tft_coord_is_cut_not_rounded);
+  RUN_TEST(test_unit_survives_digit_truncation);
+  RUN_TEST(test_small_buffer_is_never_overrun);
+  RUN_TEST(test_float_formats);
+  RUN_TEST(test_float_matches_snprintf_on_coordinates);
+  RUN_TEST(test_uint_clock_date);
+  RUN_TEST(test_duration_and_age);
+  RUN_TEST(test_benchmark_coordinate);
+  return UNITY_END();
+}
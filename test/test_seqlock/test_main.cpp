@@ -0,0 +1,185 @@
+// SeqLock: the task handoffs under concurrent readers
+// Host threads stand in for the tasks: a GPS writer publishes GpsStatus as
+// fast as it can while readers copy it, and a network thread hands the epoch
+// on through netStatus/wsQueuedStamp like broadcastWs() does. Every field
+// written is derived from one counter, so a torn copy shows up as a field
+// that disagrees with the others. Run under ThreadSanitizer with
+// pio test -e native_tsan, which also reports any access outside the atomics.
+
+#include <unity.h>
+#include <vector>
+#include "app_tasks.h"
+
+#define WRITES  100000
+#define READERS 3
+
+static SeqLock<GpsStatus> status;
+static SeqLock<NetStatus> net;
+static SeqLock<WsQueuedStamp> stamp;
+
+void setUp() {}
+void tearDown() {}
+
+// ============================================================================
+// STAMPED VALUES
+// ============================================================================
+static GpsStatus stampStatus(uint32_t n) {
+  GpsStatus s = {};
+  s.fix.epoch = n;
+  s.fix.publishedMs = n * 1000UL;
+  s.fix.locationValid = n & 1;
+  s.fix.latE7 = (int32_t)(n * 7919u);
+  s.fix.lngE7 = -(int32_t)n;
+  s.fix.altitudeM = n * 0.5;
+  s.fix.satellites = n % 32;
+  s.validSentences = n * 3;
+  s.failedChecksums = n;
+  s.totalSentences = n * 4;
+  s.charsProcessed = n * 300;
+  s.satellitesInView = n % 32;
+  s.drChecks = n;
+  s.drErrorSumCm = ((uint64_t)n << 33) | n;
+  s.drHoldSumCm = ~s.drErrorSumCm;
+  s.ttffMs = n ^ 0xA5A5A5A5u;
+  return s;
+}
+
+static bool consistent(const GpsStatus &s) {
+  GpsStatus expected = stampStatus(s.fix.epoch);
+  return memcmp(&expected, &s, sizeof(s)) == 0;
+}
+
+static NetStatus stampNet(uint32_t n) {
+  NetStatus s = {};
+  s.wifiConnected = n % 5 != 0;
+  if (s.wifiConnected) {
+    snprintf(s.ip, sizeof(s.ip), "10.%u.%u.%u", (unsigned)(n >> 16) & 255, (unsigned)(n >> 8) & 255, (unsigned)n & 255);
+  } else {
+    strcpy(s.ip, "Connecting...");
+  }
+  return s;
+}
+
+static bool consistent(const NetStatus &s) {
+  if (!s.wifiConnected) return strcmp(s.ip, "Connecting...") == 0;
+  unsigned a, b, c;
+  if (sscanf(s.ip, "10.%u.%u.%u", &a, &b, &c) != 3) return false;
+  NetStatus expected = stampNet((a << 16) | (b << 8) | c);
+  return memcmp(&expected, &s, sizeof(s)) == 0;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+void test_sequence_counts_writes() {
+  SeqLock<WsQueuedStamp> lock;
+  WsQueuedStamp out = {1, 1};
+  TEST_ASSERT_EQUAL_UINT32(0, lock.sequence());
+  TEST_ASSERT_EQUAL_UINT32(0, lock.read(&out));
+  TEST_ASSERT_EQUAL_UINT32(0, out.epoch); // Zero-initialised before the first write
+
+  for (uint32_t n = 1; n <= 10; n++) {
+    lock.write({n, (int64_t)n * 1000000});
+    TEST_ASSERT_EQUAL_UINT32(2 * n, lock.sequence());
+    TEST_ASSERT_EQUAL_UINT32(2 * n, lock.read(&out));
+    TEST_ASSERT_EQUAL_UINT32(n, out.epoch);
+    TEST_ASSERT_EQUAL_INT64((int64_t)n * 1000000, out.queuedUs);
+  }
+}
+
+// GPS task writing every epoch back to back, readers copying in a loop:
+// every copy is one whole write, and neither sequence nor epoch goes back
+void test_readers_never_see_torn_status() {
+  status.write(stampStatus(0));
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> torn{0}, backwards{0}, reads{0}, changes{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < READERS; r++) {
+    readers.emplace_back([&] {
+      uint32_t lastSeq = 0, lastEpoch = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        GpsStatus s;
+        uint32_t seq = status.read(&s);
+        if ((seq & 1) || !consistent(s)) torn++;
+        if (seq < lastSeq || s.fix.epoch < lastEpoch) backwards++;
+        if (seq != lastSeq) changes++;
+        lastSeq = seq;
+        lastEpoch = s.fix.epoch;
+        reads++;
+      }
+    });
+  }
+
+  for (uint32_t n = 1; n <= WRITES; n++) {
+    status.write(stampStatus(n));
+    if (n % 1000 == 0) std::this_thread::yield();
+  }
+  done = true;
+  for (std::thread &t : readers) t.join();
+
+  GpsStatus last;
+  TEST_ASSERT_EQUAL_UINT32(2 * (WRITES + 1), status.read(&last));
+  TEST_ASSERT_EQUAL_UINT32(WRITES, last.fix.epoch);
+  TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+  TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+  TEST_ASSERT_TRUE(reads.load() > 0);
+  TEST_ASSERT_TRUE(changes.load() > READERS); // The readers ran alongside the writer
+
+  char msg[80];
+  snprintf(msg, sizeof(msg), "%lu reads, %lu sequence changes seen", (unsigned long)reads.load(),
+           (unsigned long)changes.load());
+  TEST_MESSAGE(msg);
+}
+
+// gps -> network -> AsyncTCP: the network task stamps the epoch it read from
+// status into stamp and updates net; a callback that sees a stamp must then
+// see that epoch (or a later one) in status
+void test_handoff_between_tasks() {
+  status.write(stampStatus(0));
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> errors{0}, checks{0};
+
+  std::thread network([&] {
+    uint32_t n = 0;
+    while (!done.load(std::memory_order_relaxed)) {
+      GpsStatus s;
+      status.read(&s);
+      if (!consistent(s)) errors++;
+      stamp.write({s.fix.epoch, (int64_t)s.fix.epoch * 1000});
+      net.write(stampNet(++n));
+    }
+  });
+  std::thread callback([&] {
+    while (!done.load(std::memory_order_relaxed)) {
+      WsQueuedStamp ws;
+      NetStatus ns;
+      GpsStatus s;
+      stamp.read(&ws);
+      net.read(&ns);
+      status.read(&s);
+      if (ws.queuedUs != (int64_t)ws.epoch * 1000 || !consistent(ns) || !consistent(s)) errors++;
+      if (s.fix.epoch < ws.epoch) errors++;
+      checks++;
+    }
+  });
+
+  for (uint32_t n = 1; n <= WRITES; n++) {
+    status.write(stampStatus(n));
+    if (n % 1000 == 0) std::this_thread::yield();
+  }
+  done = true;
+  network.join();
+  callback.join();
+
+  TEST_ASSERT_EQUAL_UINT32(0, errors.load());
+  TEST_ASSERT_TRUE(checks.load() > 0);
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_sequence_counts_writes);
+  RUN_TEST(test_readers_never_see_torn_status);
+  RUN_TEST(test_handoff_between_tasks);
+  return UNITY_END();
+}
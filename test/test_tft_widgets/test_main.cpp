@@ -0,0 +1,243 @@
+// TFT widgets: pixels pushed per frame through a mock Adafruit_GFX
+// The mock (test/host/Adafruit_GFX.h) counts every pixel written, which is
+// the SPI traffic on the panel. After any sequence of updates the screen must
+// match a fresh draw of the final values, while unchanged widgets push
+// nothing and changed ones push only their own bounds.
+
+#include <unity.h>
+#include "config.h"
+#include "tft_widgets.h"
+
+// GPS data page layout (main.cpp)
+#define HEADER_HEIGHT 60
+#define CONTENT_Y     (HEADER_HEIGHT + 1 + 20 + 10)
+#define LINE_HEIGHT   20
+#define CONTENT_AREA  (TFT_WIDTH * (TFT_HEIGHT - HEADER_HEIGHT - 1)) // What a page clear used to push
+
+static Adafruit_GFX *gfx;
+
+static Adafruit_GFX *freshScreen() {
+  Adafruit_GFX *screen = new Adafruit_GFX(TFT_WIDTH, TFT_HEIGHT);
+  screen->fillScreen(TFT_COLOR_BG);
+  screen->resetCount();
+  invalidateWidgets();
+  return screen;
+}
+
+void setUp() {
+  gfx = freshScreen();
+  widgetStats = {};
+}
+
+void tearDown() {
+  delete gfx;
+}
+
+// ============================================================================
+// TEXT
+// ============================================================================
+void test_text_first_draw_pushes_its_cells() {
+  TextWidget w(10, 10, 2, TFT_COLOR_BG);
+  w.set("12.5", TFT_COLOR_VALUE);
+  TEST_ASSERT_TRUE(w.draw(*gfx));
+  TEST_ASSERT_EQUAL_UINT32(4 * 12 * 16, gfx->pixelsPushed());
+  TEST_ASSERT_EQUAL_UINT32(gfx->pixelsPushed(), widgetStats.pixels);
+}
+
+void test_text_unchanged_pushes_nothing() {
+  TextWidget w(10, 10, 2, TFT_COLOR_BG);
+  w.set("12.5", TFT_COLOR_VALUE);
+  w.draw(*gfx);
+  gfx->resetCount();
+
+  w.set("12.5", TFT_COLOR_VALUE);
+  TEST_ASSERT_FALSE(w.draw(*gfx));
+  TEST_ASSERT_EQUAL_UINT32(0, gfx->pixelsPushed());
+}
+
+void test_text_shorter_clears_only_the_leftover() {
+  TextWidget w(200, 10, 2, TFT_COLOR_BG, ALIGN_RIGHT);
+  w.set("1234.5", TFT_COLOR_VALUE);
+  w.draw(*gfx);
+  gfx->resetCount();
+
+  w.set("9.5", TFT_COLOR_VALUE);
+  w.draw(*gfx);
+  // New text + the three cells it no longer covers
+  TEST_ASSERT_EQUAL_UINT32(3 * 12 * 16 + 3 * 12 * 16, gfx->pixelsPushed());
+
+  Adafruit_GFX *ref = freshScreen();
+  TextWidget r(200, 10, 2, TFT_COLOR_BG, ALIGN_RIGHT);
+  r.set("9.5", TFT_COLOR_VALUE);
+  r.draw(*ref);
+  TEST_ASSERT_TRUE(gfx->sameScreen(*ref));
+  delete ref;
+}
+
+void test_text_centered_sequence_matches_fresh_draw() {
+  const char *values[] = {"NO FIX", "2D", "3D FIX", "", "DGPS FIX OK", "3D"};
+  TextWidget w(TFT_WIDTH / 2, 40, 2, TFT_COLOR_BG, ALIGN_CENTER);
+  for (const char *v : values) {
+    w.set(v, TFT_COLOR_WARNING);
+    w.draw(*gfx);
+  }
+
+  Adafruit_GFX *ref = freshScreen();
+  TextWidget r(TFT_WIDTH / 2, 40, 2, TFT_COLOR_BG, ALIGN_CENTER);
+  r.set("3D", TFT_COLOR_WARNING);
+  r.draw(*ref);
+  TEST_ASSERT_TRUE(gfx->sameScreen(*ref));
+  delete ref;
+}
+
+// ============================================================================
+// BAR
+// ============================================================================
+void test_bar_pushes_only_the_changed_strip() {
+  BarWidget bar(10, 100, 102, 20, TFT_COLOR_TEXT, TFT_COLOR_BG); // 100 px inside
+  bar.set(50, 100, TFT_COLOR_VALUE);
+  bar.draw(*gfx);
+  gfx->resetCount();
+
+  bar.set(60, 100, TFT_COLOR_VALUE);
+  bar.draw(*gfx);
+  TEST_ASSERT_EQUAL_UINT32(10 * 18, gfx->pixelsPushed());
+
+  gfx->resetCount();
+  bar.set(45, 100, TFT_COLOR_VALUE);
+  bar.draw(*gfx);
+  TEST_ASSERT_EQUAL_UINT32(15 * 18, gfx->pixelsPushed());
+
+  // A colour change repaints the filled part only
+  gfx->resetCount();
+  bar.set(45, 100, TFT_COLOR_WARNING);
+  bar.draw(*gfx);
+  TEST_ASSERT_EQUAL_UINT32(45 * 18, gfx->pixelsPushed());
+
+  Adafruit_GFX *ref = freshScreen();
+  BarWidget r(10, 100, 102, 20, TFT_COLOR_TEXT, TFT_COLOR_BG);
+  r.set(45, 100, TFT_COLOR_WARNING);
+  r.draw(*ref);
+  TEST_ASSERT_TRUE(gfx->sameScreen(*ref));
+  delete ref;
+}
+
+// ============================================================================
+// SKY PLOT
+// ============================================================================
+void test_sky_plot_moves_one_dot() {
+  SkyPlotPoint points[] = {
+    {5, 61, 226, TFT_COLOR_VALUE, true},
+    {13, 31, 160, TFT_COLOR_VALUE, true},
+    {15, 50, 63, TFT_COLOR_WARNING, false},
+    {18, 24, 286, TFT_COLOR_VALUE, true},
+  };
+  SkyPlotWidget sky(120, 160, 60, TFT_COLOR_SEPARATOR, TFT_COLOR_BG);
+  sky.set(points, 4);
+  sky.draw(*gfx);
+  gfx->resetCount();
+
+  points[1].elevation = 33;
+  points[1].azimuth = 165;
+  sky.set(points, 4);
+  sky.draw(*gfx);
+  // One dot erased (grid repaired) and redrawn, far from the whole plot
+  uint32_t dot = (2 * SKY_DOT_RADIUS + 1) * (2 * SKY_DOT_RADIUS + 1);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(3 * dot, gfx->pixelsPushed());
+
+  Adafruit_GFX *ref = freshScreen();
+  SkyPlotWidget r(120, 160, 60, TFT_COLOR_SEPARATOR, TFT_COLOR_BG);
+  r.set(points, 4);
+  r.draw(*ref);
+  TEST_ASSERT_TRUE(gfx->sameScreen(*ref));
+  delete ref;
+}
+
+// ============================================================================
+// PAGE
+// ============================================================================
+// The GPS data page at 1 Hz: the clock changes every frame, the position
+// every few frames
+struct GpsPage {
+  TextWidget labels[6], values[6];
+
+  GpsPage() {
+    const char *names[] = {"Lat:", "Lng:", "Alt:", "Spd:", "Crs:", "UTC:"};
+    for (int i = 0; i < 6; i++) {
+      labels[i].place(5, CONTENT_Y + i * LINE_HEIGHT, 2, TFT_COLOR_BG);
+      values[i].place(65, CONTENT_Y + i * LINE_HEIGHT, 2, TFT_COLOR_BG);
+      labels[i].set(names[i], TFT_COLOR_TEXT);
+    }
+  }
+
+  void frame(uint32_t t, Adafruit_GFX &screen) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "48.72%04u", 7777 + t / 3);
+    values[0].set(buf, TFT_COLOR_VALUE);
+    snprintf(buf, sizeof(buf), "2.34%04u", 9789 + t / 3);
+    values[1].set(buf, TFT_COLOR_VALUE);
+    values[2].set("64.3 m", TFT_COLOR_VALUE);
+    snprintf(buf, sizeof(buf), "%u.%u km/h", 4 + t % 3, t % 10);
+    values[3].set(buf, TFT_COLOR_VALUE);
+    values[4].set("84.4", TFT_COLOR_VALUE);
+    snprintf(buf, sizeof(buf), "08:%02u:%02u", 30 + t / 60, t % 60);
+    values[5].set(buf, TFT_COLOR_VALUE);
+    for (int i = 0; i < 6; i++) {
+      labels[i].draw(screen);
+      values[i].draw(screen);
+    }
+  }
+};
+
+void test_page_frames_push_a_fraction_of_a_clear() {
+  GpsPage page;
+  page.frame(0, *gfx);
+  uint32_t first = gfx->pixelsPushed();
+
+  uint32_t worst = 0;
+  for (uint32_t t = 1; t <= 120; t++) {
+    gfx->resetCount();
+    widgetStats = {};
+    page.frame(t, *gfx);
+    worst = max(worst, gfx->pixelsPushed());
+    // The firmware's own count (/metrics) agrees with the bus
+    TEST_ASSERT_EQUAL_UINT32(gfx->pixelsPushed(), widgetStats.pixels);
+  }
+
+  char msg[80];
+  snprintf(msg, sizeof(msg), "first frame %lu px, worst update %lu px", (unsigned long)first, (unsigned long)worst);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_THAN_UINT32(CONTENT_AREA / 2, first);
+  TEST_ASSERT_LESS_THAN_UINT32(CONTENT_AREA / 5, worst);
+
+  Adafruit_GFX *ref = freshScreen();
+  GpsPage fresh;
+  fresh.frame(120, *ref);
+  TEST_ASSERT_TRUE(gfx->sameScreen(*ref));
+  delete ref;
+}
+
+// After invalidateWidgets() (page switch) everything is drawn again
+void test_invalidate_redraws() {
+  GpsPage page;
+  page.frame(0, *gfx);
+  uint32_t first = gfx->pixelsPushed();
+
+  delete gfx;
+  gfx = freshScreen();
+  page.frame(0, *gfx);
+  TEST_ASSERT_EQUAL_UINT32(first, gfx->pixelsPushed());
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_text_first_draw_pushes_its_cells);
+  RUN_TEST(test_text_unchanged_pushes_nothing);
+  RUN_TEST(test_text_shorter_clears_only_the_leftover);
+  RUN_TEST(test_text_centered_sequence_matches_fresh_draw);
+  RUN_TEST(test_bar_pushes_only_the_changed_strip);
+  RUN_TEST(test_sky_plot_moves_one_dot);
+  RUN_TEST(test_page_frames_push_a_fraction_of_a_clear);
+  RUN_TEST(test_invalidate_redraws);
+  return UNITY_END();
+}
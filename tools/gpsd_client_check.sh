@@ -0,0 +1,101 @@
+#!/usr/bin/env bash
+# Checks the gpsd server (see include/gpsd_server.h) with the stock gpsd
+# clients from the gpsd-clients package.
+#
+# Usage: tools/gpsd_client_check.sh <tester-ip> [reports=20] [port=2947]
+#
+# - gpspipe -w: the stream must be valid JSON, start with VERSION, and carry
+#   DEVICES, WATCH, TPV and SKY objects. SKY must list satellites with PRN,
+#   ss and used (el/az once the receiver reports them).
+# - gpspipe -r: the raw watch must carry checksum-valid NMEA.
+# - ?POLL: the reply must embed one TPV and one SKY.
+# Run it with an antenna outside (or a GPS simulator on the UART) so the
+# tester has satellites in view. cgps can then be started by hand:
+#   cgps <tester-ip>:<port>
+# Exit status: 0 when every check passes, 1 otherwise.
+
+set -u
+
+HOST=${1:?usage: $0 <tester-ip> [reports] [port]}
+REPORTS=${2:-20}
+PORT=${3:-2947}
+
+for tool in gpspipe python3; do
+  command -v "$tool" > /dev/null || { echo "$tool not found (apt install gpsd-clients python3)"; exit 1; }
+done
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+echo "gpspipe -w on $HOST:$PORT ($REPORTS lines)..."
+timeout 30 gpspipe -w -n "$REPORTS" "$HOST:$PORT" > "$WORK/json.txt"
+echo "gpspipe -r on $HOST:$PORT ($REPORTS lines)..."
+timeout 30 gpspipe -r -n "$REPORTS" "$HOST:$PORT" > "$WORK/nmea.txt"
+
+python3 - "$WORK/json.txt" "$WORK/nmea.txt" "$HOST" "$PORT" <<'EOF'
+import json
+import socket
+import sys
+from functools import reduce
+
+json_path, nmea_path, host, port = sys.argv[1], sys.argv[2], sys.argv[3], int(sys.argv[4])
+failures = []
+
+
+def check(cond, message):
+    print(("ok    " if cond else "FAIL  ") + message)
+    if not cond:
+        failures.append(message)
+
+
+# gpspipe -w
+objects = []
+for n, line in enumerate(open(json_path), 1):
+    try:
+        objects.append(json.loads(line))
+    except ValueError:
+        check(False, "line %d is not JSON: %s" % (n, line.strip()[:60]))
+classes = [o.get("class") for o in objects]
+check(classes[:1] == ["VERSION"], "stream starts with VERSION")
+for cls in ("DEVICES", "WATCH", "TPV", "SKY"):
+    check(cls in classes, "%s seen" % cls)
+
+for tpv in (o for o in objects if o.get("class") == "TPV"):
+    check(tpv.get("mode") in (1, 2, 3), "TPV mode %s" % tpv.get("mode"))
+    break
+
+skies = [o for o in objects if o.get("class") == "SKY"]
+sats = skies[-1].get("satellites", []) if skies else []
+check(len(sats) > 0, "SKY lists %d satellites" % len(sats))
+check(all({"PRN", "ss", "used"} <= s.keys() for s in sats), "every satellite has PRN, ss, used")
+check(all(("el" in s) == ("az" in s) for s in sats), "el and az come together")
+if skies and "nSat" in skies[-1]:
+    check(skies[-1]["nSat"] == len(sats), "nSat matches the satellite list")
+
+# gpspipe -r
+sentences = [l.strip() for l in open(nmea_path) if l.startswith("$")]
+check(len(sentences) > 0, "raw watch carries NMEA")
+for s in sentences:
+    body, _, cs = s[1:].partition("*")
+    if reduce(lambda a, c: a ^ ord(c), body, 0) != int(cs[:2] or "-1", 16):
+        check(False, "bad checksum: " + s)
+        break
+
+# ?POLL (gpspipe has no poll mode)
+with socket.create_connection((host, port), timeout=5) as sock:
+    f = sock.makefile("r")
+    f.readline()  # VERSION banner
+    sock.sendall(b"?WATCH={\"enable\":true};?POLL;\n")
+    poll = None
+    for _ in range(50):
+        o = json.loads(f.readline())
+        if o.get("class") == "POLL":
+            poll = o
+            break
+check(poll is not None, "?POLL answered")
+if poll is not None:
+    check(len(poll.get("tpv", [])) == 1 and len(poll.get("sky", [])) == 1, "POLL embeds one TPV and one SKY")
+
+print("PASS" if not failures else "FAIL: %d check(s)" % len(failures))
+sys.exit(1 if failures else 0)
+EOF
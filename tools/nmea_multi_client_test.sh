@@ -0,0 +1,83 @@
+#!/usr/bin/env bash
+# Multi-client check for the NMEA TCP server (see include/nmea_server.h).
+#
+# Usage: tools/nmea_multi_client_test.sh <tester-ip> [clients=24] [seconds=30] [port=10110]
+#
+# Connects <clients> plain `nc` clients at once, records what each receives,
+# then aligns the captures on a common sentence and checks that every client
+# got the same byte stream. Clients beyond NMEA_TCP_MAX_CLIENTS are refused by
+# the server and reported as such, not as a mismatch.
+# Exit status: 0 when all connected clients match, 1 otherwise.
+
+set -u
+
+HOST=${1:?usage: $0 <tester-ip> [clients] [seconds] [port]}
+CLIENTS=${2:-24}
+SECONDS_RUN=${3:-30}
+PORT=${4:-10110}
+SETTLE_LINES=5   # Skipped at the start of each capture before aligning
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+echo "Connecting $CLIENTS clients to $HOST:$PORT for ${SECONDS_RUN}s..."
+for i in $(seq 1 "$CLIENTS"); do
+  timeout "$SECONDS_RUN" nc "$HOST" "$PORT" > "$WORK/client$i.nmea" 2>/dev/null &
+done
+wait
+
+# The last line of each capture may be cut off by the timeout
+connected=()
+for i in $(seq 1 "$CLIENTS"); do
+  f="$WORK/client$i.nmea"
+  if [ "$(wc -l < "$f")" -gt $((SETTLE_LINES * 2)) ]; then
+    head -n -1 "$f" | tr -d '\r' > "$f.lines"
+    connected+=("$i")
+  else
+    echo "client $i: no stream (refused or not connected)"
+  fi
+done
+
+if [ "${#connected[@]}" -lt 2 ]; then
+  echo "FAIL: fewer than two clients received data"
+  exit 1
+fi
+
+# Align on a sentence every client has seen: the first one after the settle
+# lines of the client that connected last (shortest capture)
+shortest=${connected[0]}
+for i in "${connected[@]}"; do
+  if [ "$(wc -l < "$WORK/client$i.nmea.lines")" -lt "$(wc -l < "$WORK/client$shortest.nmea.lines")" ]; then
+    shortest=$i
+  fi
+done
+anchor=$(sed -n "$((SETTLE_LINES + 1))p" "$WORK/client$shortest.nmea.lines")
+
+common=-1
+for i in "${connected[@]}"; do
+  start=$(grep -nxF -m1 -- "$anchor" "$WORK/client$i.nmea.lines" | cut -d: -f1)
+  if [ -z "$start" ]; then
+    echo "FAIL: client $i never received the anchor sentence: $anchor"
+    exit 1
+  fi
+  tail -n +"$start" "$WORK/client$i.nmea.lines" > "$WORK/client$i.aligned"
+  n=$(wc -l < "$WORK/client$i.aligned")
+  if [ "$common" -lt 0 ] || [ "$n" -lt "$common" ]; then common=$n; fi
+done
+
+ref=${connected[0]}
+head -n "$common" "$WORK/client$ref.aligned" > "$WORK/ref"
+status=0
+for i in "${connected[@]}"; do
+  if head -n "$common" "$WORK/client$i.aligned" | cmp -s - "$WORK/ref"; then
+    echo "client $i: OK"
+  else
+    echo "client $i: MISMATCH"
+    head -n "$common" "$WORK/client$i.aligned" | diff "$WORK/ref" - | head -n 5
+    status=1
+  fi
+done
+
+echo "${#connected[@]}/$CLIENTS clients connected, $common common sentences compared"
+[ "$status" -eq 0 ] && echo "PASS: identical streams" || echo "FAIL"
+exit "$status"
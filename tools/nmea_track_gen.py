@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Synthetic 1 Hz drive as GPRMC sentences, for dead-reckoning replays.
+
+Usage: python3 tools/nmea_track_gen.py [--seed 43] [--c-array] > track.nmea
+
+The drive starts and ends stopped and goes through city turns, a
+roundabout, a tunnel (status V, no fix) and a fast curve. Position error is
+a slowly wandering offset (as a receiver's is), speed and course carry
+noise, and the course is left empty when stopped. The output is the NMEA
+text, or with --c-array the string literals test/test_dead_reckoning
+includes. A recorded log (gpspipe -r) can be used the same way: keep its
+RMC sentences.
+"""
+
+import argparse
+import math
+import random
+
+START = (48.0 + 43.6666 / 60.0, 2.0 + 20.7873 / 60.0)  # Lat, lng in degrees
+START_TIME = 8 * 3600 + 30 * 60  # 08:30:00 UTC
+DATE = "191026"
+EARTH_M = 6371008.8
+
+# (seconds, target speed km/h, turn rate deg/s, fix)
+SEGMENTS = [
+    (10, 0, 0, True),      # Parked
+    (12, 50, 0, True),     # Pull away
+    (25, 50, 0, True),
+    (8, 25, 11.25, True),  # Right turn at a crossing
+    (20, 50, 0, True),
+    (6, 25, -15, True),    # Left turn
+    (15, 45, 0, True),
+    (18, 25, 15, True),    # Roundabout, third exit (270 degrees)
+    (15, 70, 0, True),
+    (6, 70, 0, False),     # Tunnel
+    (15, 70, 0, True),
+    (30, 90, 2, True),     # Fast curve
+    (15, 90, 0, True),
+    (12, 0, 0, True),      # Braking to a stop
+    (10, 0, 0, True),
+]
+
+STEP_S = 0.1
+ACCEL_KMH_S = 6.0        # Speed change toward the target
+POS_SIGMA_M = 1.2        # Receiver offset, standard deviation
+POS_TAU_S = 15.0         # and correlation time
+SPEED_SIGMA_KN = 0.08
+COURSE_SIGMA_DEG = 0.8
+
+
+def checksum(body):
+    c = 0
+    for ch in body:
+        c ^= ord(ch)
+    return "%02X" % c
+
+
+def ddmm(deg, width):
+    whole = int(deg)
+    minutes = (deg - whole) * 60.0
+    text = "%0*d%08.5f" % (width, whole, minutes)
+    if text.endswith("60.00000"):  # Rounded up to the next degree
+        text = "%0*d%08.5f" % (width, whole + 1, 0.0)
+    return text
+
+
+def rmc(t, fix, lat, lng, speed_kn, course):
+    hh, rem = divmod(START_TIME + t, 3600)
+    mm, ss = divmod(rem, 60)
+    stamp = "%02d%02d%02d.00" % (hh, mm, ss)
+    if not fix:
+        body = "GPRMC,%s,V,,,,,,,%s,,,N" % (stamp, DATE)
+    else:
+        body = "GPRMC,%s,A,%s,%s,%s,%s,%.3f,%s,%s,,,A" % (
+            stamp,
+            ddmm(abs(lat), 2), "N" if lat >= 0 else "S",
+            ddmm(abs(lng), 3), "E" if lng >= 0 else "W",
+            speed_kn,
+            "%.2f" % course if course is not None else "",
+            DATE)
+    return "$%s*%s" % (body, checksum(body))
+
+
+def drive(seed):
+    rng = random.Random(seed)
+    lat, lng = START
+    speed = 0.0   # km/h
+    heading = 35.0
+    off_n = off_e = 0.0
+    decay = math.exp(-STEP_S / POS_TAU_S)
+    kick = POS_SIGMA_M * math.sqrt(1 - decay * decay)
+
+    t = 0
+    sentences = []
+    for seconds, target, turn, fix in SEGMENTS:
+        for _ in range(seconds):
+            sub = 0.0
+            while sub < 1.0 - 1e-9:
+                delta = max(-ACCEL_KMH_S * STEP_S, min(ACCEL_KMH_S * STEP_S, target - speed))
+                speed += delta
+                heading = (heading + turn * STEP_S) % 360.0
+                dist = speed / 3.6 * STEP_S
+                lat += math.degrees(dist * math.cos(math.radians(heading)) / EARTH_M)
+                lng += math.degrees(dist * math.sin(math.radians(heading)) / (EARTH_M * math.cos(math.radians(lat))))
+                off_n = off_n * decay + rng.gauss(0, kick)
+                off_e = off_e * decay + rng.gauss(0, kick)
+                sub += STEP_S
+            t += 1
+
+            rlat = lat + math.degrees(off_n / EARTH_M)
+            rlng = lng + math.degrees(off_e / (EARTH_M * math.cos(math.radians(lat))))
+            speed_kn = max(0.0, speed / 1.852 + rng.gauss(0, SPEED_SIGMA_KN))
+            course = None
+            if speed_kn > 0.1:
+                course = (heading + rng.gauss(0, COURSE_SIGMA_DEG) * (1 + 5 / max(speed, 1.0))) % 360.0
+            sentences.append(rmc(t, fix, rlat, rlng, speed_kn, course))
+    return sentences
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--seed", type=int, default=43)
+    parser.add_argument("--c-array", action="store_true", help="C string literals, one per line")
+    args = parser.parse_args()
+
+    for sentence in drive(args.seed):
+        print('  "%s",' % sentence if args.c_array else sentence)
+
+
+if __name__ == "__main__":
+    main()
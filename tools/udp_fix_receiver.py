@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Reference receiver for the GPS Tester UDP fix stream (see include/udp_fix.h).
+
+Usage: python3 tools/udp_fix_receiver.py [--group 239.255.47.47] [--port 10111]
+
+Prints one line per datagram and reports lost datagrams from sequence gaps.
+"""
+
+import argparse
+import socket
+import struct
+
+PACKET = struct.Struct("<IBBHIIqqIIiiiHHHBB")
+MAGIC = 0x46535047
+VERSION = 1
+
+FLAG_FIX, FLAG_ALT, FLAG_SPEED, FLAG_COURSE, FLAG_HDOP, FLAG_TIME, FLAG_PPS = (1 << i for i in range(7))
+
+
+def open_socket(group, port):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("", port))
+    if group:
+        mreq = struct.pack("4s4s", socket.inet_aton(group), socket.inet_aton("0.0.0.0"))
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+    return sock
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--group", default="239.255.47.47", help="multicast group ('' for broadcast)")
+    parser.add_argument("--port", type=int, default=10111)
+    args = parser.parse_args()
+
+    sock = open_socket(args.group, args.port)
+    last_seq = {}
+    lost = {}
+
+    while True:
+        data, (addr, _) = sock.recvfrom(256)
+        if len(data) < PACKET.size:
+            print(f"{addr}: short datagram ({len(data)} bytes)")
+            continue
+        (magic, version, flags, length, seq, epoch, epoch_us, pps_us, date, time_ms,
+         lat, lon, alt_cm, speed_cms, course_cdeg, hdop, sats, _) = PACKET.unpack_from(data)
+        if magic != MAGIC or version != VERSION:
+            print(f"{addr}: unknown packet (magic {magic:#x}, version {version})")
+            continue
+
+        if addr in last_seq and seq != (last_seq[addr] + 1) & 0xFFFFFFFF:
+            lost[addr] = lost.get(addr, 0) + ((seq - last_seq[addr] - 1) & 0xFFFFFFFF)
+        last_seq[addr] = seq
+
+        line = f"{addr} seq={seq} epoch={epoch}"
+        if flags & FLAG_TIME:
+            t = time_ms // 1000
+            line += f" {date} {t // 3600:02d}:{t // 60 % 60:02d}:{t % 60:02d}.{time_ms % 1000:03d}Z"
+        if flags & FLAG_FIX:
+            line += f" lat={lat / 1e7:.7f} lon={lon / 1e7:.7f}"
+        else:
+            line += " nofix"
+        if flags & FLAG_ALT:
+            line += f" alt={alt_cm / 100:.2f}m"
+        if flags & FLAG_SPEED:
+            line += f" spd={speed_cms / 100:.2f}m/s"
+        if flags & FLAG_COURSE:
+            line += f" crs={course_cdeg / 100:.2f}"
+        if flags & FLAG_HDOP:
+            line += f" hdop={hdop / 100:.2f}"
+        line += f" sats={sats}"
+        if flags & FLAG_PPS:
+            line += f" pps+{(epoch_us - pps_us) / 1000:.1f}ms"
+        line += f" lost={lost.get(addr, 0)}"
+        print(line, flush=True)
+
+
+if __name__ == "__main__":
+    main()